@@ -11,10 +11,39 @@
 #ifdef ALPS_HAVE_MPI
 
     #include <alps/utilities/boost_mpi.hpp>
+    #include <alps/utilities/mpi_pack.hpp>
 
     namespace alps {
         namespace alps_mpi {
 
+            /**
+             * @brief Defers the sum reductions issued by `reduce()` on the calling thread
+             *
+             * While the scope is alive, `reduce()` calls with `std::plus` on the same communicator
+             * and root are collected, and `commit()` does them with one message per scalar type.
+             * The results are stored at the root by `commit()`; the destructor does not commit.
+             */
+            class reduction_scope {
+              public:
+                reduction_scope(const alps::mpi::communicator & comm, int root);
+                reduction_scope(const reduction_scope &) = delete;
+                reduction_scope & operator=(const reduction_scope &) = delete;
+                ~reduction_scope();
+
+                /// Does the collected reductions; to be called by all ranks of the communicator
+                void commit() { reduction_.commit(); }
+
+                /// The collected reductions
+                alps::mpi::packed_reduction & reduction() { return reduction_; }
+
+                /// Innermost scope of the calling thread, or 0
+                static reduction_scope * current();
+
+              private:
+                alps::mpi::packed_reduction reduction_;
+                reduction_scope * previous_;
+            };
+
             template<typename T, typename Op> void reduce(const alps::mpi::communicator & comm, T const & in_values, Op op, int root);
             template<typename T, typename Op> void reduce(const alps::mpi::communicator & comm, T const & in_values, T & out_values, Op op, int root);
 
@@ -208,7 +208,10 @@ namespace alps {
         };
 
         void accumulator_wrapper::collective_merge(alps::mpi::communicator const & comm, int root) {
+            // all sums of the accumulator go with one message per scalar type
+            alps_mpi::reduction_scope scope(comm, root);
             boost::apply_visitor(collective_merge_visitor(comm, root), m_variant);
+            scope.commit();
             if (comm.rank()!=root) this->reset();
         }
 #endif
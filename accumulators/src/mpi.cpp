@@ -13,6 +13,34 @@
         namespace alps_mpi {
             namespace detail {
 
+                inline reduction_scope *& scoped_reduction() {
+                    static thread_local reduction_scope * scope = 0;
+                    return scope;
+                }
+
+                /// The scope collecting a reduction with `op` on `comm` and `root`, or 0 if it is to be done now
+                template<typename Op> reduction_scope * deferring_scope(const alps::mpi::communicator &, int, Op) {
+                    return 0;
+                }
+
+                template<typename S> reduction_scope * deferring_scope(const alps::mpi::communicator & comm, int root, std::plus<S>) {
+                    reduction_scope * scope = reduction_scope::current();
+                    if (scope && scope->reduction().root() == root && MPI_Comm(scope->reduction().comm()) == MPI_Comm(comm))
+                        return scope;
+                    return 0;
+                }
+
+                /// Number of scalars in a continuous value; throws like MPI_Reduce() with an invalid count
+                template<typename T> std::size_t checked_count(T const & values) {
+                    using alps::hdf5::get_extent;
+                    std::vector<std::size_t> extent(get_extent(values));
+                    std::size_t count = std::accumulate(extent.begin(), extent.end(), std::size_t(1), std::multiplies<std::size_t>());
+                    if (count == 0) {
+                        throw std::invalid_argument("MPI_Reduce() is called with invalid count=0" + ALPS_STACKTRACE);
+                    }
+                    return count;
+                }
+
                 /// MPI_Reduce() with argument checking.
                 /** @todo FIXME: Should be replaced with alps::mpi::reduce()
                                  once implemented properly, with error checking */
@@ -241,14 +269,78 @@
                     } else
                         throw std::logic_error("No alps::mpi::reduce available for this type " + std::string(typeid(T).name()) + ALPS_STACKTRACE);
                 }
+                /// Collect a scalar into `reduction`; `out_values` is 0 if the result is not wanted
+                template<typename T, typename C> void defer_impl(alps::mpi::packed_reduction & reduction, T const & in_values, T * out_values, std::true_type, C) {
+                    if (out_values)
+                        reduction.add(&in_values, out_values, 1);
+                    else
+                        reduction.add(&in_values, 1, [](const T *) {});
+                }
+
+                template<typename T> void defer_impl(alps::mpi::packed_reduction & reduction, T const & in_values, T * out_values, std::false_type, std::true_type) {
+                    typedef typename alps::hdf5::scalar_type<T>::type scalar_type;
+                    std::size_t count = checked_count(in_values);
+                    using alps::hdf5::get_pointer;
+                    if (out_values) {
+                        using alps::hdf5::get_extent;
+                        using alps::hdf5::set_extent;
+                        set_extent(*out_values, get_extent(in_values));
+                        reduction.add(get_pointer(in_values), get_pointer(*out_values), count);
+                    } else
+                        reduction.add(get_pointer(in_values), count, [](const scalar_type *) {});
+                }
+
+                template<typename T> void defer_impl(alps::mpi::packed_reduction & reduction, T const & in_values, T * out_values, std::false_type, std::false_type) {
+                    using alps::hdf5::is_vectorizable;
+                    if (!is_vectorizable(in_values))
+                        throw std::logic_error("No alps::mpi::reduce available for this type " + std::string(typeid(T).name()) + ALPS_STACKTRACE);
+                    typedef typename alps::hdf5::scalar_type<T>::type scalar_type;
+                    using alps::hdf5::get_extent;
+                    std::vector<std::size_t> extent(get_extent(in_values));
+                    std::vector<scalar_type> in_buffer(checked_count(in_values));
+                    copy_to_buffer(in_values, in_buffer, 0, typename hdf5::is_content_continuous<T>::type());
+                    if (out_values) {
+                        using alps::hdf5::set_extent;
+                        set_extent(*out_values, extent);
+                        std::size_t count = in_buffer.size();
+                        reduction.add(&in_buffer.front(), count, [out_values, count](const scalar_type * reduced) {
+                            std::vector<scalar_type> out_buffer(reduced, reduced + count);
+                            copy_from_buffer(*out_values, out_buffer, 0, typename hdf5::is_content_continuous<T>::type());
+                        });
+                    } else
+                        reduction.add(&in_buffer.front(), in_buffer.size(), [](const scalar_type *) {});
+                }
             } // detail::
 
+            reduction_scope::reduction_scope(const alps::mpi::communicator & comm, int root)
+                : reduction_(comm, root), previous_(detail::scoped_reduction())
+            {
+                detail::scoped_reduction() = this;
+            }
+
+            reduction_scope::~reduction_scope() {
+                detail::scoped_reduction() = previous_;
+            }
+
+            reduction_scope * reduction_scope::current() {
+                return detail::scoped_reduction();
+            }
+
             template<typename T, typename Op> void reduce(const alps::mpi::communicator & comm, T const & in_values, Op op, int root) {
+                if (reduction_scope * scope = detail::deferring_scope(comm, root, op)) {
+                    detail::defer_impl(scope->reduction(), in_values, static_cast<T *>(0), typename std::is_scalar<T>::type(), typename hdf5::is_content_continuous<T>::type());
+                    return;
+                }
                 using detail::reduce_impl;
                 reduce_impl(comm, in_values, op, root, typename std::is_scalar<T>::type(), typename hdf5::is_content_continuous<T>::type());
             }
 
             template<typename T, typename Op> void reduce(const alps::mpi::communicator & comm, T const & in_values, T & out_values, Op op, int root) {
+                if (reduction_scope * scope = detail::deferring_scope(comm, root, op)) {
+                    T * out = (comm.rank() == root) ? &out_values : 0;
+                    detail::defer_impl(scope->reduction(), in_values, out, typename std::is_scalar<T>::type(), typename hdf5::is_content_continuous<T>::type());
+                    return;
+                }
                 using detail::reduce_impl;
                 reduce_impl(comm, in_values, out_values, op, root, typename std::is_scalar<T>::type(), typename hdf5::is_content_continuous<T>::type());
             }
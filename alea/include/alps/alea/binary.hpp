@@ -0,0 +1,357 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <alps/alea/core.hpp>
+
+namespace alps { namespace alea {
+
+namespace internal {
+
+/**
+ * Record layout of the binary serialization format.
+ *
+ * A buffer starts with the 8-byte `binary_magic`, followed by a flat sequence
+ * of records.  Each record consists of a `binary_record` header, the key
+ * (padded to 8 bytes), and for data records the shape (`ndim` 64-bit integers)
+ * and the raw elements (padded to 8 bytes).  Groups are delimited by a
+ * `GROUP_ENTER` record carrying the group name and a `GROUP_EXIT` record.
+ * All numbers are stored in the native byte order of the writing machine.
+ */
+struct binary_record
+{
+    enum kind_type : std::uint32_t { GROUP_ENTER = 1, GROUP_EXIT = 2, DATA = 3 };
+
+    std::uint32_t kind;
+    std::uint32_t type;
+    std::uint64_t key_size;
+    std::uint64_t ndim;
+    std::uint64_t size;
+};
+
+static const char binary_magic[8] = {'A', 'L', 'E', 'A', 'B', 'I', 'N', '1'};
+
+inline size_t binary_pad(size_t nbytes) { return (nbytes + 7) & ~size_t(7); }
+
+template <typename T> struct binary_type;
+template <> struct binary_type<double> { static const std::uint32_t value = 1; };
+template <> struct binary_type<std::complex<double>> { static const std::uint32_t value = 2; };
+template <> struct binary_type<complex_op<double>> { static const std::uint32_t value = 3; };
+template <> struct binary_type<long> { static const std::uint32_t value = 4; };
+template <> struct binary_type<unsigned long> { static const std::uint32_t value = 5; };
+
+}
+
+/**
+ * Serializes into a compact, self-describing binary buffer.
+ *
+ * Every array is appended as a single memcpy'd block together with its key
+ * and shape, which makes this serializer suitable for frequent snapshots and
+ * for shipping results between processes (e.g., as an MPI message) where
+ * HDF5 is too heavyweight.  The buffer is owned by the caller and grows as
+ * needed; clearing and reusing it for the next snapshot avoids reallocations.
+ * The data can be read back by `binary_deserializer` on a machine with the
+ * same byte order.
+ *
+ * @see alps::alea::binary_deserializer
+ */
+class binary_serializer
+    : public serializer
+{
+public:
+    /** Appends to `buffer`, which must be empty or contain a previous buffer */
+    binary_serializer(std::vector<char> &buffer)
+        : buffer_(&buffer)
+        , depth_(0)
+    {
+        if (buffer_->empty())
+            buffer_->insert(buffer_->end(), internal::binary_magic,
+                            internal::binary_magic + sizeof(internal::binary_magic));
+    }
+
+    void enter(const std::string &group) override
+    {
+        write_header(internal::binary_record::GROUP_ENTER, 0, group, 0, 0);
+        ++depth_;
+    }
+
+    void exit() override
+    {
+        if (depth_ == 0)
+            throw std::runtime_error("exit without enter");
+        write_header(internal::binary_record::GROUP_EXIT, 0, "", 0, 0);
+        --depth_;
+    }
+
+    void write(const std::string &key, ndview<const double> value) override {
+        do_write(key, value);
+    }
+
+    void write(const std::string &key, ndview<const std::complex<double>> value) override {
+        do_write(key, value);
+    }
+
+    void write(const std::string &key, ndview<const complex_op<double>> value) override {
+        do_write(key, value);
+    }
+
+    void write(const std::string &key, ndview<const long> value) override {
+        do_write(key, value);
+    }
+
+    void write(const std::string &key, ndview<const unsigned long> value) override {
+        do_write(key, value);
+    }
+
+    binary_serializer *clone() override { return new binary_serializer(*this); }
+
+protected:
+    template <typename T>
+    void do_write(const std::string &key, ndview<const T> value)
+    {
+        write_header(internal::binary_record::DATA, internal::binary_type<T>::value,
+                     key, value.ndim(), value.size());
+        for (size_t i = 0; i != value.ndim(); ++i) {
+            std::uint64_t extent = value.shape()[i];
+            append(&extent, sizeof(extent));
+        }
+        append(value.data(), value.size() * sizeof(T));
+        pad();
+    }
+
+    void write_header(std::uint32_t kind, std::uint32_t type, const std::string &key,
+                      size_t ndim, size_t size)
+    {
+        internal::binary_record header = {kind, type, static_cast<std::uint64_t>(key.size()),
+                                          static_cast<std::uint64_t>(ndim), static_cast<std::uint64_t>(size)};
+        append(&header, sizeof(header));
+        append(key.data(), key.size());
+        pad();
+    }
+
+    void append(const void *data, size_t nbytes)
+    {
+        if (nbytes == 0)
+            return;
+        const char *bytes = static_cast<const char *>(data);
+        buffer_->insert(buffer_->end(), bytes, bytes + nbytes);
+    }
+
+    void pad() { buffer_->resize(internal::binary_pad(buffer_->size()), 0); }
+
+private:
+    std::vector<char> *buffer_;
+    size_t depth_;
+};
+
+/**
+ * Deserializes from a buffer written by `binary_serializer`.
+ *
+ * The deserializer does not copy or own the buffer: it can directly work on a
+ * memory-mapped file or a received MPI buffer, and arrays are copied straight
+ * from there into the target views.  Keys are looked up within the current
+ * group, so they can be read in any order.
+ *
+ * @see alps::alea::binary_serializer
+ */
+class binary_deserializer
+    : public deserializer
+{
+public:
+    /** Reads from `size` bytes starting at `data`, which must outlive `*this` */
+    binary_deserializer(const char *data, size_t size)
+        : data_(data)
+        , size_(size)
+        , scope_()
+    {
+        if (size_ < sizeof(internal::binary_magic) ||
+                std::memcmp(data_, internal::binary_magic, sizeof(internal::binary_magic)) != 0)
+            throw std::runtime_error("Not an ALEA binary buffer");
+        scope_.push_back(sizeof(internal::binary_magic));
+    }
+
+    /** Reads from `buffer`, which must outlive `*this` */
+    binary_deserializer(const std::vector<char> &buffer)
+        : binary_deserializer(buffer.data(), buffer.size())
+    { }
+
+    void enter(const std::string &group) override
+    {
+        size_t pos = find(internal::binary_record::GROUP_ENTER, group);
+        scope_.push_back(next(pos));
+    }
+
+    void exit() override
+    {
+        if (scope_.size() == 1)
+            throw std::runtime_error("exit without enter");
+        scope_.pop_back();
+    }
+
+    std::vector<size_t> get_shape(const std::string &key) override
+    {
+        size_t pos = find(internal::binary_record::DATA, key);
+        next(pos);  // the whole record is inside the buffer
+        internal::binary_record header = read_header(pos);
+        std::vector<size_t> shape(header.ndim);
+        for (size_t i = 0; i != shape.size(); ++i) {
+            std::uint64_t extent;
+            std::memcpy(&extent, shape_ptr(pos, header) + i * sizeof(extent), sizeof(extent));
+            shape[i] = extent;
+        }
+        return shape;
+    }
+
+    void read(const std::string &key, ndview<double> value) override {
+        do_read(key, value);
+    }
+
+    void read(const std::string &key, ndview<std::complex<double>> value) override {
+        do_read(key, value);
+    }
+
+    void read(const std::string &key, ndview<complex_op<double>> value) override {
+        do_read(key, value);
+    }
+
+    void read(const std::string &key, ndview<long> value) override {
+        do_read(key, value);
+    }
+
+    void read(const std::string &key, ndview<unsigned long> value) override {
+        do_read(key, value);
+    }
+
+    binary_deserializer *clone() override { return new binary_deserializer(*this); }
+
+protected:
+    template <typename T>
+    void do_read(const std::string &key, ndview<T> value)
+    {
+        size_t pos = find(internal::binary_record::DATA, key);
+        next(pos);  // the whole record is inside the buffer
+        internal::binary_record header = read_header(pos);
+        if (header.type != internal::binary_type<T>::value)
+            throw std::runtime_error("Type mismatch reading key: " + key);
+
+        // check shape (this is cheap compared to reading)
+        if (header.ndim != value.ndim() || header.size != value.size())
+            throw size_mismatch();
+        const char *shape = shape_ptr(pos, header);
+        for (size_t i = 0; i != value.ndim(); ++i) {
+            std::uint64_t extent;
+            std::memcpy(&extent, shape + i * sizeof(extent), sizeof(extent));
+            if (extent != value.shape()[i])
+                throw size_mismatch();
+        }
+
+        // discard the data
+        if (value.data() == nullptr)
+            return;
+
+        std::memcpy(value.data(), shape + header.ndim * sizeof(std::uint64_t),
+                    header.size * sizeof(T));
+    }
+
+    internal::binary_record read_header(size_t pos) const
+    {
+        internal::binary_record header;
+        if (pos > size_ || size_ - pos < sizeof(header))
+            throw std::runtime_error("Truncated ALEA binary buffer");
+        std::memcpy(&header, data_ + pos, sizeof(header));
+        return header;
+    }
+
+    const char *shape_ptr(size_t pos, const internal::binary_record &header) const
+    {
+        return data_ + pos + sizeof(header) + internal::binary_pad(header.key_size);
+    }
+
+    /**
+     * Position of the record following the one at `pos` (on the same level for groups).
+     *
+     * Throws if the record does not fit into the buffer; the sizes are compared
+     * with the remaining bytes first, so that corrupt sizes cannot overflow.
+     */
+    size_t next(size_t pos) const
+    {
+        internal::binary_record header = read_header(pos);
+        size_t avail = size_ - pos - sizeof(header);
+        if (header.key_size > avail || internal::binary_pad(header.key_size) > avail)
+            throw std::runtime_error("Truncated ALEA binary buffer");
+        size_t used = internal::binary_pad(header.key_size);
+        avail -= used;
+        if (header.kind == internal::binary_record::DATA) {
+            size_t elem_size = element_size(header.type);
+            if (header.ndim > avail / sizeof(std::uint64_t))
+                throw std::runtime_error("Truncated ALEA binary buffer");
+            size_t shape_size = header.ndim * sizeof(std::uint64_t);
+            if (header.size > (avail - shape_size) / elem_size ||
+                    internal::binary_pad(shape_size + header.size * elem_size) > avail)
+                throw std::runtime_error("Truncated ALEA binary buffer");
+            used += internal::binary_pad(shape_size + header.size * elem_size);
+        }
+        return pos + sizeof(header) + used;
+    }
+
+    /** Position of the record of given kind and key in the current group */
+    size_t find(std::uint32_t kind, const std::string &key) const
+    {
+        size_t pos = scope_.back();
+        while (pos < size_) {
+            internal::binary_record header = read_header(pos);
+            if (header.kind == internal::binary_record::GROUP_EXIT)
+                break;
+            size_t after = next(pos);
+            if (header.kind == kind && header.key_size == key.size() &&
+                    std::memcmp(data_ + pos + sizeof(header), key.data(), key.size()) == 0)
+                return pos;
+            pos = header.kind == internal::binary_record::GROUP_ENTER ? skip_group(pos) : after;
+        }
+        throw std::runtime_error("Key not found in ALEA binary buffer: " + key);
+    }
+
+    /** Position after the group starting at `pos` */
+    size_t skip_group(size_t pos) const
+    {
+        size_t depth = 0;
+        do {
+            internal::binary_record header = read_header(pos);
+            if (header.kind == internal::binary_record::GROUP_ENTER)
+                ++depth;
+            else if (header.kind == internal::binary_record::GROUP_EXIT)
+                --depth;
+            pos = next(pos);
+        } while (depth != 0);
+        return pos;
+    }
+
+    static size_t element_size(std::uint32_t type)
+    {
+        switch (type) {
+        case internal::binary_type<double>::value:                return sizeof(double);
+        case internal::binary_type<std::complex<double>>::value:  return sizeof(std::complex<double>);
+        case internal::binary_type<complex_op<double>>::value:    return sizeof(complex_op<double>);
+        case internal::binary_type<long>::value:                  return sizeof(long);
+        case internal::binary_type<unsigned long>::value:         return sizeof(unsigned long);
+        default:
+            throw std::runtime_error("Corrupt ALEA binary buffer");
+        }
+    }
+
+private:
+    const char *data_;
+    size_t size_;
+    std::vector<size_t> scope_;
+};
+
+}}
@@ -7,6 +7,7 @@
 
 #include <alps/alea/core.hpp>
 #include <alps/utilities/mpi.hpp>     /* provides mpi.h */
+#include <alps/utilities/mpi_pack.hpp>
 
 // TODO: merge into MPI
 namespace alps { namespace mpi {
@@ -34,6 +35,9 @@ namespace mpi = alps::mpi;
 
 /**
  * In-place sum-reduction via an MPI communicator.
+ *
+ * The reductions are collected and done on `commit()`, with one message per
+ * scalar type.
  */
 struct mpi_reducer
     : public reducer
@@ -42,6 +46,7 @@ struct mpi_reducer
     mpi_reducer(const mpi::communicator &comm=mpi::communicator(), int root=0)
         : comm_(comm)
         , root_(root)
+        , pending_(comm, root)
     {
         if (mpi::is_intercomm(comm))
             throw std::runtime_error("Unable to use in-place communication");
@@ -66,7 +71,7 @@ struct mpi_reducer
 
     void reduce(view<long> data) const override { inplace_reduce(data); }
 
-    void commit() const override { }
+    void commit() const override { pending_.commit(); }
 
     const mpi::communicator &comm() const { return comm_; }
 
@@ -82,19 +87,14 @@ protected:
         if (data.size() == 0)
             return;
 
-        // Extract data type and get on with it
-        MPI_Datatype dtype_tag = alps::mpi::get_mpi_datatype(T());
-
-        // In-place requires special value for sendbuf, but only on root
-        const void *sendbuf = am_root() ? MPI_IN_PLACE : data.data();
-        // To maintain MPI-2.0 compatibility `const` modifier should be removed
-        mpi::checked(MPI_Reduce(const_cast<void*>(sendbuf), data.data(), data.size(), dtype_tag,
-                                MPI_SUM, root_, comm_));
+        // The data is copied now and written back at the root on commit()
+        pending_.add(data.data(), data.data(), data.size());
     }
 
 private:
     alps::mpi::communicator comm_;
     int root_;
+    mutable alps::mpi::packed_reduction pending_;
 };
 
 }}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+#include <alps/alea.hpp>
+#include <alps/alea/binary.hpp>
+
+#include "gtest/gtest.h"
+#include "dataset.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+TEST(binary_serializer, primitives) {
+    std::vector<char> buffer;
+    {
+        alps::alea::binary_serializer ser(buffer);
+        const size_t shape[2] = {2, 3};
+        const double data[6] = {1, 2, 3, 4, 5, 6};
+        const long count = -7;
+        const alps::alea::complex_op<double> op(1, 2, 3, 4);
+
+        ser.write("count", alps::alea::ndview<const long>(&count, nullptr, 0));
+        ser.enter("group");
+        ser.write("data", alps::alea::ndview<const double>(data, shape, 2));
+        ser.write("op", alps::alea::ndview<const alps::alea::complex_op<double> >(&op, nullptr, 0));
+        ser.exit();
+        ser.write("data", alps::alea::ndview<const double>(data, shape + 1, 1));
+        EXPECT_THROW(ser.exit(), std::runtime_error);
+    }
+
+    alps::alea::binary_deserializer deser(buffer.data(), buffer.size());
+
+    // keys can be read in any order
+    deser.enter("group");
+    EXPECT_EQ(std::vector<size_t>({2, 3}), deser.get_shape("data"));
+    alps::alea::complex_op<double> op(0, 0, 0, 0);
+    deser.read("op", alps::alea::ndview<alps::alea::complex_op<double> >(&op, nullptr, 0));
+    EXPECT_EQ(alps::alea::complex_op<double>(1, 2, 3, 4), op);
+    std::vector<double> data(6);
+    const size_t shape[2] = {2, 3};
+    deser.read("data", alps::alea::ndview<double>(data.data(), shape, 2));
+    EXPECT_EQ(std::vector<double>({1, 2, 3, 4, 5, 6}), data);
+    EXPECT_THROW(deser.read("data", alps::alea::ndview<double>(data.data(), shape + 1, 1)),
+                 alps::alea::size_mismatch);
+    EXPECT_THROW(deser.read("count", alps::alea::ndview<long>(nullptr, nullptr, 0)),
+                 std::runtime_error);
+    deser.exit();
+
+    std::vector<double> top(3);
+    deser.read("data", alps::alea::ndview<double>(top.data(), shape + 1, 1));
+    EXPECT_EQ(std::vector<double>({1, 2, 3}), top);
+    long count = 0;
+    deser.read("count", alps::alea::ndview<long>(&count, nullptr, 0));
+    EXPECT_EQ(-7, count);
+    EXPECT_THROW(deser.read("count", alps::alea::ndview<double>(nullptr, nullptr, 0)),
+                 std::runtime_error);
+    EXPECT_THROW(deser.exit(), std::runtime_error);
+
+    EXPECT_THROW(alps::alea::binary_deserializer(buffer.data() + 8, buffer.size() - 8),
+                 std::runtime_error);
+}
+
+TEST(binary_serializer, corrupt) {
+    std::vector<char> buffer;
+    {
+        alps::alea::binary_serializer ser(buffer);
+        const size_t shape[1] = {4};
+        const double data[4] = {1, 2, 3, 4};
+        ser.enter("group");
+        ser.write("data", alps::alea::ndview<const double>(data, shape, 1));
+        ser.exit();
+    }
+    std::vector<double> data(4);
+    const size_t shape[1] = {4};
+
+    // every truncation up to the data is detected before reading past the end
+    const size_t data_end = buffer.size() - sizeof(alps::alea::internal::binary_record);
+    for (size_t size = 8; size < data_end; ++size) {
+        std::vector<char> truncated(buffer.begin(), buffer.begin() + size);
+        alps::alea::binary_deserializer deser(truncated);
+        EXPECT_THROW({
+            deser.enter("group");
+            deser.read("data", alps::alea::ndview<double>(data.data(), shape, 1));
+        }, std::runtime_error) << "size=" << size;
+    }
+
+    // huge sizes in a header must not overflow the bounds check
+    const size_t data_header = 8 + sizeof(alps::alea::internal::binary_record) + 8;
+    for (size_t field = 8; field != 32; field += 8) {
+        std::vector<char> corrupt(buffer);
+        const std::uint64_t huge = ~std::uint64_t(0) / 4;
+        std::memcpy(&corrupt[data_header + field], &huge, sizeof(huge));
+        alps::alea::binary_deserializer deser(corrupt);
+        deser.enter("group");
+        EXPECT_THROW(deser.get_shape("data"), std::runtime_error) << "field=" << field;
+    }
+}
+
+template <typename Acc>
+class twogauss_binary_case
+    : public ::testing::Test
+{
+public:
+    typedef typename alps::alea::traits<Acc>::value_type value_type;
+
+    void test_result()
+    {
+        Acc in_acc(2);
+        for (size_t i = 0; i != twogauss_count; ++i)
+            in_acc << std::vector<value_type>{twogauss_data[i][0], twogauss_data[i][1]};
+        auto in = in_acc.result();
+
+        std::vector<char> buffer;
+        alps::alea::binary_serializer ser(buffer);
+        alps::alea::serialize(ser, "result", in);
+
+        Acc out_acc(2);
+        auto out = out_acc.result();
+        alps::alea::binary_deserializer deser(buffer);
+        alps::alea::deserialize(deser, "result", out);
+        EXPECT_EQ(in, out);
+    }
+};
+
+using namespace alps::alea;
+
+typedef ::testing::Types<
+        mean_acc<double>
+      , mean_acc<std::complex<double> >
+      , var_acc<double>
+      , var_acc<std::complex<double> >
+      , var_acc<std::complex<double>, elliptic_var>
+      , cov_acc<double>
+      , cov_acc<std::complex<double> >
+      , cov_acc<std::complex<double>, elliptic_var>
+      , autocorr_acc<double>
+      , autocorr_acc<std::complex<double> >
+      , batch_acc<double>
+      , batch_acc<std::complex<double> >
+    > binary_serializable;
+
+TYPED_TEST_CASE(twogauss_binary_case, binary_serializable);
+TYPED_TEST(twogauss_binary_case, test_result) { this->test_result(); }
@@ -156,6 +156,13 @@ macro(add_boost) # usage: add_boost(component1 component2...)
   target_link_libraries(${PROJECT_NAME} PUBLIC ${Boost_LIBRARIES})
 endmacro(add_boost)
 
+# link the thread library if thread support is enabled (see ALPSEnableThreads.cmake)
+macro(add_threads)
+  if (ALPS_ENABLE_THREADS)
+    target_link_libraries(${PROJECT_NAME} PUBLIC ${CMAKE_THREAD_LIBS_INIT})
+  endif()
+endmacro(add_threads)
+
 macro(add_hdf5) 
   if (ALPS_BUILD_STATIC)
     set(HDF5_USE_STATIC_LIBRARIES ON)
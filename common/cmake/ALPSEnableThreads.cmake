@@ -0,0 +1,16 @@
+#
+# This cmake script enables thread support in ALPSCore:
+# per-file locks in alps::hdf5::archive and threads in alps::thread_pool.
+# Without it, ALPS_SINGLE_THREAD is defined in alps/config.hpp and everything runs serially.
+#
+
+# configurable option
+option(ALPS_ENABLE_THREADS "Enable thread support" OFF)
+set(ALPS_SINGLE_THREAD TRUE)
+if (ALPS_ENABLE_THREADS)
+  find_package(Threads REQUIRED)
+  set(ALPS_SINGLE_THREAD FALSE)
+  message(STATUS "Thread support enabled")
+else()
+  message(STATUS "Thread support disabled. Set ALPS_ENABLE_THREADS to ON to enable")
+endif()
@@ -0,0 +1,407 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file distributed_gf.hpp
+    @brief Green's functions block-partitioned along one mesh over the ranks of a communicator
+ */
+
+#ifndef ALPSCORE_GF_DISTRIBUTED_GF_HPP
+#define ALPSCORE_GF_DISTRIBUTED_GF_HPP
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <complex>
+#include <functional>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <alps/hdf5/archive.hpp>
+#include <alps/hdf5/tensor.hpp>
+#include <alps/utilities/mpi.hpp>
+
+#include <alps/gf/gf_base.hpp>
+
+namespace alps {
+  namespace gf {
+    namespace detail {
+      /// Values are transferred as arrays of their real components
+      template<class T>
+      struct mpi_scalar {
+        typedef T type;
+        static const int components = 1;
+      };
+      template<class T>
+      struct mpi_scalar<std::complex<T> > {
+        typedef T type;
+        static const int components = 2;
+      };
+
+      /// Type of the local block: the distributed mesh is replaced by an index_mesh
+      template<class VTYPE, size_t D, class Meshes, class Seq>
+      struct local_gf;
+      template<class VTYPE, size_t D, class ...MESHES, size_t...Is>
+      struct local_gf<VTYPE, D, std::tuple<MESHES...>, index_sequence<Is...> > {
+        using type = greenf<VTYPE, typename std::conditional<Is == D, index_mesh, MESHES>::type...>;
+      };
+    }
+
+    /**
+     * @brief Green's function distributed over the ranks of an MPI communicator
+     *
+     * The data is block-partitioned along the mesh `D`: with N points on this mesh and P ranks, rank r owns
+     * N/P consecutive points starting at `offset(r)`, the first N%P ranks own one point more. Each rank stores
+     * only its block as a regular GF (`local()`), in which mesh `D` is replaced by an `index_mesh`; the index
+     * `i` of the local GF corresponds to the point `local_offset() + i` of the global mesh.
+     *
+     * All operations except the accessors are collective over the communicator. The size of the GF is not limited
+     * by the `int` counts of MPI: `gather()`, `scatter()` and `allgather()` transfer whole points of the distributed
+     * mesh as one element, and `reduce()` falls back to segmented reductions.
+     *
+     * @tparam VTYPE  - value type
+     * @tparam D      - index of the distributed mesh
+     * @tparam MESHES - meshes of the global GF
+     */
+    template<class VTYPE, size_t D, class ...MESHES>
+    class distributed_gf {
+      static_assert(D < sizeof...(MESHES), "The distributed mesh index is out of range.");
+    public:
+      /// Value type
+      using value_type = VTYPE;
+      /// mesh types tuple
+      using mesh_types = std::tuple<MESHES...>;
+      /// type of the global GF
+      using gf_type = greenf<VTYPE, MESHES...>;
+      /// type of the block stored on each rank
+      using local_gf_type = typename detail::local_gf<VTYPE, D, mesh_types, make_index_sequence<sizeof...(MESHES)> >::type;
+
+    private:
+      using scalar_type = typename detail::mpi_scalar<VTYPE>::type;
+      static const int components = detail::mpi_scalar<VTYPE>::components;
+      static constexpr size_t N_ = sizeof...(MESHES);
+
+      /// communicator the GF is distributed over
+      alps::mpi::communicator comm_;
+      /// global meshes
+      mesh_types meshes_;
+      /// first point of the block of each rank on the distributed mesh; offsets_[P] is the mesh extent
+      std::vector<size_t> offsets_;
+      /// product of the extents of the meshes before and after the distributed one
+      size_t outer_;
+      size_t inner_;
+      /// block of the current rank
+      local_gf_type local_;
+
+    public:
+      /// Create empty distributed GF, e.g. to be loaded from an archive
+      explicit distributed_gf(const alps::mpi::communicator &comm) : comm_(comm), offsets_(comm.size() + 1, 0), outer_(0), inner_(0) {}
+
+      /// Create distributed GF with the given global meshes; the local block is initialized with zeros
+      distributed_gf(const alps::mpi::communicator &comm, MESHES...meshes) : distributed_gf(comm, std::make_tuple(meshes...)) {}
+
+      /// Create distributed GF with the global meshes given as tuple
+      distributed_gf(const alps::mpi::communicator &comm, const mesh_types &meshes) : comm_(comm), meshes_(meshes) {
+        partition();
+      }
+
+      /// Distribute the GF `g` stored on `root`; its meshes are broadcast and `g` is ignored on the other ranks
+      distributed_gf(const alps::mpi::communicator &comm, const gf_type &g, int root) : comm_(comm) {
+        if (comm_.rank() == root) meshes_ = g.meshes();
+        detail::broadcast_meshes(comm_, meshes_, root);
+        partition();
+        scatter(g, root);
+      }
+
+      /// @return communicator the GF is distributed over
+      const alps::mpi::communicator &comm() const { return comm_; }
+      /// @return global meshes
+      const mesh_types &meshes() const { return meshes_; }
+      /// @return first point of the block owned by rank `r` on the distributed mesh
+      size_t offset(int r) const { return offsets_[r]; }
+      /// @return number of points of the distributed mesh owned by rank `r`
+      size_t extent(int r) const { return offsets_[r + 1] - offsets_[r]; }
+      /// @return first point of the local block on the distributed mesh
+      size_t local_offset() const { return offset(comm_.rank()); }
+      /// @return number of points of the distributed mesh in the local block
+      size_t local_extent() const { return extent(comm_.rank()); }
+      /// @return rank owning the point `i` of the distributed mesh
+      int owner(size_t i) const {
+        return int(std::upper_bound(offsets_.begin(), offsets_.end(), i) - offsets_.begin()) - 1;
+      }
+
+      /// @return local block
+      local_gf_type &local() { return local_; }
+      /// @return local block
+      const local_gf_type &local() const { return local_; }
+
+      /**
+       * Distribute the GF `g` stored on `root`; `g` is ignored on the other ranks.
+       * Throws std::invalid_argument on all ranks if the meshes of `g` differ from the meshes of this object.
+       */
+      void scatter(const gf_type &g, int root) {
+        check_root_meshes(g, root);
+        std::vector<VTYPE> buffer;
+        const VTYPE *send = comm_.rank() == root ? pack(g.data().data(), buffer) : nullptr;
+        std::vector<int> counts, displs;
+        block_counts(counts, displs);
+        block_type unit(inner_ * components);
+        MPI_Scatterv(const_cast<scalar_type *>(reinterpret_cast<const scalar_type *>(send)), &counts[0], &displs[0],
+                     unit, reinterpret_cast<scalar_type *>(local_.data().data()), counts[comm_.rank()],
+                     unit, root, comm_);
+      }
+
+      /// Collect the GF on `root`; an empty GF is returned on the other ranks
+      gf_type gather(int root) const {
+        std::vector<int> counts, displs;
+        block_counts(counts, displs);
+        block_type unit(inner_ * components);
+        std::vector<VTYPE> buffer(comm_.rank() == root ? outer_ * offsets_.back() * inner_ : 0);
+        MPI_Gatherv(const_cast<scalar_type *>(reinterpret_cast<const scalar_type *>(local_.data().data())),
+                    counts[comm_.rank()], unit,
+                    reinterpret_cast<scalar_type *>(buffer.data()), &counts[0], &displs[0], unit, root, comm_);
+        if (comm_.rank() != root) return gf_type();
+        gf_type g(meshes_);
+        unpack(buffer, g.data().data());
+        return g;
+      }
+
+      /// Collect the GF on all ranks
+      gf_type allgather() const {
+        std::vector<int> counts, displs;
+        block_counts(counts, displs);
+        block_type unit(inner_ * components);
+        std::vector<VTYPE> buffer(outer_ * offsets_.back() * inner_);
+        MPI_Allgatherv(const_cast<scalar_type *>(reinterpret_cast<const scalar_type *>(local_.data().data())),
+                       counts[comm_.rank()], unit,
+                       reinterpret_cast<scalar_type *>(buffer.data()), &counts[0], &displs[0], unit, comm_);
+        gf_type g(meshes_);
+        unpack(buffer, g.data().data());
+        return g;
+      }
+
+      /**
+       * Sum the contributions of all ranks to the global GF and store the local block of the sum,
+       * e.g. to combine partial sums over momenta computed on every rank.
+       */
+      void reduce(const gf_type &contribution) {
+        if (contribution.meshes() != meshes_) {
+          throw std::invalid_argument("Green Functions have incompatible meshes");
+        }
+        std::vector<VTYPE> buffer;
+        const scalar_type *send = reinterpret_cast<const scalar_type *>(pack(contribution.data().data(), buffer));
+        size_t unit = inner_ * components;
+        if (outer_ * offsets_.back() * unit <= size_t(INT_MAX)) {
+          std::vector<int> counts(comm_.size());
+          for (int r = 0; r < comm_.size(); ++r) counts[r] = int(outer_ * extent(r) * unit);
+          MPI_Reduce_scatter(const_cast<scalar_type *>(send), reinterpret_cast<scalar_type *>(local_.data().data()),
+                             &counts[0], alps::mpi::detail::mpi_type<scalar_type>(), MPI_SUM, comm_);
+          return;
+        }
+        // reductions need a predefined type: reduce the block of each rank in segments
+        for (int r = 0; r < comm_.size(); ++r) {
+          if (extent(r) == 0) continue;
+          alps::mpi::reduce(comm_, send + outer_ * offset(r) * unit, outer_ * extent(r) * unit,
+                            r == comm_.rank() ? reinterpret_cast<scalar_type *>(local_.data().data()) : nullptr,
+                            std::plus<scalar_type>(), r);
+        }
+      }
+
+      /**
+       * Save the GF into an archive opened in parallel (MPI-IO) mode on the same communicator;
+       * every rank writes its own block. The layout is the same as for `gf_base::save`.
+       */
+      void save(alps::hdf5::archive &ar, const std::string &path) const {
+        if (!ar.is_parallel() && comm_.size() > 1) {
+          throw std::invalid_argument("Distributed GF can only be saved into a parallel archive, use save(filename, path)");
+        }
+        write_metadata(ar, path);
+        write_block(ar, path);
+      }
+
+      /**
+       * Save the GF into the file `filename`. The file is opened in parallel mode if the HDF5 library supports it,
+       * otherwise the ranks write their blocks one after another.
+       */
+      void save(const std::string &filename, const std::string &path) const {
+        if (alps::hdf5::archive::has_parallel_io()) {
+          alps::hdf5::archive ar(filename, comm_, "w");
+          save(ar, path);
+          return;
+        }
+        for (int r = 0; r < comm_.size(); ++r) {
+          if (r == comm_.rank()) {
+            alps::hdf5::archive ar(filename, "w");
+            if (r == 0) write_metadata(ar, path);
+            if (local_extent() > 0) write_block(ar, path);
+          }
+          comm_.barrier();
+        }
+      }
+
+      /**
+       * Load the GF stored at `path`; every rank reads only its own block.
+       * The archive can be opened by each rank independently.
+       */
+      void load(alps::hdf5::archive &ar, const std::string &path) {
+        if (!gf_type().check_version(ar, path)) throw std::runtime_error("Incompatible archive version");
+        int ndim;
+        ar[path + "/mesh/N"] >> ndim;
+        if (ndim != int(N_)) throw std::runtime_error("Wrong number of dimension reading GF, ndim=" + std::to_string(ndim)
+                                                      + ", should be N=" + std::to_string(N_));
+        load_meshes(ar, path, make_index_sequence<N_>());
+        partition();
+        std::array<size_t, N_> offset, count;
+        block_shape(offset, count);
+        alps::hdf5::load_slice(ar, path + "/data", local_.data(), offset, count);
+      }
+
+    private:
+      /// compute block partition and allocate the local block
+      void partition() {
+        std::array<size_t, N_> sizes = global_sizes(make_index_sequence<N_>());
+        size_t npoints = sizes[D];
+        size_t nranks = comm_.size();
+        offsets_.resize(nranks + 1);
+        for (size_t r = 0; r <= nranks; ++r) {
+          offsets_[r] = r * (npoints / nranks) + std::min(r, npoints % nranks);
+        }
+        outer_ = std::accumulate(sizes.begin(), sizes.begin() + D, size_t(1), std::multiplies<size_t>());
+        inner_ = std::accumulate(sizes.begin() + D + 1, sizes.end(), size_t(1), std::multiplies<size_t>());
+        local_ = local_gf_type(local_meshes(make_index_sequence<N_>()));
+      }
+
+      template<size_t...Is>
+      std::array<size_t, N_> global_sizes(index_sequence<Is...>) const {
+        return {{size_t(std::get<Is>(meshes_).extent())...}};
+      }
+
+      template<size_t...Is>
+      typename local_gf_type::mesh_types local_meshes(index_sequence<Is...>) const {
+        return typename local_gf_type::mesh_types(local_mesh(std::get<Is>(meshes_), std::integral_constant<bool, Is == D>())...);
+      }
+      template<class MESH>
+      const MESH &local_mesh(const MESH &mesh, std::false_type) const { return mesh; }
+      template<class MESH>
+      index_mesh local_mesh(const MESH &, std::true_type) const { return index_mesh(int(local_extent())); }
+
+      /// Contiguous MPI datatype of `n` scalars, freed at the end of the scope
+      class block_type {
+        MPI_Datatype type_;
+        block_type(const block_type &);
+        block_type &operator=(const block_type &);
+      public:
+        explicit block_type(size_t n) {
+          if (n > size_t(INT_MAX)) {
+            throw std::runtime_error("Distributed GF: one point of the distributed mesh is too large for MPI transfers");
+          }
+          MPI_Type_contiguous(int(n), alps::mpi::detail::mpi_type<scalar_type>(), &type_);
+          MPI_Type_commit(&type_);
+        }
+        ~block_type() { MPI_Type_free(&type_); }
+        operator MPI_Datatype() const { return type_; }
+      };
+
+      /**
+       * Sizes and displacements of the blocks of all ranks in units of `block_type(inner_ * components)`,
+       * i.e. of one point of the distributed mesh for one index of the meshes before it
+       */
+      void block_counts(std::vector<int> &counts, std::vector<int> &displs) const {
+        if (outer_ * offsets_.back() > size_t(INT_MAX)) {
+          throw std::runtime_error("Distributed GF: too many points for MPI transfers");
+        }
+        counts.resize(comm_.size());
+        displs.resize(comm_.size());
+        for (int r = 0; r < comm_.size(); ++r) {
+          counts[r] = int(outer_ * extent(r));
+          displs[r] = int(outer_ * offset(r));
+        }
+      }
+
+      /// order the data of a global GF by the owning rank; no copy is made if the mesh D is the leading one
+      const VTYPE *pack(const VTYPE *data, std::vector<VTYPE> &buffer) const {
+        if (outer_ == 1) return data;
+        size_t npoints = offsets_.back();
+        buffer.resize(outer_ * npoints * inner_);
+        VTYPE *out = buffer.data();
+        for (int r = 0; r < comm_.size(); ++r) {
+          for (size_t o = 0; o < outer_; ++o) {
+            const VTYPE *in = data + (o * npoints + offset(r)) * inner_;
+            out = std::copy(in, in + extent(r) * inner_, out);
+          }
+        }
+        return buffer.data();
+      }
+
+      /// inverse of pack
+      void unpack(const std::vector<VTYPE> &buffer, VTYPE *data) const {
+        size_t npoints = offsets_.back();
+        const VTYPE *in = buffer.data();
+        for (int r = 0; r < comm_.size(); ++r) {
+          for (size_t o = 0; o < outer_; ++o) {
+            std::copy(in, in + extent(r) * inner_, data + (o * npoints + offset(r)) * inner_);
+            in += extent(r) * inner_;
+          }
+        }
+      }
+
+      /// check on all ranks that the GF on root has the meshes of this object
+      void check_root_meshes(const gf_type &g, int root) const {
+        int ok = comm_.rank() != root || g.meshes() == meshes_;
+        alps::mpi::broadcast(comm_, ok, root);
+        if (!ok) {
+          throw std::invalid_argument("Green Functions have incompatible meshes");
+        }
+      }
+
+      /// offset and size of the local block in the global data
+      void block_shape(std::array<size_t, N_> &offset, std::array<size_t, N_> &count) const {
+        offset.fill(0);
+        count = global_sizes(make_index_sequence<N_>());
+        offset[D] = local_offset();
+        count[D] = local_extent();
+      }
+
+      void write_metadata(alps::hdf5::archive &ar, const std::string &path) const {
+        gf_type().save_version(ar, path);
+        ar[path + "/mesh/N"] << int(N_);
+        save_meshes(ar, path, make_index_sequence<N_>());
+      }
+
+      /// write the local block as a slice of the global dataset
+      void write_block(alps::hdf5::archive &ar, const std::string &path) const {
+        std::array<size_t, N_> offset, count;
+        block_shape(offset, count);
+        std::array<size_t, N_> sizes = global_sizes(make_index_sequence<N_>());
+        std::vector<size_t> size(sizes.begin(), sizes.end()), chunk(count.begin(), count.end()), start(offset.begin(), offset.end());
+        if (components == 2) {
+          size.push_back(2);
+          chunk.push_back(2);
+          start.push_back(0);
+        }
+        ar.write(path + "/data", reinterpret_cast<const scalar_type *>(local_.data().data()), size, chunk, start);
+        if (components == 2) {
+          ar.set_complex(path + "/data");
+        }
+      }
+
+      template<size_t...Is>
+      void save_meshes(alps::hdf5::archive &ar, const std::string &path, index_sequence<Is...>) const {
+        std::tie(ar[path + "/mesh/" + std::to_string(Is+1)] << std::get < Is >(meshes_)...);
+      }
+
+      template<size_t...Is>
+      void load_meshes(alps::hdf5::archive &ar, const std::string &path, index_sequence<Is...>) {
+        std::tie(ar[path + "/mesh/" + std::to_string(Is+1)] >> std::get < Is >(meshes_)...);
+      }
+    };
+  }
+}
+
+#endif //ALPSCORE_GF_DISTRIBUTED_GF_HPP
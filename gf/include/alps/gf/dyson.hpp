@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+#pragma once
+#include <complex>
+#include <stdexcept>
+#include <tuple>
+
+#include <Eigen/Dense>
+
+#include <alps/gf/gf.hpp>
+#include <alps/utilities/thread_pool.hpp>
+
+/**
+ * Batched inversion of the orbital matrices of a Green's function and the Dyson equation
+ *   G(i\omega_n, k) = [i\omega_n + \mu - H(k) - \Sigma(i\omega_n, k)]^{-1}.
+ *
+ * The matrices are formed by the last two indices and are inverted in place in the storage of the GF,
+ * with kernels of fixed size for up to 8 orbitals and an LU decomposition otherwise. The outer indices
+ * are distributed over the threads of a `thread_pool`.
+ */
+namespace alps {
+namespace gf {
+
+namespace detail {
+
+/// Inverts the `norb` x `norb` matrices `begin`..`end` stored one after another at `data`
+template<int N> struct block_inverter {
+  typedef Eigen::Matrix<std::complex<double>, N, N, Eigen::RowMajor> matrix_type;
+  block_inverter(size_t) {}
+  void operator()(std::complex<double> *block) {
+    Eigen::Map<matrix_type> m(block);
+    m = m.inverse().eval();
+  }
+};
+
+template<> struct block_inverter<Eigen::Dynamic> {
+  typedef Eigen::Matrix<std::complex<double>, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> matrix_type;
+  size_t norb;
+  Eigen::PartialPivLU<matrix_type> lu;
+  block_inverter(size_t n) : norb(n), lu(n) {}
+  void operator()(std::complex<double> *block) {
+    Eigen::Map<matrix_type> m(block, norb, norb);
+    lu.compute(m);
+    m = lu.inverse();
+  }
+};
+
+/// Calls `fill(i, block)` and inverts the block for the matrices `begin`..`end`
+template<int N, typename FILL>
+void invert_range(std::complex<double> *data, size_t norb, size_t begin, size_t end, const FILL &fill) {
+  block_inverter<N> invert(norb);
+  for (size_t i=begin; i<end; ++i) {
+    std::complex<double> *block = data + i*norb*norb;
+    fill(i, block);
+    invert(block);
+  }
+}
+
+/// Fills and inverts `nblocks` matrices of size `norb` x `norb`, in parallel
+template<typename FILL>
+void invert_blocks(std::complex<double> *data, size_t nblocks, size_t norb, const FILL &fill, thread_pool &pool) {
+  pool.parallel_for(nblocks, [&](size_t begin, size_t end) {
+    switch (norb) {
+      case 1: invert_range<1>(data, norb, begin, end, fill); break;
+      case 2: invert_range<2>(data, norb, begin, end, fill); break;
+      case 3: invert_range<3>(data, norb, begin, end, fill); break;
+      case 4: invert_range<4>(data, norb, begin, end, fill); break;
+      case 5: invert_range<5>(data, norb, begin, end, fill); break;
+      case 6: invert_range<6>(data, norb, begin, end, fill); break;
+      case 7: invert_range<7>(data, norb, begin, end, fill); break;
+      case 8: invert_range<8>(data, norb, begin, end, fill); break;
+      default: invert_range<Eigen::Dynamic>(data, norb, begin, end, fill);
+    }
+  });
+}
+
+/// Leaves the block as it is
+struct keep_block {
+  void operator()(size_t, std::complex<double> *) const {}
+};
+
+}
+
+/// Inverts in place the matrices formed by the last two indices of the gf, for all other indices
+template<class S, class ...MESHES>
+void invert_orbital_matrices(detail::gf_base<std::complex<double>, S, MESHES...> &g,
+                             thread_pool &pool = thread_pool::global()) {
+  static const size_t N = sizeof...(MESHES);
+  static_assert(N >= 2, "The orbital matrices are formed by the last two indices");
+  size_t norb = g.data().shape()[N-1];
+  if (g.data().shape()[N-2] != norb)
+    throw std::invalid_argument("Can not do inversion of the non-square matrix.");
+  size_t nblocks = norb == 0 ? 0 : g.data().size()/(norb*norb);
+  detail::invert_blocks(g.data().data(), nblocks, norb, detail::keep_block(), pool);
+}
+
+/**
+ * Solves the Dyson equation G(i\omega_n, k) = [i\omega_n + \mu - H(k) - \Sigma(i\omega_n, k)]^{-1}
+ * for all frequencies and momenta. The self-energy may be the same object as `g`.
+ */
+template<class SG, class SS, class VH, class SH, mesh::frequency_positivity_type PTYPE>
+void solve_dyson(detail::gf_base<std::complex<double>, SG, matsubara_mesh<PTYPE>, momentum_index_mesh, index_mesh, index_mesh> &g,
+                 const detail::gf_base<std::complex<double>, SS, matsubara_mesh<PTYPE>, momentum_index_mesh, index_mesh, index_mesh> &sigma,
+                 const detail::gf_base<VH, SH, momentum_index_mesh, index_mesh, index_mesh> &hk, double mu,
+                 thread_pool &pool = thread_pool::global()) {
+  if (g.meshes() != sigma.meshes() ||
+      std::make_tuple(g.mesh2(), g.mesh3(), g.mesh4()) != hk.meshes())
+    throw std::invalid_argument("Green Functions have incompatible meshes");
+  size_t norb = g.mesh3().extent(), nk = g.mesh2().extent();
+  if (g.mesh4().extent() != int(norb))
+    throw std::invalid_argument("Can not do inversion of the non-square matrix.");
+  const std::vector<double> &omega = g.mesh1().points();
+  const std::complex<double> *s = sigma.data().data();
+  const VH *h = hk.data().data();
+  size_t nblocks = omega.size()*nk;
+  detail::invert_blocks(g.data().data(), nblocks, norb, [&](size_t i, std::complex<double> *block) {
+    const std::complex<double> *sb = s + i*norb*norb;
+    const VH *hb = h + (i%nk)*norb*norb;
+    std::complex<double> z(mu, omega[i/nk]);
+    for (size_t a=0; a<norb; ++a) {
+      for (size_t b=0; b<norb; ++b) {
+        block[a*norb + b] = (a == b ? z : 0.) - hb[a*norb + b] - sb[a*norb + b];
+      }
+    }
+  }, pool);
+}
+
+}
+} // end alps::
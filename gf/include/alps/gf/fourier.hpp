@@ -4,6 +4,14 @@
  * For use in publications, see ACKNOWLEDGE.TXT
  */
 #pragma once
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <unsupported/Eigen/FFT>
+
 #include <alps/gf/gf.hpp>
 
 namespace alps {
@@ -19,119 +27,291 @@ inline double f_tau(double tau, double beta, double c1, double c2, double c3) {
   return -0.5*c1 + (c2*0.25)*(-beta+2.*tau) + (c3*0.25)*(beta*tau-tau*tau);
 }
 
-///Fourier transform kernel of the omega -> tau transform
-inline void transform_vector_no_tail(const std::vector<std::complex<double> >&input_data, const std::vector<double> &omega, std::vector<double> &output_data, const std::vector<double> &tau, double beta){
-  for (unsigned int i=0; i<output_data.size(); ++i) {
-    output_data[i] = 0.;
-    for (unsigned int k=0; k<input_data.size(); ++k) {
-      double wt=omega[k]*tau[i];
-      output_data[i]+= 2/beta*(cos(wt)*input_data[k].real()+sin(wt)*input_data[k].imag());
+namespace detail {
+
+/// Number of intervals L if `tau` is the uniform grid tau_j = j*beta/L starting at zero, 0 otherwise
+inline int uniform_itime_intervals(const std::vector<double> &tau, double beta) {
+  if (tau.size() < 2 || tau[0] != 0. || tau[1] <= 0.) return 0;
+  double intervals = beta/tau[1];
+  long l = std::lround(intervals);
+  if (l < 1 || l > std::numeric_limits<int>::max() || std::abs(intervals - l) > 1e-10*intervals) return 0;
+  for (size_t j=0; j<tau.size(); ++j) {
+    if (std::abs(tau[j] - j*beta/l) > 1e-12*beta) return 0;
+  }
+  return int(l);
+}
+
+/// Statistics zeta if `omega` are the positive Matsubara frequencies omega_n = (2n+zeta)*pi/beta, -1 otherwise
+inline int positive_matsubara_statistics(const std::vector<double> &omega, double beta) {
+  if (omega.empty()) return -1;
+  int zeta = int(std::lround(omega[0]*beta/M_PI));
+  if (zeta != 0 && zeta != 1) return -1;
+  for (size_t n=0; n<omega.size(); ++n) {
+    if (std::abs(omega[n]*beta/M_PI - (2.*n + zeta)) > 1e-10*(2.*n + 1)) return -1;
+  }
+  return zeta;
+}
+
+/**
+ * omega -> tau transform on a uniform tau grid by FFT.
+ *
+ * With tau_j = j*beta/L and omega_n = (2n+zeta)*pi/beta the phases are exp(-i*pi*zeta*j/L)*exp(-2*pi*i*n*j/L),
+ * so frequencies n and n+L contribute with the same phase. Folding them first makes the transform a
+ * DFT of length L, and the result is identical to the direct sum.
+ */
+inline void transform_no_tail_fft(const std::complex<double> *input_data, size_t nfreq, double *output_data, size_t ntau,
+                                  size_t nother, double beta, int intervals, int zeta) {
+  numerics::aligned_vector<std::complex<double> > folded(size_t(intervals)*nother, 0.);
+  for (size_t n=0; n<nfreq; ++n) {
+    std::complex<double> *dst = &folded[(n%intervals)*nother];
+    const std::complex<double> *src = input_data + n*nother;
+    for (size_t i=0; i<nother; ++i) dst[i] += src[i];
+  }
+  std::vector<std::complex<double> > phase(ntau);
+  for (size_t j=0; j<ntau; ++j) {
+    phase[j] = 2/beta*std::polar(1., -M_PI*zeta*double(j)/intervals);
+  }
+  Eigen::FFT<double> fft;
+  std::vector<std::complex<double> > column(intervals), spectrum(intervals);
+  for (size_t i=0; i<nother; ++i) {
+    for (int k=0; k<intervals; ++k) column[k] = folded[k*nother + i];
+    fft.fwd(spectrum, column);
+    for (size_t j=0; j<ntau; ++j) {
+      output_data[j*nother + i] = (phase[j]*spectrum[j%intervals]).real();
     }
   }
 }
-///Fourier transform a two-index matsubara gf to an imag time gf
-template<class MESH1> void fourier_frequency_to_time(const two_index_gf_with_tail<
-    two_index_gf<std::complex<double>, matsubara_positive_mesh, MESH1>, one_index_gf<double, MESH1> > &g_omega,
-    two_index_gf_with_tail<two_index_gf<double, itime_mesh, MESH1>, one_index_gf<double, MESH1> > &g_tau){
 
-  std::vector<std::complex<double> > input_data(g_omega.mesh1().extent(), 0.);
-  std::vector<double >               output_data(g_tau.mesh1().extent(), 0.);
-
-  for(int i=0;i<g_omega.mesh2().extent();++i){
-    double c0=(g_omega.min_tail_order()==0 && g_omega.max_tail_order()>=0 )? g_omega.tail(0)(typename MESH1::index_type(i)):0;
-    double c1=(g_omega.min_tail_order()<=1 && g_omega.max_tail_order()>=1 )? g_omega.tail(1)(typename MESH1::index_type(i)):0;
-    double c2=(g_omega.min_tail_order()<=2 && g_omega.max_tail_order()>=2 )? g_omega.tail(2)(typename MESH1::index_type(i)):0;
-    double c3=(g_omega.min_tail_order()<=3 && g_omega.max_tail_order()>=3 )? g_omega.tail(3)(typename MESH1::index_type(i)):0;
-    if(c0 != 0) throw std::runtime_error("attempt to Fourier transform an object which goes to a constant. FT is ill defined");
-    for(int n=0;n<g_omega.mesh1().extent();++n){
-      input_data[n]=g_omega(matsubara_index(n),typename MESH1::index_type(i))-f_omega(g_omega.mesh1().points()[n],c1,c2,c3);
+/// omega -> tau transform for arbitrary meshes: a precomputed kernel applied to all vectors in one matrix product
+inline void transform_no_tail_gemm(const std::complex<double> *input_data, const std::vector<double> &omega,
+                                   double *output_data, const std::vector<double> &tau, size_t nother, double beta) {
+  typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> row_matrix;
+  typedef Eigen::Map<const row_matrix, 0, Eigen::Stride<Eigen::Dynamic, 2> > complex_part;
+  Eigen::MatrixXd cos_kernel(tau.size(), omega.size());
+  Eigen::MatrixXd sin_kernel(tau.size(), omega.size());
+  for (size_t k=0; k<omega.size(); ++k) {
+    for (size_t t=0; t<tau.size(); ++t) {
+      double wt=omega[k]*tau[t];
+      cos_kernel(t, k) = 2/beta*cos(wt);
+      sin_kernel(t, k) = 2/beta*sin(wt);
     }
-    transform_vector_no_tail(input_data,g_omega.mesh1().points(), output_data, g_tau.mesh1().points(), g_tau.mesh1().beta());
-    for(int t=0;t<g_tau.mesh1().extent();++t){
-      g_tau(itime_index(t),typename MESH1::index_type(i))=output_data[t]+f_tau(g_tau.mesh1().points()[t],g_tau.mesh1().beta(),c1,c2,c3);
+  }
+  const double *raw = reinterpret_cast<const double *>(input_data);
+  Eigen::Stride<Eigen::Dynamic, 2> stride(2*nother, 2);
+  complex_part re(raw, omega.size(), nother, stride);
+  complex_part im(raw + 1, omega.size(), nother, stride);
+  Eigen::Map<row_matrix> result(output_data, tau.size(), nother);
+  result.noalias() = cos_kernel*re;
+  result.noalias() += sin_kernel*im;
+}
+
+/**
+ * Fourier transform kernel of the omega -> tau transform for `nother` vectors at once.
+ *
+ * @param input_data  - nfreq x nother row-major array of Matsubara data
+ * @param output_data - ntau x nother row-major array for the imaginary time data
+ */
+inline void transform_no_tail(const std::complex<double> *input_data, const std::vector<double> &omega,
+                              double *output_data, const std::vector<double> &tau, size_t nother, double beta) {
+  int intervals = uniform_itime_intervals(tau, beta);
+  int zeta = positive_matsubara_statistics(omega, beta);
+  if (intervals > 0 && zeta >= 0)
+    transform_no_tail_fft(input_data, omega.size(), output_data, tau.size(), nother, beta, intervals, zeta);
+  else
+    transform_no_tail_gemm(input_data, omega, output_data, tau, nother, beta);
+}
+
+/// Fourier transform a matsubara gf with tail to an imag time gf; all indices but the first are transformed at once
+template<class GOMEGA, class GTAU> void fourier_frequency_to_time(const GOMEGA &g_omega, GTAU &g_tau) {
+  const std::vector<double> &omega = g_omega.mesh1().points();
+  const std::vector<double> &tau = g_tau.mesh1().points();
+  double beta = g_tau.mesh1().beta();
+  size_t nother = g_omega.data().size()/omega.size();
+  if (g_tau.data().size() != tau.size()*nother)
+    throw std::invalid_argument("Fourier transform between Green's functions with different index meshes");
+
+  std::vector<std::vector<double> > c(4, std::vector<double>(nother, 0.));
+  for (int order=0; order<4; ++order) {
+    if (g_omega.min_tail_order()<=order && g_omega.max_tail_order()>=order) {
+      const double *tail = g_omega.tail(order).data().data();
+      std::copy(tail, tail + nother, c[order].begin());
+    }
+  }
+  for (size_t i=0; i<nother; ++i) {
+    if (c[0][i] != 0) throw std::runtime_error("attempt to Fourier transform an object which goes to a constant. FT is ill defined");
+  }
+
+  std::vector<std::complex<double> > input_data(omega.size()*nother);
+  const std::complex<double> *g = g_omega.data().data();
+  for (size_t n=0; n<omega.size(); ++n) {
+    for (size_t i=0; i<nother; ++i) {
+      input_data[n*nother + i] = g[n*nother + i] - f_omega(omega[n], c[1][i], c[2][i], c[3][i]);
+    }
+  }
+  double *output_data = g_tau.data().data();
+  transform_no_tail(&input_data[0], omega, output_data, tau, nother, beta);
+  for (size_t t=0; t<tau.size(); ++t) {
+    for (size_t i=0; i<nother; ++i) {
+      output_data[t*nother + i] += f_tau(tau[t], beta, c[1][i], c[2][i], c[3][i]);
     }
   }
 }
-///Fourier transform a three-index matsubara gf to an imag time gf
-template<class MESH1, class MESH2> void fourier_frequency_to_time(const three_index_gf_with_tail<
-    three_index_gf<std::complex<double>, matsubara_positive_mesh, MESH1,MESH2>, two_index_gf<double, MESH1,MESH2> > &g_omega,
-    three_index_gf_with_tail<three_index_gf<double, itime_mesh, MESH1,MESH2>, two_index_gf<double, MESH1,MESH2> > &g_tau){
 
-  std::vector<std::complex<double> > input_data(g_omega.mesh1().extent(), 0.);
-  std::vector<double >               output_data(g_tau.mesh1().extent(), 0.);
-
-  for(int i=0;i<g_omega.mesh2().extent();++i){
-    for(int j=0;j<g_omega.mesh3().extent();++j){
-      double c0=(g_omega.min_tail_order()==0 && g_omega.max_tail_order()>=0 )? g_omega.tail(0)(typename MESH1::index_type(i),typename MESH2::index_type(j)):0;
-      double c1=(g_omega.min_tail_order()<=1 && g_omega.max_tail_order()>=1 )? g_omega.tail(1)(typename MESH1::index_type(i),typename MESH2::index_type(j)):0;
-      double c2=(g_omega.min_tail_order()<=2 && g_omega.max_tail_order()>=2 )? g_omega.tail(2)(typename MESH1::index_type(i),typename MESH2::index_type(j)):0;
-      double c3=(g_omega.min_tail_order()<=3 && g_omega.max_tail_order()>=3 )? g_omega.tail(3)(typename MESH1::index_type(i),typename MESH2::index_type(j)):0;
-      if(c0 != 0) throw std::runtime_error("attempt to Fourier transform an object which goes to a constant. FT is ill defined");
-      for(int n=0;n<g_omega.mesh1().extent();++n){
-        input_data[n]=g_omega(matsubara_index(n),typename MESH1::index_type(i),typename MESH2::index_type(j))-f_omega(g_omega.mesh1().points()[n],c1,c2,c3);
+
+/// Attenuation factor of the Fourier integral of a cubic spline relative to the plain DFT at theta = omega*dtau
+inline double spline_attenuation(double theta) {
+  if (std::abs(theta) < 1e-4) return 1.; // W(theta) = 1 + O(theta^4)
+  double c = cos(theta);
+  double theta2 = theta*theta;
+  return 12.*(1.-c)*(1.-c)/((2.+c)*theta2*theta2);
+}
+
+/**
+ * tau -> omega transform on the uniform tau grid tau_j = j*beta/L for `nother` vectors at once.
+ *
+ * The data is interpolated by the cubic spline that is periodic (bosons) or antiperiodic (fermions) in beta,
+ * i.e. the first and second derivatives are continuous across the endpoints. This is exact for data with the
+ * tail subtracted, whose jumps at the endpoints are carried by the tail. If the last point is included the
+ * spline value at tau=0 is the average of G(0) and +-G(beta). The Fourier integral of this spline is the DFT
+ * attenuated by W(omega*dtau) = 12(1-cos)^2/((2+cos)(omega*dtau)^4), evaluated with one FFT of length L.
+ *
+ * @param input_data  - ntau x nother row-major array of imaginary time data
+ * @param output_data - nfreq x nother row-major array for the Matsubara data
+ */
+inline void transform_itime_no_tail(const double *input_data, size_t ntau, std::complex<double> *output_data,
+                                    const std::vector<double> &omega, size_t nother, double beta, int intervals, int zeta) {
+  double dtau = beta/intervals;
+  std::vector<size_t> bin(omega.size());
+  std::vector<double> weight(omega.size());
+  for (size_t k=0; k<omega.size(); ++k) {
+    long n = std::lround((omega[k]*beta/M_PI - zeta)/2);
+    bin[k] = ((n % intervals) + intervals) % intervals;
+    weight[k] = dtau*spline_attenuation(omega[k]*dtau);
+  }
+  std::vector<std::complex<double> > twist(intervals);
+  for (int j=0; j<intervals; ++j) {
+    twist[j] = std::polar(1., M_PI*zeta*double(j)/intervals);
+  }
+  Eigen::FFT<double> fft;
+  fft.SetFlag(Eigen::FFT<double>::Unscaled);
+  std::vector<std::complex<double> > column(intervals), spectrum(intervals);
+  for (size_t i=0; i<nother; ++i) {
+    for (int j=0; j<intervals; ++j) column[j] = twist[j]*input_data[j*nother + i];
+    if (ntau > size_t(intervals)) column[0] = 0.5*(input_data[i] + (zeta ? -1. : 1.)*input_data[intervals*nother + i]);
+    fft.inv(spectrum, column);
+    for (size_t k=0; k<omega.size(); ++k) {
+      output_data[k*nother + i] = weight[k]*spectrum[bin[k]];
+    }
+  }
+}
+
+/// Fourier transform an imag time gf with tail to a matsubara gf; all indices but the first are transformed at once
+template<class GTAU, class GOMEGA> void fourier_time_to_frequency(const GTAU &g_tau, GOMEGA &g_omega) {
+  const std::vector<double> &tau = g_tau.mesh1().points();
+  const std::vector<double> &omega = g_omega.mesh1().points();
+  double beta = g_tau.mesh1().beta();
+  int zeta = g_omega.mesh1().statistics();
+  size_t nother = g_tau.data().size()/tau.size();
+  if (g_omega.data().size() != omega.size()*nother)
+    throw std::invalid_argument("Fourier transform between Green's functions with different index meshes");
+  if (std::abs(g_omega.mesh1().beta() - beta) > 1e-12*beta)
+    throw std::invalid_argument("Fourier transform between meshes with different inverse temperatures");
+  int intervals = uniform_itime_intervals(tau, beta);
+  if (intervals == 0 || (tau.size() != size_t(intervals) && tau.size() != size_t(intervals) + 1))
+    throw std::invalid_argument("Fourier transform requires a uniform imaginary time mesh");
+
+  std::vector<std::vector<double> > c(4, std::vector<double>(nother, 0.));
+  bool has_tail = false;
+  for (int order=0; order<4; ++order) {
+    if (g_tau.min_tail_order()<=order && g_tau.max_tail_order()>=order) {
+      const double *tail = g_tau.tail(order).data().data();
+      std::copy(tail, tail + nother, c[order].begin());
+    }
+  }
+  for (size_t i=0; i<nother; ++i) {
+    if (c[0][i] != 0) throw std::runtime_error("attempt to Fourier transform an object which goes to a constant. FT is ill defined");
+    has_tail = has_tail || c[1][i] != 0 || c[2][i] != 0 || c[3][i] != 0;
+  }
+  if (has_tail && zeta != statistics::FERMIONIC)
+    throw std::invalid_argument("tail corrections of the Fourier transform are only implemented for fermions");
+
+  std::vector<double> input_data(g_tau.data().data(), g_tau.data().data() + tau.size()*nother);
+  if (has_tail) {
+    for (size_t t=0; t<tau.size(); ++t) {
+      for (size_t i=0; i<nother; ++i) {
+        input_data[t*nother + i] -= f_tau(tau[t], beta, c[1][i], c[2][i], c[3][i]);
       }
-      transform_vector_no_tail(input_data,g_omega.mesh1().points(), output_data, g_tau.mesh1().points(), g_tau.mesh1().beta());
-      for(int t=0;t<g_tau.mesh1().extent();++t){
-        g_tau(itime_index(t),typename MESH1::index_type(i),typename MESH2::index_type(j))=output_data[t]+f_tau(g_tau.mesh1().points()[t],g_tau.mesh1().beta(),c1,c2,c3);
+    }
+  }
+  std::complex<double> *output_data = g_omega.data().data();
+  transform_itime_no_tail(&input_data[0], tau.size(), output_data, omega, nother, beta, intervals, zeta);
+  if (has_tail) {
+    for (size_t n=0; n<omega.size(); ++n) {
+      for (size_t i=0; i<nother; ++i) {
+        output_data[n*nother + i] += f_omega(omega[n], c[1][i], c[2][i], c[3][i]);
       }
     }
   }
+  if (g_tau.min_tail_order() != TAIL_NOT_SET) {
+    for (int order=g_tau.min_tail_order(); order<=g_tau.max_tail_order(); ++order) {
+      g_omega.set_tail(order, g_tau.tail(order));
+    }
+  }
+}
+
+}
+
+///Fourier transform kernel of the omega -> tau transform
+inline void transform_vector_no_tail(const std::vector<std::complex<double> >&input_data, const std::vector<double> &omega, std::vector<double> &output_data, const std::vector<double> &tau, double beta){
+  detail::transform_no_tail(&input_data[0], omega, &output_data[0], tau, 1, beta);
+}
+///Fourier transform a two-index matsubara gf to an imag time gf
+template<class MESH1> void fourier_frequency_to_time(const two_index_gf_with_tail<
+    two_index_gf<std::complex<double>, matsubara_positive_mesh, MESH1>, one_index_gf<double, MESH1> > &g_omega,
+    two_index_gf_with_tail<two_index_gf<double, itime_mesh, MESH1>, one_index_gf<double, MESH1> > &g_tau){
+  detail::fourier_frequency_to_time(g_omega, g_tau);
+}
+///Fourier transform a three-index matsubara gf to an imag time gf
+template<class MESH1, class MESH2> void fourier_frequency_to_time(const three_index_gf_with_tail<
+    three_index_gf<std::complex<double>, matsubara_positive_mesh, MESH1,MESH2>, two_index_gf<double, MESH1,MESH2> > &g_omega,
+    three_index_gf_with_tail<three_index_gf<double, itime_mesh, MESH1,MESH2>, two_index_gf<double, MESH1,MESH2> > &g_tau){
+  detail::fourier_frequency_to_time(g_omega, g_tau);
 }
 ///Fourier transform a four-index matsubara gf to an imag time gf
 template<class MESH1, class MESH2, class MESH3> void fourier_frequency_to_time(const four_index_gf_with_tail<
     four_index_gf<std::complex<double>, matsubara_positive_mesh, MESH1,MESH2,MESH3>, three_index_gf<double, MESH1,MESH2,MESH3> > &g_omega,
     four_index_gf_with_tail<four_index_gf<double, itime_mesh, MESH1,MESH2,MESH3>, three_index_gf<double, MESH1,MESH2,MESH3> > &g_tau){
-
-  std::vector<std::complex<double> > input_data(g_omega.mesh1().extent(), 0.);
-  std::vector<double >               output_data(g_tau.mesh1().extent(), 0.);
-
-  for(int i=0;i<g_omega.mesh2().extent();++i){
-    for(int j=0;j<g_omega.mesh3().extent();++j){
-      for(int k=0;k<g_omega.mesh4().extent();++k){
-        double c0=(g_omega.min_tail_order()==0 && g_omega.max_tail_order()>=0 )? g_omega.tail(0)(typename MESH1::index_type(i),typename MESH2::index_type(j),typename MESH3::index_type(k)):0;
-        double c1=(g_omega.min_tail_order()<=1 && g_omega.max_tail_order()>=1 )? g_omega.tail(1)(typename MESH1::index_type(i),typename MESH2::index_type(j),typename MESH3::index_type(k)):0;
-        double c2=(g_omega.min_tail_order()<=2 && g_omega.max_tail_order()>=2 )? g_omega.tail(2)(typename MESH1::index_type(i),typename MESH2::index_type(j),typename MESH3::index_type(k)):0;
-        double c3=(g_omega.min_tail_order()<=3 && g_omega.max_tail_order()>=3 )? g_omega.tail(3)(typename MESH1::index_type(i),typename MESH2::index_type(j),typename MESH3::index_type(k)):0;
-        if(c0 != 0) throw std::runtime_error("attempt to Fourier transform an object which goes to a constant. FT is ill defined");
-        for(int n=0;n<g_omega.mesh1().extent();++n){
-          input_data[n]=g_omega(matsubara_index(n),typename MESH1::index_type(i),typename MESH2::index_type(j),typename MESH3::index_type(k))-f_omega(g_omega.mesh1().points()[n],c1,c2,c3);
-        }
-        transform_vector_no_tail(input_data,g_omega.mesh1().points(), output_data, g_tau.mesh1().points(), g_tau.mesh1().beta());
-        for(int t=0;t<g_tau.mesh1().extent();++t){
-          g_tau(itime_index(t),typename MESH1::index_type(i),typename MESH2::index_type(j),typename MESH3::index_type(k))=output_data[t]+f_tau(g_tau.mesh1().points()[t],g_tau.mesh1().beta(),c1,c2,c3);
-        }
-      }
-    }
-  }
+  detail::fourier_frequency_to_time(g_omega, g_tau);
 }
 ///Fourier transform a five-index matsubara gf to an imag time gf
 template<class MESH1, class MESH2, class MESH3,class MESH4> void fourier_frequency_to_time(const five_index_gf_with_tail<
     five_index_gf<std::complex<double>, matsubara_positive_mesh, MESH1,MESH2,MESH3,MESH4>, four_index_gf<double, MESH1,MESH2,MESH3,MESH4> > &g_omega,
     five_index_gf_with_tail<five_index_gf<double, itime_mesh, MESH1,MESH2,MESH3,MESH4>, four_index_gf<double, MESH1,MESH2,MESH3,MESH4> > &g_tau){
-
-  std::vector<std::complex<double> > input_data(g_omega.mesh1().extent(), 0.);
-  std::vector<double >               output_data(g_tau.mesh1().extent(), 0.);
-
-  for(int i=0;i<g_omega.mesh2().extent();++i){
-    for(int j=0;j<g_omega.mesh3().extent();++j){
-      for(int k=0;k<g_omega.mesh4().extent();++k){
-        for(int l=0;l<g_omega.mesh5().extent();++l){
-        double c0=(g_omega.min_tail_order()==0 && g_omega.max_tail_order()>=0 )? g_omega.tail(0)(typename MESH1::index_type(i),typename MESH2::index_type(j),typename MESH3::index_type(k),typename MESH4::index_type(l)):0;
-        double c1=(g_omega.min_tail_order()<=1 && g_omega.max_tail_order()>=1 )? g_omega.tail(1)(typename MESH1::index_type(i),typename MESH2::index_type(j),typename MESH3::index_type(k),typename MESH4::index_type(l)):0;
-        double c2=(g_omega.min_tail_order()<=2 && g_omega.max_tail_order()>=2 )? g_omega.tail(2)(typename MESH1::index_type(i),typename MESH2::index_type(j),typename MESH3::index_type(k),typename MESH4::index_type(l)):0;
-        double c3=(g_omega.min_tail_order()<=3 && g_omega.max_tail_order()>=3 )? g_omega.tail(3)(typename MESH1::index_type(i),typename MESH2::index_type(j),typename MESH3::index_type(k),typename MESH4::index_type(l)):0;
-        if(c0 != 0) throw std::runtime_error("attempt to Fourier transform an object which goes to a constant. FT is ill defined");
-        for(int n=0;n<g_omega.mesh1().extent();++n){
-          input_data[n]=g_omega(matsubara_index(n),typename MESH1::index_type(i),typename MESH2::index_type(j),typename MESH3::index_type(k),typename MESH4::index_type(l))-f_omega(g_omega.mesh1().points()[n],c1,c2,c3);
-        }
-        transform_vector_no_tail(input_data,g_omega.mesh1().points(), output_data, g_tau.mesh1().points(), g_tau.mesh1().beta());
-        for(int t=0;t<g_tau.mesh1().extent();++t){
-          g_tau(itime_index(t),typename MESH1::index_type(i),typename MESH2::index_type(j),typename MESH3::index_type(k),typename MESH4::index_type(l))=output_data[t]+f_tau(g_tau.mesh1().points()[t],g_tau.mesh1().beta(),c1,c2,c3);
-        }
-        }
-      }
-    }
-  }
+  detail::fourier_frequency_to_time(g_omega, g_tau);
+}
+///Fourier transform a two-index imag time gf to a matsubara gf, the tail is copied to the matsubara gf
+template<mesh::frequency_positivity_type PTYPE, class MESH1> void fourier_time_to_frequency(const two_index_gf_with_tail<
+    two_index_gf<double, itime_mesh, MESH1>, one_index_gf<double, MESH1> > &g_tau,
+    two_index_gf_with_tail<two_index_gf<std::complex<double>, matsubara_mesh<PTYPE>, MESH1>, one_index_gf<double, MESH1> > &g_omega){
+  detail::fourier_time_to_frequency(g_tau, g_omega);
+}
+///Fourier transform a three-index imag time gf to a matsubara gf, the tail is copied to the matsubara gf
+template<mesh::frequency_positivity_type PTYPE, class MESH1, class MESH2> void fourier_time_to_frequency(const three_index_gf_with_tail<
+    three_index_gf<double, itime_mesh, MESH1,MESH2>, two_index_gf<double, MESH1,MESH2> > &g_tau,
+    three_index_gf_with_tail<three_index_gf<std::complex<double>, matsubara_mesh<PTYPE>, MESH1,MESH2>, two_index_gf<double, MESH1,MESH2> > &g_omega){
+  detail::fourier_time_to_frequency(g_tau, g_omega);
+}
+///Fourier transform a four-index imag time gf to a matsubara gf, the tail is copied to the matsubara gf
+template<mesh::frequency_positivity_type PTYPE, class MESH1, class MESH2, class MESH3> void fourier_time_to_frequency(const four_index_gf_with_tail<
+    four_index_gf<double, itime_mesh, MESH1,MESH2,MESH3>, three_index_gf<double, MESH1,MESH2,MESH3> > &g_tau,
+    four_index_gf_with_tail<four_index_gf<std::complex<double>, matsubara_mesh<PTYPE>, MESH1,MESH2,MESH3>, three_index_gf<double, MESH1,MESH2,MESH3> > &g_omega){
+  detail::fourier_time_to_frequency(g_tau, g_omega);
+}
+///Fourier transform a five-index imag time gf to a matsubara gf, the tail is copied to the matsubara gf
+template<mesh::frequency_positivity_type PTYPE, class MESH1, class MESH2, class MESH3,class MESH4> void fourier_time_to_frequency(const five_index_gf_with_tail<
+    five_index_gf<double, itime_mesh, MESH1,MESH2,MESH3,MESH4>, four_index_gf<double, MESH1,MESH2,MESH3,MESH4> > &g_tau,
+    five_index_gf_with_tail<five_index_gf<std::complex<double>, matsubara_mesh<PTYPE>, MESH1,MESH2,MESH3,MESH4>, four_index_gf<double, MESH1,MESH2,MESH3,MESH4> > &g_omega){
+  detail::fourier_time_to_frequency(g_tau, g_omega);
 }
 
 }
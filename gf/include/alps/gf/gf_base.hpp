@@ -21,6 +21,7 @@
 #endif
 
 #include <alps/gf/mesh.hpp>
+#include <alps/gf/gf_expression.hpp>
 #include <alps/numeric/tensors/tensor_base.hpp>
 #include <alps/type_traits/index_sequence.hpp>
 #include <alps/type_traits/tuple_traits.hpp>
@@ -55,11 +56,41 @@ namespace alps {
       }
     }
 
+    /**
+     * Mesh selectors for partial loading, see gf_base::load_slice
+     */
+    /// Select all points of a mesh; the mesh is kept in the loaded GF
+    struct all_t {};
+    constexpr all_t all{};
+    /// Select `size` consecutive points of a mesh starting at `first`; the mesh is replaced by an index_mesh
+    class index_range {
+      size_t first_;
+      size_t size_;
+    public:
+      index_range(size_t first, size_t size = 1) : first_(first), size_(size) {}
+      size_t first() const { return first_; }
+      size_t size() const { return size_; }
+    };
+
     /**
      * Definition of regular GF with dedicated storage
      */
     template<class VTYPE, class ...MESHES>
     using greenf = detail::gf_base<VTYPE, numerics::tensor<VTYPE, sizeof...(MESHES)>, MESHES...>;
+
+    namespace detail {
+      /// mesh of the loaded GF for a given selector
+      template<class MESH, class Selector> struct sliced_mesh;
+      template<class MESH> struct sliced_mesh<MESH, all_t> { using type = MESH; };
+      template<class MESH> struct sliced_mesh<MESH, index_range> { using type = index_mesh; };
+
+      /// type of the GF returned by load_slice
+      template<class VTYPE, class Meshes, class Selectors> struct sliced_gf;
+      template<class VTYPE, class ...MESHES, class ...Selectors>
+      struct sliced_gf<VTYPE, std::tuple<MESHES...>, std::tuple<Selectors...> > {
+        using type = greenf<VTYPE, typename sliced_mesh<MESHES, Selectors>::type...>;
+      };
+    }
     /**
      * Definition of GF as view of existent data array
      */
@@ -198,6 +229,10 @@ namespace alps {
           static_assert(std::is_convertible<RHS_VTYPE, VTYPE>::value, "Right-hand side data type is not convertible into left-hand side.");
         }
 
+        /// evaluate GF expression into new GF object
+        template<typename Expr, typename St = Storage, typename = typename std::enable_if<std::is_same<data_storage, St>::value>::type>
+        gf_base(const gf_expression<Expr, mesh_types> &expr) : data_(expr.data()), meshes_(expr.meshes()), empty_(false) {}
+
         /// construct new green's function from index slice of GF with higher dimension
         template<typename St, typename...OLDMESHES, typename Index, typename ...Indices>
         gf_base(gf_base<VTYPE, numerics::detail::tensor_base < VTYPE, sizeof...(OLDMESHES), St >, OLDMESHES...> & g,
@@ -226,6 +261,15 @@ namespace alps {
           return *this;
         }
 
+        /// evaluate GF expression in a single loop, the meshes are taken from the expression
+        template<typename Expr>
+        gf_type& operator=(const gf_expression<Expr, mesh_types> &expr) {
+          swap_meshes(expr.meshes(), make_index_sequence<sizeof...(MESHES)>());
+          data_ = expr.data();
+          empty_ = false;
+          return *this;
+        }
+
         /// initialize with zeros
         void initialize() {
           data_.set_zero();
@@ -234,7 +278,13 @@ namespace alps {
         /// Check if meshes are compatible, throw if not
         void check_meshes(const gf_type& rhs) const
         {
-          if (meshes_ != rhs.meshes_) {
+          check_meshes(rhs.meshes_);
+        }
+
+        /// Check if meshes are the same as the given ones, throw if not
+        void check_meshes(const mesh_types& meshes) const
+        {
+          if (meshes_ != meshes) {
             throw std::invalid_argument("Green Functions have incompatible meshes");
           }
         }
@@ -323,6 +373,17 @@ namespace alps {
           return *this;
         }
 
+        /**
+         * Add GF expression inplace
+         */
+        template<typename Expr>
+        gf_type & operator+=(const gf_expression<Expr, mesh_types> &expr) {
+          throw_if_empty();
+          check_meshes(expr.meshes());
+          data_ += expr.data();
+          return *this;
+        }
+
         /**
          * Compute difference of current GF object and rhs
          *
@@ -349,6 +410,17 @@ namespace alps {
           return *this;
         }
 
+        /**
+         * Subtract GF expression inplace
+         */
+        template<typename Expr>
+        gf_type & operator-=(const gf_expression<Expr, mesh_types> &expr) {
+          throw_if_empty();
+          check_meshes(expr.meshes());
+          data_ -= expr.data();
+          return *this;
+        }
+
         /**
          * Scaling by scalar inplace
          *
@@ -448,8 +520,7 @@ namespace alps {
          */
         double norm() const {
           throw_if_empty();
-          return std::abs(*std::max_element(data_.data(), data_.num_elements() + data_.data(),
-                                            [](VTYPE a, VTYPE b) {return std::abs(a) < std::abs(b);} ) );
+          return data_.max_abs();
         }
 
         // reshape green's function
@@ -502,6 +573,29 @@ namespace alps {
           empty_ = false;
         }
 
+        /**
+         * Load a block of the GF stored at `path`, reading only that block from the file.
+         *
+         * For every mesh a selector is passed: `alps::gf::all` loads the whole mesh, `index_range(first, size)`
+         * loads `size` points starting at `first` and replaces the mesh by an `index_mesh` in the result.
+         * E.g. `omega_k_sigma_gf::load_slice(ar, "/G", all, index_range(k), all)` loads a single momentum point.
+         *
+         * @return new GF object with the sliced meshes
+         */
+        template<typename ...Selectors>
+        static typename sliced_gf<VTYPE, mesh_types, std::tuple<Selectors...> >::type
+        load_slice(alps::hdf5::archive &ar, const std::string &path, Selectors...selectors) {
+          static_assert(sizeof...(Selectors) == sizeof...(MESHES), "One selector per mesh is required.");
+          int ver;
+          ar[path + "/version/major"] >> ver;
+          if (ver != major_version) throw std::runtime_error("Incompatible archive version");
+          int ndim;
+          ar[path + "/mesh/N"] >> ndim;
+          if (ndim != N_) throw std::runtime_error("Wrong number of dimension reading GF, ndim=" + std::to_string(ndim)
+                                                   + ", should be N=" + std::to_string(N_));
+          return load_slice_impl(ar, path, make_index_sequence<sizeof...(MESHES)>(), selectors...);
+        }
+
         /// Save version of the GF object to maintain compatibility
         void save_version(alps::hdf5::archive &ar, const std::string &path) const {
           std::string vp = path + "/version/";
@@ -556,13 +650,30 @@ namespace alps {
         void broadcast(const alps::mpi::communicator& comm, int root) {
           // check that root GF has been initilized
           if(comm.rank() == root) throw_if_empty();
-          // broadcast grid meshes
-          broadcast_mesh(comm, root);
-          size_t root_sz=data_.size();
-          alps::mpi::broadcast(comm, root_sz, root);
-          // as long as all grids have been broadcasted we can define tensor object
-          if(comm.rank() != root) data_ = numerics::tensor < VTYPE, N_ >(get_sizes(meshes_));
-          alps::mpi::broadcast(comm, &data_.storage().data(0), root_sz, root);
+          // the meshes go in a single message, the data are received directly into data_
+          alps::mpi::broadcast_packed(comm, *this, root);
+          broadcast_data(comm, root);
+        }
+
+        /// Broadcast the data of a GF whose meshes already agree on all ranks
+        void broadcast_data(const alps::mpi::communicator& comm, int root) {
+          alps::mpi::broadcast(comm, data_.data(), data_.size(), root);
+        }
+
+        /// Pack the meshes and the data size for an MPI transfer; the data are sent by broadcast_data()
+        void pack(alps::mpi::packer& p) const {
+          pack_mesh(p, std::integral_constant < int, 0 >());
+          p << data_.size();
+        }
+
+        /// Unpack the meshes and the data size, and allocate the data
+        void unpack(alps::mpi::unpacker& u) {
+          unpack_mesh(u, std::integral_constant < int, 0 >());
+          size_t root_sz=0;
+          u >> root_sz;
+          // as long as all grids have been unpacked we can define tensor object
+          data_ = numerics::tensor < VTYPE, N_ >(get_sizes(meshes_));
+          if (root_sz != data_.size()) throw std::runtime_error("gf data size does not match the meshes in unpack()");
         }
 #endif
 
@@ -573,20 +684,24 @@ namespace alps {
          */
 #ifdef ALPS_HAVE_MPI
         /**
-         * Perform recursive call for mesh broadcasting
+         * Perform recursive call for mesh packing
          */
-        void broadcast_mesh(const alps::mpi::communicator& comm, int root) {
-          // start from the zeroth mesh
-          bcast_mesh(comm, root, std::integral_constant < int, 0 >());
-        }
         template<int M>
-        void bcast_mesh(const alps::mpi::communicator& comm, int root, std::integral_constant < int, M > i) {
-          std::get<M>(meshes_).broadcast(comm, root);
-          bcast_mesh(comm, root, std::integral_constant < int, M+1 >());
+        void pack_mesh(alps::mpi::packer& p, std::integral_constant < int, M > i) const {
+          std::get<M>(meshes_).pack(p);
+          pack_mesh(p, std::integral_constant < int, M+1 >());
         }
         // Until we reach the last mesh object
-        void bcast_mesh(const alps::mpi::communicator& comm, int root, std::integral_constant < int, N_ - 1> i) {
-          std::get<N_ - 1>(meshes_).broadcast(comm, root);
+        void pack_mesh(alps::mpi::packer& p, std::integral_constant < int, N_ - 1> i) const {
+          std::get<N_ - 1>(meshes_).pack(p);
+        }
+        template<int M>
+        void unpack_mesh(alps::mpi::unpacker& u, std::integral_constant < int, M > i) {
+          std::get<M>(meshes_).unpack(u);
+          unpack_mesh(u, std::integral_constant < int, M+1 >());
+        }
+        void unpack_mesh(alps::mpi::unpacker& u, std::integral_constant < int, N_ - 1> i) {
+          std::get<N_ - 1>(meshes_).unpack(u);
         }
 #endif
 
@@ -690,6 +805,37 @@ namespace alps {
           std::tie(ar[path + "/mesh/" + std::to_string(Is+1)] >> std::get < Is >(meshes_)...);
         }
 
+        template<size_t...Is, typename ...Selectors>
+        static typename sliced_gf<VTYPE, mesh_types, std::tuple<Selectors...> >::type
+        load_slice_impl(alps::hdf5::archive &ar, const std::string &path, index_sequence<Is...>, Selectors...selectors) {
+          using result_type = typename sliced_gf<VTYPE, mesh_types, std::tuple<Selectors...> >::type;
+          std::array<size_t, N_> offset;
+          std::array<size_t, N_> count;
+          typename result_type::mesh_types meshes(load_sliced_mesh<MESHES>(ar, path + "/mesh/" + std::to_string(Is+1),
+                                                                           selectors, offset[Is], count[Is])...);
+          data_storage data(count);
+          alps::hdf5::load_slice(ar, path + "/data", data, offset, count);
+          return result_type(std::move(data), meshes);
+        }
+
+        /// load the complete mesh
+        template<typename MESH>
+        static MESH load_sliced_mesh(alps::hdf5::archive &ar, const std::string &path, all_t, size_t &offset, size_t &count) {
+          MESH mesh;
+          ar[path] >> mesh;
+          offset = 0;
+          count = mesh.extent();
+          return mesh;
+        }
+
+        /// the selected points are described by an index mesh
+        template<typename MESH>
+        static index_mesh load_sliced_mesh(alps::hdf5::archive &, const std::string &, index_range range, size_t &offset, size_t &count) {
+          offset = range.first();
+          count = range.size();
+          return index_mesh(int(count));
+        }
+
         /**
          * Extract types from the tuple
          * We need this trick to provide intermediate level for enable_if to avoid type resolving for dimensions
@@ -751,6 +897,27 @@ namespace alps {
         }
       };
     }
+
+    namespace detail {
+      /// Green's function type with the meshes in the order Axes
+      template<class VTYPE, class MESHES, size_t...Axes>
+      struct permuted_greenf {
+        typedef greenf<VTYPE, typename std::tuple_element<Axes, MESHES>::type...> type;
+      };
+    }
+
+    /**
+     * Green's function with the meshes (and data) reordered: mesh i of the result is mesh Axes[i] of `g`,
+     * e.g. `permute<1,0,2,3>(g)` turns G(w,k,a,b) into G(k,w,a,b). The data is copied by a cache-blocked kernel.
+     */
+    template<size_t...Axes, class VTYPE, class Storage, class ...MESHES>
+    typename detail::permuted_greenf<VTYPE, std::tuple<MESHES...>, Axes...>::type
+    permute(const detail::gf_base<VTYPE, Storage, MESHES...> &g) {
+      static_assert(sizeof...(Axes) == sizeof...(MESHES), "Permutation should list every mesh once");
+      typename detail::permuted_greenf<VTYPE, std::tuple<MESHES...>, Axes...>::type result(std::get<Axes>(g.meshes())...);
+      result.data() = g.data().template permute<Axes...>();
+      return result;
+    }
   }
 }
 
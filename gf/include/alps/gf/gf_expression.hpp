@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#ifndef ALPSCORE_GF_EXPRESSION_HPP
+#define ALPSCORE_GF_EXPRESSION_HPP
+
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+
+#include <alps/numeric/tensors/tensor_expression.hpp>
+
+namespace alps {
+  namespace gf {
+    namespace detail {
+      template<class VTYPE, class Storage, class ...MESHES>
+      class gf_base;
+
+      /**
+       * @brief Lazily evaluated arithmetic expression of Green's functions defined on the same meshes
+       *
+       * The expression combines a tensor expression for the data with the meshes of its operands.
+       * Meshes are compared once per operand when the expression is built; assigning the expression to a GF
+       * evaluates the data in a single loop, without temporary GF objects.
+       * Operands are held by reference, so the expression should be assigned within the same statement.
+       *
+       * @tparam Expr   - tensor expression for the data
+       * @tparam Meshes - tuple of the mesh types
+       */
+      template<class Expr, class Meshes>
+      class gf_expression {
+        Expr data_;
+        const Meshes *meshes_;
+      public:
+        /// Value type of the expression
+        using value_type = typename Expr::value_type;
+        /// mesh types tuple
+        using mesh_types = Meshes;
+
+        gf_expression(const Expr &data, const Meshes &meshes) : data_(data), meshes_(&meshes) {}
+
+        /// tensor expression for the data
+        const Expr &data() const { return data_; }
+        /// meshes of the resulting GF
+        const Meshes &meshes() const { return *meshes_; }
+
+        /// Throw if the other expression is defined on different meshes
+        template<class Expr2>
+        void check_meshes(const gf_expression<Expr2, Meshes> &rhs) const {
+          if (meshes() != rhs.meshes()) {
+            throw std::invalid_argument("Green Functions have incompatible meshes");
+          }
+        }
+      };
+
+      /*
+       * Expression arithmetic
+       */
+      template<class L, class R, class Meshes>
+      gf_expression<numerics::detail::tensor_sum<L, R, false>, Meshes>
+      operator+(const gf_expression<L, Meshes> &lhs, const gf_expression<R, Meshes> &rhs) {
+        lhs.check_meshes(rhs);
+        return {numerics::detail::tensor_sum<L, R, false>(lhs.data(), rhs.data()), lhs.meshes()};
+      }
+
+      template<class L, class R, class Meshes>
+      gf_expression<numerics::detail::tensor_sum<L, R, true>, Meshes>
+      operator-(const gf_expression<L, Meshes> &lhs, const gf_expression<R, Meshes> &rhs) {
+        lhs.check_meshes(rhs);
+        return {numerics::detail::tensor_sum<L, R, true>(lhs.data(), rhs.data()), lhs.meshes()};
+      }
+
+      template<class E, class Meshes, class S>
+      auto operator*(const gf_expression<E, Meshes> &expr, S factor) ->
+          gf_expression<decltype(expr.data() * factor), Meshes> {
+        return {expr.data() * factor, expr.meshes()};
+      }
+
+      template<class E, class Meshes, class S>
+      auto operator*(S factor, const gf_expression<E, Meshes> &expr) ->
+          gf_expression<decltype(expr.data() * factor), Meshes> {
+        return {expr.data() * factor, expr.meshes()};
+      }
+
+      template<class E, class Meshes, class S>
+      auto operator/(const gf_expression<E, Meshes> &expr, S factor) ->
+          gf_expression<decltype(expr.data() / factor), Meshes> {
+        return {expr.data() / factor, expr.meshes()};
+      }
+
+      template<class E, class Meshes>
+      auto operator-(const gf_expression<E, Meshes> &expr) -> gf_expression<decltype(-expr.data()), Meshes> {
+        return {-expr.data(), expr.meshes()};
+      }
+    }
+
+    /**
+     * Start a lazily evaluated expression from a Green's function, e.g.
+     * `G = lazy(G0) + a * lazy(Sigma) - b * lazy(Delta);` computes G in a single sweep over the data.
+     * The arithmetic operators of the GF objects themselves return new GF objects.
+     */
+    template<class VTYPE, class Storage, class ...MESHES>
+    auto lazy(const detail::gf_base<VTYPE, Storage, MESHES...> &g) ->
+        detail::gf_expression<decltype(numerics::lazy(g.data())), std::tuple<MESHES...> > {
+#ifndef NDEBUG
+      if (g.is_empty()) {
+        throw std::runtime_error("gf is empty");
+      }
+#endif
+      return {numerics::lazy(g.data()), g.meshes()};
+    }
+  }
+}
+
+#endif //ALPSCORE_GF_EXPRESSION_HPP
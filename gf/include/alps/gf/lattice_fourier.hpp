@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <Eigen/Dense>
+#include <unsupported/Eigen/FFT>
+
+#include <alps/gf/gf.hpp>
+#include <alps/gf/transform_cache.hpp>
+
+/**
+ * Lattice Fourier transforms between real space and momentum meshes:
+ *   G(k) = \sum_R e^{-ik.R} G(R),   G(R) = 1/N_k \sum_k e^{ik.R} G(k).
+ *
+ * If the points of both meshes form the same regular grid, i.e. along every axis the R coordinates are
+ * n_i consecutive multiples of a spacing a_i (plus an offset) and k_i a_i n_i/(2 pi) is an integer, and every
+ * grid point appears exactly once in each mesh, the transform is a multidimensional FFT of size n_1 x ... x n_d.
+ * Otherwise the N_k x N_R phase matrix is applied as a matrix product. The plan (grid layout or phase matrix)
+ * is computed once per pair of meshes and cached (see lattice_fourier_plan()). All indices but the transformed one are transformed at once.
+ */
+namespace alps {
+namespace gf {
+
+namespace detail {
+
+/// How the lattice Fourier transform between a given pair of meshes is computed
+struct lattice_fourier_plan {
+  /// grid extents along each axis; empty if the points do not form a regular grid
+  std::vector<int> dims;
+  /// row-major grid position of each real space point
+  std::vector<size_t> r_position;
+  /// row-major grid position of each momentum point
+  std::vector<size_t> k_position;
+  /// e^{-ik.R_0} for the offset R_0 of the real space grid
+  std::vector<std::complex<double> > k_phase;
+  /// phase matrix e^{-ik.R} (N_k x N_R), only if the points do not form a regular grid
+  Eigen::MatrixXcd phase;
+
+  /// true if the transform is done by FFT
+  bool is_grid() const { return !dims.empty(); }
+};
+
+/// Fills the grid part of the plan; returns false if the points do not form a regular grid
+inline bool make_lattice_grid(const momentum_index_mesh::container_type &kpts,
+                              const real_space_index_mesh::container_type &rpts, lattice_fourier_plan &plan) {
+  const double tol = 1e-8;
+  size_t nk = kpts.shape()[0], nr = rpts.shape()[0], dim = rpts.shape()[1];
+  if (nk != nr) return false;
+  std::vector<int> dims(dim);
+  std::vector<double> origin(dim), spacing(dim);
+  std::vector<size_t> r_position(nr, 0), k_position(nk, 0);
+  for (size_t i=0; i<dim; ++i) {
+    std::vector<double> values(nr);
+    for (size_t p=0; p<nr; ++p) values[p] = rpts[p][i];
+    std::sort(values.begin(), values.end());
+    double scale = std::max(1., std::max(std::abs(values.front()), std::abs(values.back())));
+    values.erase(std::unique(values.begin(), values.end(), [&](double a, double b) { return b - a <= tol*scale; }),
+                 values.end());
+    int n = int(values.size());
+    double a = n > 1 ? values[1] - values[0] : 1.;
+    for (int j=0; j<n; ++j) {
+      if (std::abs(values[j] - values[0] - j*a) > tol*scale) return false;
+    }
+    for (size_t p=0; p<nr; ++p) {
+      r_position[p] = r_position[p]*n + size_t(std::lround((rpts[p][i] - values[0])/a));
+    }
+    for (size_t q=0; q<nk; ++q) {
+      // n > 1: k_i a n/(2 pi) has to be an integer m, taken modulo n
+      double x = n > 1 ? kpts[q][i]*a*n/(2*M_PI) : 0.;
+      long m = std::lround(x);
+      if (std::abs(x - m) > tol*std::max(1., std::abs(x))) return false;
+      k_position[q] = k_position[q]*n + size_t(((m % n) + n) % n);
+    }
+    dims[i] = n;
+    origin[i] = values[0];
+    spacing[i] = a;
+  }
+  // both meshes have to cover each grid point exactly once
+  size_t ngrid = 1;
+  for (size_t i=0; i<dim; ++i) ngrid *= dims[i];
+  if (ngrid != nr) return false;
+  std::vector<bool> seen_r(ngrid, false), seen_k(ngrid, false);
+  for (size_t p=0; p<nr; ++p) {
+    if (seen_r[r_position[p]]) return false;
+    seen_r[r_position[p]] = true;
+  }
+  for (size_t q=0; q<nk; ++q) {
+    if (seen_k[k_position[q]]) return false;
+    seen_k[k_position[q]] = true;
+  }
+  plan.dims = dims;
+  plan.r_position = r_position;
+  plan.k_position = k_position;
+  plan.k_phase.resize(nk);
+  for (size_t q=0; q<nk; ++q) {
+    double kr = 0;
+    for (size_t i=0; i<dim; ++i) kr += kpts[q][i]*origin[i];
+    plan.k_phase[q] = std::polar(1., -kr);
+  }
+  return true;
+}
+
+/// In-place FFT of a row-major grid of extents `dims`, with `inner` independent values per grid point
+inline void lattice_fft(numerics::aligned_vector<std::complex<double> > &work, const std::vector<int> &dims, size_t inner, bool forward) {
+  Eigen::FFT<double> fft;
+  fft.SetFlag(Eigen::FFT<double>::Unscaled);
+  size_t stride = inner;
+  for (size_t i=dims.size(); i-- > 0; ) {
+    size_t n = dims[i];
+    if (n > 1) {
+      std::vector<std::complex<double> > line(n), spectrum(n);
+      size_t nouter = work.size()/(n*stride);
+      for (size_t o=0; o<nouter; ++o) {
+        for (size_t t=0; t<stride; ++t) {
+          std::complex<double> *base = &work[o*n*stride + t];
+          for (size_t j=0; j<n; ++j) line[j] = base[j*stride];
+          if (forward) fft.fwd(spectrum, line); else fft.inv(spectrum, line);
+          for (size_t j=0; j<n; ++j) base[j*stride] = spectrum[j];
+        }
+      }
+    }
+    stride *= n;
+  }
+}
+
+typedef Eigen::Matrix<std::complex<double>, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> complex_row_matrix;
+
+inline Eigen::Map<const complex_row_matrix> lattice_block(const std::complex<double> *data, size_t rows, size_t cols) {
+  return Eigen::Map<const complex_row_matrix>(data, rows, cols);
+}
+inline Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> > lattice_block(const double *data, size_t rows, size_t cols) {
+  return Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> >(data, rows, cols);
+}
+
+/// R -> k for `nouter` blocks of N_R x `inner` values
+template<typename T>
+void apply_lattice_forward(const lattice_fourier_plan &plan, const T *in, std::complex<double> *out, size_t nouter, size_t inner) {
+  size_t nr = plan.r_position.size(), nk = plan.k_position.size();
+  if (!plan.is_grid()) {
+    nr = plan.phase.cols();
+    nk = plan.phase.rows();
+    for (size_t o=0; o<nouter; ++o) {
+      Eigen::Map<complex_row_matrix>(out + o*nk*inner, nk, inner).noalias() =
+          plan.phase*lattice_block(in + o*nr*inner, nr, inner).template cast<std::complex<double> >();
+    }
+    return;
+  }
+  numerics::aligned_vector<std::complex<double> > work(nr*inner);
+  for (size_t o=0; o<nouter; ++o) {
+    const T *src = in + o*nr*inner;
+    std::complex<double> *dst = out + o*nk*inner;
+    for (size_t p=0; p<nr; ++p) {
+      std::copy(src + p*inner, src + (p+1)*inner, &work[plan.r_position[p]*inner]);
+    }
+    lattice_fft(work, plan.dims, inner, true);
+    for (size_t q=0; q<nk; ++q) {
+      const std::complex<double> *w = &work[plan.k_position[q]*inner];
+      for (size_t t=0; t<inner; ++t) dst[q*inner + t] = plan.k_phase[q]*w[t];
+    }
+  }
+}
+
+/// k -> R for `nouter` blocks of N_k x `inner` values
+template<typename T>
+void apply_lattice_backward(const lattice_fourier_plan &plan, const T *in, std::complex<double> *out, size_t nouter, size_t inner) {
+  size_t nr = plan.r_position.size(), nk = plan.k_position.size();
+  if (!plan.is_grid()) {
+    nr = plan.phase.cols();
+    nk = plan.phase.rows();
+    for (size_t o=0; o<nouter; ++o) {
+      Eigen::Map<complex_row_matrix>(out + o*nr*inner, nr, inner).noalias() =
+          plan.phase.adjoint()*lattice_block(in + o*nk*inner, nk, inner).template cast<std::complex<double> >();
+      Eigen::Map<complex_row_matrix>(out + o*nr*inner, nr, inner) /= double(nk);
+    }
+    return;
+  }
+  numerics::aligned_vector<std::complex<double> > work(nk*inner);
+  for (size_t o=0; o<nouter; ++o) {
+    const T *src = in + o*nk*inner;
+    std::complex<double> *dst = out + o*nr*inner;
+    for (size_t q=0; q<nk; ++q) {
+      std::complex<double> *w = &work[plan.k_position[q]*inner];
+      std::complex<double> phase = std::conj(plan.k_phase[q])/double(nk);
+      for (size_t t=0; t<inner; ++t) w[t] = phase*src[q*inner + t];
+    }
+    lattice_fft(work, plan.dims, inner, false);
+    for (size_t p=0; p<nr; ++p) {
+      std::copy(&work[plan.r_position[p]*inner], &work[(plan.r_position[p]+1)*inner], dst + p*inner);
+    }
+  }
+}
+
+/// Position of the first mesh of type MESH in the parameter pack
+template<typename MESH, typename ...MESHES> struct mesh_position;
+template<typename MESH, typename ...REST> struct mesh_position<MESH, MESH, REST...> : std::integral_constant<size_t, 0> {};
+template<typename MESH, typename FIRST, typename ...REST> struct mesh_position<MESH, FIRST, REST...>
+    : std::integral_constant<size_t, 1 + mesh_position<MESH, REST...>::value> {};
+
+/// Sizes of the indices before and after the transformed one; throws if the other indices differ
+template<size_t N, typename IN, typename OUT>
+std::pair<size_t, size_t> lattice_batch(const IN &in, const OUT &out) {
+  size_t nouter = 1, inner = 1;
+  for (size_t i=0; i<in.shape().size(); ++i) {
+    if (i == N) continue;
+    if (in.shape()[i] != out.shape()[i])
+      throw std::invalid_argument("Lattice Fourier transform between Green's functions with different index meshes");
+    (i < N ? nouter : inner) *= in.shape()[i];
+  }
+  return std::make_pair(nouter, inner);
+}
+
+/// Identities of the interned points of a pair of meshes
+typedef std::pair<std::weak_ptr<const void>, std::weak_ptr<const void> > lattice_fourier_key;
+
+/// Order of the keys by identity of the points
+struct lattice_fourier_key_less {
+  bool operator()(const lattice_fourier_key &a, const lattice_fourier_key &b) const {
+    std::owner_less<std::weak_ptr<const void> > less;
+    if (less(a.first, b.first)) return true;
+    if (less(b.first, a.first)) return false;
+    return less(a.second, b.second);
+  }
+};
+
+}
+
+/**
+ * Plan of the lattice Fourier transform between the given meshes, computed once per pair of meshes.
+ *
+ * The plans are cached by identity of the (interned) points of the meshes, so a lookup does not copy or
+ * compare the points; the least recently used plans are dropped from the cache. Callers transforming
+ * many Green's functions on the same meshes can keep the returned plan.
+ */
+inline std::shared_ptr<const detail::lattice_fourier_plan> lattice_fourier_plan(const momentum_index_mesh &kmesh,
+                                                                                 const real_space_index_mesh &rmesh) {
+  static detail::transform_cache<detail::lattice_fourier_key, detail::lattice_fourier_plan,
+                                 detail::lattice_fourier_key_less> cache;
+  if (kmesh.dimension() != rmesh.dimension())
+    throw std::invalid_argument("Lattice Fourier transform between meshes of different spatial dimension");
+  if (kmesh.extent() == 0 || rmesh.extent() == 0)
+    throw std::invalid_argument("Lattice Fourier transform of an empty mesh");
+  // points modified in place are interned again, so that equal points have the same identity
+  const detail::shared_mesh_data<momentum_index_mesh::container_type> kdata = kmesh.shared_points().interned();
+  const detail::shared_mesh_data<real_space_index_mesh::container_type> rdata = rmesh.shared_points().interned();
+  const momentum_index_mesh::container_type &kpts = kdata.get();
+  const real_space_index_mesh::container_type &rpts = rdata.get();
+  detail::lattice_fourier_key key(kdata.identity(), rdata.identity());
+  return cache.get(key, [&]() {
+    detail::lattice_fourier_plan *plan = new detail::lattice_fourier_plan;
+    if (!detail::make_lattice_grid(kpts, rpts, *plan)) {
+      plan->phase.resize(kmesh.extent(), rmesh.extent());
+      for (int q=0; q<kmesh.extent(); ++q) {
+        for (int p=0; p<rmesh.extent(); ++p) {
+          double kr = 0;
+          for (int i=0; i<kmesh.dimension(); ++i) kr += kpts[q][i]*rpts[p][i];
+          plan->phase(q, p) = std::polar(1., -kr);
+        }
+      }
+    }
+    return plan;
+  });
+}
+
+///Transform a real space gf to momentum space: G(k) = \sum_R e^{-ik.R} G(R); the other indices have to agree
+template<class VR, class SR, class SK, class ...RMESHES, class ...KMESHES>
+void real_space_to_momentum(const detail::gf_base<VR, SR, RMESHES...> &g_r,
+                            detail::gf_base<std::complex<double>, SK, KMESHES...> &g_k) {
+  static const size_t N = detail::mesh_position<real_space_index_mesh, RMESHES...>::value;
+  static_assert(sizeof...(RMESHES) == sizeof...(KMESHES), "Green's functions should have the same number of meshes");
+  static_assert(std::is_same<typename std::tuple_element<N, std::tuple<KMESHES...> >::type, momentum_index_mesh>::value,
+                "the momentum mesh should be at the position of the real space mesh");
+  std::pair<size_t, size_t> batch = detail::lattice_batch<N>(g_r.data(), g_k.data());
+  std::shared_ptr<const detail::lattice_fourier_plan> plan =
+      lattice_fourier_plan(std::get<N>(g_k.meshes()), std::get<N>(g_r.meshes()));
+  detail::apply_lattice_forward(*plan, g_r.data().data(), g_k.data().data(), batch.first, batch.second);
+}
+
+///Transform a momentum space gf to real space: G(R) = 1/N_k \sum_k e^{ik.R} G(k); the other indices have to agree
+template<class VK, class SK, class SR, class ...KMESHES, class ...RMESHES>
+void momentum_to_real_space(const detail::gf_base<VK, SK, KMESHES...> &g_k,
+                            detail::gf_base<std::complex<double>, SR, RMESHES...> &g_r) {
+  static const size_t N = detail::mesh_position<momentum_index_mesh, KMESHES...>::value;
+  static_assert(sizeof...(RMESHES) == sizeof...(KMESHES), "Green's functions should have the same number of meshes");
+  static_assert(std::is_same<typename std::tuple_element<N, std::tuple<RMESHES...> >::type, real_space_index_mesh>::value,
+                "the real space mesh should be at the position of the momentum mesh");
+  std::pair<size_t, size_t> batch = detail::lattice_batch<N>(g_k.data(), g_r.data());
+  std::shared_ptr<const detail::lattice_fourier_plan> plan =
+      lattice_fourier_plan(std::get<N>(g_k.meshes()), std::get<N>(g_r.meshes()));
+  detail::apply_lattice_backward(*plan, g_k.data().data(), g_r.data().data(), batch.first, batch.second);
+}
+
+}
+} // end alps::
@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include <boost/math/special_functions/bessel.hpp>
+#include <Eigen/Dense>
+
+#include <alps/gf/gf.hpp>
+#include <alps/gf/transform_cache.hpp>
+
+/**
+ * Transforms between the Legendre representation and imaginary time / Matsubara frequencies.
+ *
+ * The Legendre coefficients are normalized as in Boehnke et al., PRB 84, 075145 (2011):
+ *   G_l = sqrt(2l+1) \int_0^\beta d\tau P_l(x(\tau)) G(\tau),  x(\tau) = 2\tau/\beta - 1,
+ *   G(\tau) = \sum_l sqrt(2l+1)/\beta P_l(x(\tau)) G_l,
+ *   G(i\omega_n) = \sum_l T_{nl} G_l,  T_{nl} = sqrt(2l+1) e^{i\omega_n\beta/2} i^l j_l(\omega_n\beta/2).
+ * The transformation matrices only depend on the meshes; they are computed once per set of mesh
+ * parameters, cached, and applied to all trailing indices of a Green's function as a matrix product.
+ */
+namespace alps {
+namespace gf {
+
+namespace detail {
+
+typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> row_matrix;
+typedef Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic> matrix_stride;
+
+/// Real and imaginary parts of a transformation matrix
+struct split_matrix {
+  Eigen::MatrixXd re;
+  Eigen::MatrixXd im;
+};
+
+/// Real part of a rows x cols row-major array
+inline Eigen::Map<const row_matrix, 0, matrix_stride> real_part(const double *data, size_t rows, size_t cols) {
+  return Eigen::Map<const row_matrix, 0, matrix_stride>(data, rows, cols, matrix_stride(cols, 1));
+}
+inline Eigen::Map<const row_matrix, 0, matrix_stride> real_part(const std::complex<double> *data, size_t rows, size_t cols) {
+  return Eigen::Map<const row_matrix, 0, matrix_stride>(reinterpret_cast<const double *>(data), rows, cols, matrix_stride(2*cols, 2));
+}
+inline Eigen::Map<row_matrix, 0, matrix_stride> real_part(double *data, size_t rows, size_t cols) {
+  return Eigen::Map<row_matrix, 0, matrix_stride>(data, rows, cols, matrix_stride(cols, 1));
+}
+inline Eigen::Map<row_matrix, 0, matrix_stride> real_part(std::complex<double> *data, size_t rows, size_t cols) {
+  return Eigen::Map<row_matrix, 0, matrix_stride>(reinterpret_cast<double *>(data), rows, cols, matrix_stride(2*cols, 2));
+}
+/// Imaginary part of a rows x cols row-major complex array
+inline Eigen::Map<const row_matrix, 0, matrix_stride> imag_part(const std::complex<double> *data, size_t rows, size_t cols) {
+  return Eigen::Map<const row_matrix, 0, matrix_stride>(reinterpret_cast<const double *>(data) + 1, rows, cols, matrix_stride(2*cols, 2));
+}
+inline Eigen::Map<row_matrix, 0, matrix_stride> imag_part(std::complex<double> *data, size_t rows, size_t cols) {
+  return Eigen::Map<row_matrix, 0, matrix_stride>(reinterpret_cast<double *>(data) + 1, rows, cols, matrix_stride(2*cols, 2));
+}
+
+/// out = T*in for a complex matrix T and real coefficients
+inline void apply_split_matrix(const split_matrix &t, const double *in, std::complex<double> *out, size_t nother) {
+  size_t nrows = t.re.rows(), ncols = t.re.cols();
+  real_part(out, nrows, nother).noalias() = t.re*real_part(in, ncols, nother);
+  imag_part(out, nrows, nother).noalias() = t.im*real_part(in, ncols, nother);
+}
+/// out = T*in for a complex matrix T and complex coefficients
+inline void apply_split_matrix(const split_matrix &t, const std::complex<double> *in, std::complex<double> *out, size_t nother) {
+  size_t nrows = t.re.rows(), ncols = t.re.cols();
+  real_part(out, nrows, nother).noalias() = t.re*real_part(in, ncols, nother);
+  real_part(out, nrows, nother).noalias() -= t.im*imag_part(in, ncols, nother);
+  imag_part(out, nrows, nother).noalias() = t.im*real_part(in, ncols, nother);
+  imag_part(out, nrows, nother).noalias() += t.re*imag_part(in, ncols, nother);
+}
+
+/// out = U*in for a real matrix U
+inline void apply_real_matrix(const Eigen::MatrixXd &u, const double *in, double *out, size_t nother) {
+  real_part(out, u.rows(), nother).noalias() = u*real_part(in, u.cols(), nother);
+}
+inline void apply_real_matrix(const Eigen::MatrixXd &u, const double *in, std::complex<double> *out, size_t nother) {
+  real_part(out, u.rows(), nother).noalias() = u*real_part(in, u.cols(), nother);
+  imag_part(out, u.rows(), nother).setZero();
+}
+inline void apply_real_matrix(const Eigen::MatrixXd &u, const std::complex<double> *in, std::complex<double> *out, size_t nother) {
+  real_part(out, u.rows(), nother).noalias() = u*real_part(in, u.cols(), nother);
+  imag_part(out, u.rows(), nother).noalias() = u*imag_part(in, u.cols(), nother);
+}
+
+/// Spherical Bessel function j_l(x) for real x of either sign
+inline double sph_bessel(int l, double x) {
+  double j = boost::math::sph_bessel(l, std::abs(x));
+  return (x < 0 && l%2 == 1) ? -j : j;
+}
+
+/// Checks that the Legendre mesh and the other mesh describe the same temperature and statistics
+template<typename MESH> void check_legendre_compatible(const legendre_mesh &lmesh, const MESH &mesh) {
+  if (std::abs(lmesh.beta() - mesh.beta()) > 1e-12*lmesh.beta())
+    throw std::invalid_argument("Legendre transform between meshes with different inverse temperatures");
+  if (lmesh.statistics() != mesh.statistics())
+    throw std::invalid_argument("Legendre transform between meshes with different statistics");
+}
+
+}
+
+/// Legendre -> Matsubara matrix T_{nl} for the frequencies of `mmesh`, computed once per set of mesh parameters
+template<mesh::frequency_positivity_type PTYPE>
+std::shared_ptr<const detail::split_matrix> legendre_matsubara_matrix(const legendre_mesh &lmesh, const matsubara_mesh<PTYPE> &mmesh) {
+  typedef std::tuple<double, int, int, int, int> key_type;
+  static detail::transform_cache<key_type, detail::split_matrix> cache;
+  detail::check_legendre_compatible(lmesh, mmesh);
+  double beta = lmesh.beta();
+  int nl = lmesh.extent();
+  const std::vector<double> &omega = mmesh.points();
+  return cache.get(key_type(beta, nl, int(mmesh.statistics()), int(PTYPE), mmesh.extent()), [&]() {
+    detail::split_matrix *t = new detail::split_matrix;
+    t->re.resize(omega.size(), nl);
+    t->im.resize(omega.size(), nl);
+    for (size_t n=0; n<omega.size(); ++n) {
+      double x = omega[n]*beta/2;
+      for (int l=0; l<nl; ++l) {
+        // e^{ix} i^l
+        std::complex<double> phase = std::polar(1., x + M_PI/2*l);
+        std::complex<double> value = std::sqrt(2.*l + 1)*detail::sph_bessel(l, x)*phase;
+        t->re(n, l) = value.real();
+        t->im(n, l) = value.imag();
+      }
+    }
+    return t;
+  });
+}
+
+/// Legendre -> imaginary time matrix sqrt(2l+1)/beta P_l(x(tau)) for the points of `tmesh`, computed once per set of mesh parameters
+inline std::shared_ptr<const Eigen::MatrixXd> legendre_itime_matrix(const legendre_mesh &lmesh, const itime_mesh &tmesh) {
+  typedef std::tuple<double, int, int, double> key_type;
+  static detail::transform_cache<key_type, Eigen::MatrixXd> cache;
+  detail::check_legendre_compatible(lmesh, tmesh);
+  double beta = lmesh.beta();
+  int nl = lmesh.extent();
+  const std::vector<double> &tau = tmesh.points();
+  return cache.get(key_type(beta, nl, tmesh.extent(), tau.back()), [&]() {
+    Eigen::MatrixXd *u = new Eigen::MatrixXd(tau.size(), nl);
+    for (size_t t=0; t<tau.size(); ++t) {
+      double x = 2*tau[t]/beta - 1;
+      double p0 = 1, p1 = x;
+      for (int l=0; l<nl; ++l) {
+        double p = l == 0 ? p0 : p1;
+        if (l > 1) {
+          p = ((2.*l - 1)*x*p1 - (l - 1.)*p0)/l;
+          p0 = p1;
+          p1 = p;
+        }
+        (*u)(t, l) = std::sqrt(2.*l + 1)/beta*p;
+      }
+    }
+    return u;
+  });
+}
+
+/**
+ * Adds imaginary time samples to Legendre coefficients: G_l += w sqrt(2l+1) P_l(2\tau/\beta-1).
+ *
+ * This is the measurement kernel of a Legendre estimator. The recurrence coefficients are tabulated, and the
+ * batched version advances the recurrence for a block of samples at once, so the inner loops run over
+ * independent samples and vectorize.
+ */
+class legendre_accumulator {
+  public:
+    /// Number of samples processed together by the batched `add`
+    static const int block_size = 8;
+
+    legendre_accumulator(double beta, int nl) : beta_(beta), a_(nl), b_(nl), norm_(nl) {
+      if (beta <= 0 || nl < 1) throw std::invalid_argument("legendre_accumulator requires beta>0 and at least one coefficient");
+      for (int l=0; l<nl; ++l) {
+        a_[l] = l < 2 ? 1. : (2.*l - 1)/l;
+        b_[l] = l < 2 ? 0. : (l - 1.)/l;
+        norm_[l] = std::sqrt(2.*l + 1);
+      }
+    }
+    explicit legendre_accumulator(const legendre_mesh &mesh) : legendre_accumulator(mesh.beta(), mesh.extent()) {}
+
+    /// number of Legendre coefficients
+    int size() const { return int(norm_.size()); }
+
+    /// Adds the sample `weight` at `tau` to the `size()` coefficients starting at `coeffs`
+    void add(double tau, double weight, double *coeffs) const {
+      double x = 2*tau/beta_ - 1;
+      double p0 = 1, p1 = x;
+      coeffs[0] += norm_[0]*weight;
+      if (norm_.size() > 1) coeffs[1] += norm_[1]*weight*x;
+      for (size_t l=2; l<norm_.size(); ++l) {
+        double p = a_[l]*x*p1 - b_[l]*p0;
+        p0 = p1;
+        p1 = p;
+        coeffs[l] += norm_[l]*weight*p;
+      }
+    }
+
+    /// Adds `nsamples` samples with weights `weight[i]` at `tau[i]` to the coefficients starting at `coeffs`
+    void add(const double *tau, const double *weight, size_t nsamples, double *coeffs) const {
+      for (size_t start=0; start<nsamples; start+=block_size) {
+        size_t nblock = std::min(size_t(block_size), nsamples - start);
+        double x[block_size], w[block_size], p0[block_size], p1[block_size];
+        for (int k=0; k<block_size; ++k) {
+          bool valid = size_t(k) < nblock;
+          x[k] = valid ? 2*tau[start + k]/beta_ - 1 : 0.;
+          w[k] = valid ? weight[start + k] : 0.;
+          p0[k] = 1;
+          p1[k] = x[k];
+        }
+        double sum0 = 0, sum1 = 0;
+        for (int k=0; k<block_size; ++k) {
+          sum0 += w[k];
+          sum1 += w[k]*x[k];
+        }
+        coeffs[0] += norm_[0]*sum0;
+        if (norm_.size() > 1) coeffs[1] += norm_[1]*sum1;
+        for (size_t l=2; l<norm_.size(); ++l) {
+          double sum = 0;
+          for (int k=0; k<block_size; ++k) {
+            double p = a_[l]*x[k]*p1[k] - b_[l]*p0[k];
+            p0[k] = p1[k];
+            p1[k] = p;
+            sum += w[k]*p;
+          }
+          coeffs[l] += norm_[l]*sum;
+        }
+      }
+    }
+
+  private:
+    double beta_;
+    std::vector<double> a_;
+    std::vector<double> b_;
+    std::vector<double> norm_;
+};
+
+///Transform a Legendre gf to Matsubara frequencies; all indices but the first are transformed at once
+template<class VL, class SL, class SW, mesh::frequency_positivity_type PTYPE, class ...MESHES>
+void legendre_to_matsubara(const detail::gf_base<VL, SL, legendre_mesh, MESHES...> &g_l,
+                           detail::gf_base<std::complex<double>, SW, matsubara_mesh<PTYPE>, MESHES...> &g_omega) {
+  size_t nother = g_l.data().size()/g_l.mesh1().extent();
+  if (g_omega.data().size() != g_omega.mesh1().extent()*nother)
+    throw std::invalid_argument("Legendre transform between Green's functions with different index meshes");
+  std::shared_ptr<const detail::split_matrix> t = legendre_matsubara_matrix(g_l.mesh1(), g_omega.mesh1());
+  detail::apply_split_matrix(*t, g_l.data().data(), g_omega.data().data(), nother);
+}
+
+///Transform a Legendre gf to imaginary time; all indices but the first are transformed at once
+template<class VL, class SL, class VT, class ST, class ...MESHES>
+void legendre_to_itime(const detail::gf_base<VL, SL, legendre_mesh, MESHES...> &g_l,
+                       detail::gf_base<VT, ST, itime_mesh, MESHES...> &g_tau) {
+  static_assert(!std::is_same<VT, double>::value || std::is_same<VL, double>::value,
+                "complex Legendre coefficients need a complex imaginary time gf");
+  size_t nother = g_l.data().size()/g_l.mesh1().extent();
+  if (g_tau.data().size() != g_tau.mesh1().extent()*nother)
+    throw std::invalid_argument("Legendre transform between Green's functions with different index meshes");
+  std::shared_ptr<const Eigen::MatrixXd> u = legendre_itime_matrix(g_l.mesh1(), g_tau.mesh1());
+  detail::apply_real_matrix(*u, g_l.data().data(), g_tau.data().data(), nother);
+}
+
+}
+} // end alps::
@@ -23,6 +23,7 @@
 
 #include"flagcheck.hpp"
 #include"piecewise_polynomial.hpp"
+#include"shared_mesh_data.hpp"
 
 namespace alps {
     namespace gf {
@@ -74,21 +75,27 @@ namespace alps {
             };
         }
         /// Common part of interface and implementation for GF meshes
+        /// The points are shared between copies of a mesh and between meshes with equal points.
         class base_mesh {
         public:
             base_mesh() {}
             base_mesh(const base_mesh& rhs) : points_(rhs.points_) {}
             /// Const access to mesh points
-            const std::vector<double> &points() const{return points_;}
+            const std::vector<double> &points() const{return points_.get();}
         protected:
             // we do not want external functions be able to change a grid.
-            std::vector<double> &_points() {return points_;}
+            std::vector<double> &_points() {return points_.modify();}
+            /// Replace the points; meshes with equal points share them
+            void set_points(std::vector<double> points) {
+                points_ = detail::shared_mesh_data<std::vector<double> >(std::move(points));
+            }
+            /// Compare the points, usually by pointer
+            bool same_points(const base_mesh &other) const {return points_ == other.points_;}
             void swap(base_mesh &other) {
-                using std::swap;
-                swap(this->points_, other.points_);
+                points_.swap(other.points_);
             }
         private:
-            std::vector<double> points_;
+            detail::shared_mesh_data<std::vector<double> > points_;
         };
 
         /// Mesh of real frequencies
@@ -105,7 +112,9 @@ namespace alps {
 
             template<typename GRID>
             explicit real_frequency_mesh(const GRID & grid)  {
-                grid.compute_points(_points());
+                std::vector<double> points;
+                grid.compute_points(points);
+                set_points(points);
             }
             int extent() const {return points().size();}
 
@@ -127,7 +136,9 @@ namespace alps {
                 std::string kind;
                 ar[path+"/kind"]   >> kind;
                 if (kind!="REAL_FREQUENCY") throw std::runtime_error("Attempt to read real frequency mesh from non-real frequency data, kind="+kind);
-                ar[path+"/points"] >> _points();
+                std::vector<double> points;
+                ar[path+"/points"] >> points;
+                set_points(points);
             }
 
             /// Save to HDF5
@@ -145,7 +156,7 @@ namespace alps {
             /// Comparison operators
             bool operator==(const real_frequency_mesh &mesh) const {
                 throw_if_empty();
-                return extent()==mesh.extent() && std::equal ( mesh.points().begin(), mesh.points().end(), points().begin() );;
+                return extent()==mesh.extent() && same_points(mesh);
             }
 
             /// Comparison operators
@@ -156,16 +167,23 @@ namespace alps {
 #ifdef ALPS_HAVE_MPI
             void broadcast(const alps::mpi::communicator& comm, int root)
             {
-                using alps::mpi::broadcast;
                 if(comm.rank() == root) throw_if_empty();
-                int size = extent();
-                broadcast(comm, size, root);
-                /// since real frequency mesh can be generated differently we should broadcast points
-                if(root!=comm.rank()) {
-                    /// adjust target array size
-                    _points().resize(size);
-                }
-                broadcast(comm, _points().data(), extent(), root);
+                alps::mpi::broadcast_packed(comm, *this, root);
+            }
+
+            /// Pack for an MPI transfer
+            void pack(alps::mpi::packer& p) const
+            {
+                /// since real frequency mesh can be generated differently we should send points
+                p << points();
+            }
+
+            /// Unpack
+            void unpack(alps::mpi::unpacker& u)
+            {
+                std::vector<double> mesh_points;
+                u >> mesh_points;
+                set_points(mesh_points);
             }
 #endif
         };
@@ -191,7 +209,7 @@ namespace alps {
             public:
             typedef generic_index<matsubara_mesh> index_type;
             /// copy constructor
-            matsubara_mesh(const matsubara_mesh& rhs) : beta_(rhs.beta_), nfreq_(rhs.nfreq_), statistics_(rhs.statistics_), offset_(rhs.offset_) {check_range();compute_points();}
+            matsubara_mesh(const matsubara_mesh& rhs) : base_mesh(rhs), beta_(rhs.beta_), nfreq_(rhs.nfreq_), statistics_(rhs.statistics_), offset_(rhs.offset_) {check_range();}
             matsubara_mesh():
                 beta_(0.0), nfreq_(0), statistics_(statistics::FERMIONIC), offset_(-1)
             {
@@ -291,16 +309,23 @@ namespace alps {
 #ifdef ALPS_HAVE_MPI
           void broadcast(const alps::mpi::communicator& comm, int root)
             {
-                using alps::mpi::broadcast;
                 if(comm.rank() == root) throw_if_empty();
+                alps::mpi::broadcast_packed(comm, *this, root);
+            }
+
+            /// Pack for an MPI transfer
+            void pack(alps::mpi::packer& p) const
+            {
+                p << beta_ << nfreq_ << int(statistics_) << int(positivity_);
+            }
+
+            /// Unpack
+            void unpack(alps::mpi::unpacker& u)
+            {
                 // FIXME: introduce (debug-only?) consistency check, like type checking? akin to load()?
-                broadcast(comm, beta_, root);
-                broadcast(comm, nfreq_, root);
-                int stat = int(statistics_);
-                broadcast(comm, stat, root);
+                int stat = 0, pos = 0;
+                u >> beta_ >> nfreq_ >> stat >> pos;
                 statistics_ = statistics::statistics_type(stat);
-                int pos = int(positivity_);
-                broadcast(comm, pos, root);
                 if (mesh::frequency_positivity_type(pos)!=positivity_) {
                   throw std::invalid_argument("Attempt to broadcast Matsubara mesh with the wrong positivity type "+std::to_string(pos) ); // FIXME: specific exception? Verbose positivity?
                 };
@@ -311,7 +336,7 @@ namespace alps {
                 } catch (const std::exception& exc) {
                     int wrank=alps::mpi::communicator().rank();
                     // FIXME? Try to communiucate the error with all ranks, at least in debug mode?
-                    std::cerr << "matsubara_mesh<>::broadcast() exception at WORLD rank=" << wrank << std::endl
+                    std::cerr << "matsubara_mesh<>::unpack() exception at WORLD rank=" << wrank << std::endl
                               << exc.what()
                               << "\nAborting." << std::endl;
                     MPI_Abort(MPI_COMM_WORLD,1);
@@ -330,10 +355,11 @@ namespace alps {
             }
             void compute_points(){
                 throw_if_empty();
-                _points().resize(extent());
+                std::vector<double> points(extent());
                 for(int i=0;i<nfreq_;++i){
-                    _points()[i]=(2*(i-offset_)+statistics_)*M_PI/beta_;
+                    points[i]=(2*(i-offset_)+statistics_)*M_PI/beta_;
                 }
+                set_points(points);
             }
         };
         ///Stream output operator, e.g. for printing to file
@@ -357,7 +383,7 @@ namespace alps {
             bool last_point_included_;
             bool half_point_mesh_;
             statistics::statistics_type statistics_;
-            std::vector<double> points_;
+            detail::shared_mesh_data<std::vector<double> > points_;
 
             inline void throw_if_empty() const {
                 if (extent() == 0) {
@@ -373,9 +399,8 @@ namespace alps {
             }
 
             itime_mesh(const itime_mesh&rhs): beta_(rhs.beta_), ntau_(rhs.ntau_),
-                                              last_point_included_(rhs.last_point_included_), half_point_mesh_(rhs.half_point_mesh_), statistics_(rhs.statistics_){
-              compute_points();
-
+                                              last_point_included_(rhs.last_point_included_), half_point_mesh_(rhs.half_point_mesh_), statistics_(rhs.statistics_),
+                                              points_(rhs.points_){
             }
 
             itime_mesh(double beta, int ntau): beta_(beta), ntau_(ntau), last_point_included_(true), half_point_mesh_(false), statistics_(statistics::FERMIONIC){
@@ -400,7 +425,7 @@ namespace alps {
             ///Getter variables for members
             double beta() const{ return beta_;}
             statistics::statistics_type statistics() const{ return statistics_;}
-            const std::vector<double> &points() const{return points_;}
+            const std::vector<double> &points() const{return points_.get();}
 
             /// Comparison operators
             bool operator!=(const itime_mesh &mesh) const {
@@ -417,7 +442,7 @@ namespace alps {
                 ar[path+"/beta"] << beta_;
                 ar[path+"/half_point_mesh"] << int(half_point_mesh_);
                 ar[path+"/last_point_included"] << int(last_point_included_);
-                ar[path+"/points"] << points_;
+                ar[path+"/points"] << points();
             }
 
             void load(alps::hdf5::archive& ar, const std::string& path)
@@ -457,34 +482,42 @@ namespace alps {
 #ifdef ALPS_HAVE_MPI
           void broadcast(const alps::mpi::communicator& comm, int root)
             {
-                using alps::mpi::broadcast;
                 if(comm.rank() == root) throw_if_empty();
+                alps::mpi::broadcast_packed(comm, *this, root);
+            }
+
+            /// Pack for an MPI transfer
+            void pack(alps::mpi::packer& p) const
+            {
+                p << beta_ << ntau_ << last_point_included_ << half_point_mesh_ << int(statistics_);
+            }
+
+            /// Unpack
+            void unpack(alps::mpi::unpacker& u)
+            {
                 // FIXME: introduce (debug-only?) consistency check, like type checking? akin to load()?
-                broadcast(comm, beta_, root);
-                broadcast(comm, ntau_, root);
-                broadcast(comm, last_point_included_, root);
-                broadcast(comm, half_point_mesh_, root);
-                int stat=statistics_;
-                broadcast(comm, stat, root);
+                int stat=0;
+                u >> beta_ >> ntau_ >> last_point_included_ >> half_point_mesh_ >> stat;
                 statistics_=static_cast<statistics::statistics_type>(stat);
                 compute_points(); // recompute points rather than sending them over MPI
             }
 #endif
 
             void compute_points(){
-                points_.resize(extent());
+                std::vector<double> points(extent());
                 if(half_point_mesh_){
                   double dtau=beta_/ntau_;
                   for(int i=0;i<ntau_;++i){
-                      points_[i]=(i+0.5)*dtau;
+                      points[i]=(i+0.5)*dtau;
                   }
                 }
                 for(int i=0;i<ntau_;++i){
                   double dtau=last_point_included_?beta_/(ntau_-1):beta_/ntau_;
                   for(int i=0;i<ntau_;++i){
-                      points_[i]=i*dtau;
+                      points[i]=i*dtau;
                   }
                 }
+                points_=detail::shared_mesh_data<std::vector<double> >(points);
             }
 
         };
@@ -498,8 +531,8 @@ namespace alps {
             int uniform_;
 
             statistics::statistics_type statistics_;
-            std::vector<double> points_;
-            std::vector<double> weights_;
+            detail::shared_mesh_data<std::vector<double> > points_;
+            detail::shared_mesh_data<std::vector<double> > weights_;
 
             inline void throw_if_empty() const {
                 if (extent() == 0) {
@@ -510,9 +543,8 @@ namespace alps {
             public:
             typedef generic_index<power_mesh> index_type;
 
-            power_mesh(const power_mesh& rhs): beta_(rhs.beta_), power_(rhs.power_), uniform_(rhs.uniform_), statistics_(rhs.statistics_){
-              compute_points();
-              compute_weights();
+            power_mesh(const power_mesh& rhs): beta_(rhs.beta_), ntau_(rhs.ntau_), power_(rhs.power_), uniform_(rhs.uniform_), statistics_(rhs.statistics_),
+                                               points_(rhs.points_), weights_(rhs.weights_){
             }
 
             power_mesh(): beta_(0.0), ntau_(0), power_(0), uniform_(0), statistics_(statistics::FERMIONIC){
@@ -542,8 +574,8 @@ namespace alps {
             ///Getter variables for members
             double beta() const{ return beta_;}
             statistics::statistics_type statistics() const{ return statistics_;}
-            const std::vector<double> &points() const{return points_;}
-            const std::vector<double> &weights() const{return weights_;}
+            const std::vector<double> &points() const{return points_.get();}
+            const std::vector<double> &weights() const{return weights_.get();}
 
             /// Comparison operators
             bool operator!=(const power_mesh &mesh) const {
@@ -560,7 +592,7 @@ namespace alps {
                 ar[path+"/beta"] << beta_;
                 ar[path+"/power"] << power_;
                 ar[path+"/uniform"] << uniform_;
-                ar[path+"/points"] << points_;
+                ar[path+"/points"] << points();
             }
 
             void load(alps::hdf5::archive& ar, const std::string& path)
@@ -601,15 +633,22 @@ namespace alps {
 #ifdef ALPS_HAVE_MPI
           void broadcast(const alps::mpi::communicator& comm, int root)
             {
-                using alps::mpi::broadcast;
                 if(comm.rank() == root) throw_if_empty();
+                alps::mpi::broadcast_packed(comm, *this, root);
+            }
+
+            /// Pack for an MPI transfer
+            void pack(alps::mpi::packer& p) const
+            {
+                p << beta_ << ntau_ << power_ << uniform_ << int(statistics_);
+            }
+
+            /// Unpack
+            void unpack(alps::mpi::unpacker& u)
+            {
                 // FIXME: introduce (debug-only?) consistency check, like type checking? akin to load()?
-                broadcast(comm, beta_, root);
-                broadcast(comm, ntau_, root);
-                broadcast(comm, power_, root);
-                broadcast(comm, uniform_, root);
-                int stat=statistics_;
-                broadcast(comm, stat, root);
+                int stat=0;
+                u >> beta_ >> ntau_ >> power_ >> uniform_ >> stat;
                 statistics_=static_cast<statistics::statistics_type>(stat);
                 compute_points(); // recompute points rather than sending them over MPI
                 compute_weights();
@@ -631,25 +670,28 @@ namespace alps {
               std::sort(power_points.begin(),power_points.end());
 
               //create the uniform grid within each power grid
-             points_.resize(0);
+              std::vector<double> points;
               for(std::size_t i=0;i<power_points.size()-1;++i){
                 for(int j=0;j<uniform_;++j){
                   double dtau=(power_points[i+1]-power_points[i])/(double)(uniform_);
-                  points_.push_back(power_points[i]+dtau*j);
+                  points.push_back(power_points[i]+dtau*j);
                 }
               }
-              points_.push_back(power_points.back());
-              ntau_=points_.size();
+              points.push_back(power_points.back());
+              ntau_=points.size();
+              points_=detail::shared_mesh_data<std::vector<double> >(points);
             }
 
             void compute_weights(){
-              weights_.resize(extent());
-              weights_[0        ]=(points_[1]    -points_[0        ])/(2.*beta_);
-              weights_[extent()-1]=(points_.back()-points_[extent()-2])/(2.*beta_);
+              const std::vector<double> &points=points_.get();
+              std::vector<double> weights(extent());
+              weights[0        ]=(points[1]    -points[0        ])/(2.*beta_);
+              weights[extent()-1]=(points.back()-points[extent()-2])/(2.*beta_);
 
               for(int i=1;i<extent()-1;++i){
-                weights_[i]=(points_[i+1]-points_[i-1])/(2.*beta_);
+                weights[i]=(points[i+1]-points[i-1])/(2.*beta_);
               }
+              weights_=detail::shared_mesh_data<std::vector<double> >(weights);
             }
         };
         ///Stream output operator, e.g. for printing to file
@@ -659,18 +701,16 @@ namespace alps {
         class momentum_realspace_index_mesh {
             public:
             typedef boost::multi_array<double,2> container_type;
-            momentum_realspace_index_mesh(const momentum_realspace_index_mesh& rhs) : points_(boost::extents[rhs.points_.shape()[0]][rhs.points_.shape()[1]]),
-                                                                                      kind_(rhs.kind_){
-              points_ = rhs.points_;
+            momentum_realspace_index_mesh(const momentum_realspace_index_mesh& rhs) : points_(rhs.points_), kind_(rhs.kind_){
             }
             momentum_realspace_index_mesh& operator=(const momentum_realspace_index_mesh& rhs) {
-              points_.resize(boost::extents[rhs.points_.shape()[0]][rhs.points_.shape()[1]]);
               points_ = rhs.points_;
               kind_   = rhs.kind_;
               return *this;
             }
             protected:
-            container_type points_;
+            /// the points are shared between copies and between meshes constructed with equal points
+            detail::shared_mesh_data<container_type> points_;
             private:
             std::string kind_;
 
@@ -681,11 +721,11 @@ namespace alps {
             }
 
             protected:
-            momentum_realspace_index_mesh(): points_(boost::extents[0][0]), kind_("")
+            momentum_realspace_index_mesh(): points_(container_type(boost::extents[0][0])), kind_("")
             {
             }
 
-            momentum_realspace_index_mesh(const std::string& kind, int ns,int ndim): points_(boost::extents[ns][ndim]), kind_(kind)
+            momentum_realspace_index_mesh(const std::string& kind, int ns,int ndim): points_(container_type(boost::extents[ns][ndim])), kind_(kind)
             {
             }
 
@@ -695,9 +735,9 @@ namespace alps {
 
             public:
             /// Returns the number of points
-            int extent() const { return points_.shape()[0];}
+            int extent() const { return points_.get().shape()[0];}
             ///returns the spatial dimension
-            int dimension() const { return points_.shape()[1];}
+            int dimension() const { return points_.get().shape()[1];}
             ///returns the mesh kind
             const std::string &kind() const{return kind_;}
 
@@ -714,14 +754,17 @@ namespace alps {
                 return !(*this==mesh);
             }
 
-            const container_type &points() const{return points_;}
-            container_type &points() {return points_;}
+            const container_type &points() const{return points_.get();}
+            /// The points, as shared between meshes
+            const detail::shared_mesh_data<container_type> &shared_points() const{return points_;}
+            /// Write access to the points; unshares them (copy-on-write)
+            container_type &points() {return points_.modify();}
 
             void save(alps::hdf5::archive& ar, const std::string& path) const
             {
                 throw_if_empty();
                 ar[path+"/kind"] << kind_;
-                ar[path+"/points"] << points_;
+                ar[path+"/points"] << points_.get();
             }
 
             void load(alps::hdf5::archive& ar, const std::string& path)
@@ -729,7 +772,9 @@ namespace alps {
                 std::string kind;
                 ar[path+"/kind"] >> kind;
                 if (kind!=kind_) throw std::runtime_error("Attempt to load momentum/realspace index mesh from incorrect mesh kind="+kind+ " (expected: "+kind_+")");
-                ar[path+"/points"] >> points_;
+                container_type points;
+                ar[path+"/points"] >> points;
+                points_ = detail::shared_mesh_data<container_type>(points);
             }
 
             /// Save to HDF5
@@ -747,16 +792,31 @@ namespace alps {
 #ifdef ALPS_HAVE_MPI
           void broadcast(const alps::mpi::communicator& comm, int root)
             {
-                using alps::mpi::broadcast;
                 if (comm.rank()==root) {
                   throw_if_empty();
                 }
+                alps::mpi::broadcast_packed(comm, *this, root);
+            }
+
+            /// Pack for an MPI transfer
+            void pack(alps::mpi::packer& p) const
+            {
+                const container_type& points = points_.get();
+                p << points.shape()[0] << points.shape()[1];
+                p.write(points.data(), points.num_elements());
+                p << kind_;
+            }
+
+            /// Unpack
+            void unpack(alps::mpi::unpacker& u)
+            {
                 // FIXME: introduce (debug-only?) consistency check, like type checking? akin to load()?
-                std::array<size_t, 2> sizes{{points_.shape()[0], points_.shape()[1]}};
-                alps::mpi::broadcast(comm, &sizes[0], 2, root);
-                if (comm.rank()!=root) points_.resize(sizes);
-                detail::broadcast(comm, points_, root);
-                broadcast(comm, kind_, root);
+                std::array<size_t, 2> sizes{{0, 0}};
+                u >> sizes[0] >> sizes[1];
+                container_type points(sizes);
+                u.read(points.data(), points.num_elements());
+                points_ = detail::shared_mesh_data<container_type>(points);
+                u >> kind_;
             }
 #endif
 
@@ -886,9 +946,20 @@ namespace alps {
 #ifdef ALPS_HAVE_MPI
           void broadcast(const alps::mpi::communicator& comm, int root)
             {
-                using alps::mpi::broadcast;
                 if(comm.rank() == root) throw_if_empty();
-                broadcast(comm, npoints_, root);
+                alps::mpi::broadcast_packed(comm, *this, root);
+            }
+
+            /// Pack for an MPI transfer
+            void pack(alps::mpi::packer& p) const
+            {
+                p << npoints_;
+            }
+
+            /// Unpack
+            void unpack(alps::mpi::unpacker& u)
+            {
+                u >> npoints_;
                 compute_points();
             }
 #endif
@@ -910,7 +981,7 @@ namespace alps {
 
         public:
             typedef generic_index<legendre_mesh> index_type;
-            legendre_mesh(const legendre_mesh& rhs) : beta_(rhs.beta_), n_max_(rhs.n_max_), statistics_(rhs.statistics_) {compute_points();}
+            legendre_mesh(const legendre_mesh& rhs) : base_mesh(rhs), beta_(rhs.beta_), n_max_(rhs.n_max_), statistics_(rhs.statistics_) {}
             legendre_mesh(gf::statistics::statistics_type statistics=statistics::FERMIONIC):
                     beta_(0.0), n_max_(0), statistics_(statistics) {}
 
@@ -1000,22 +1071,29 @@ namespace alps {
 #ifdef ALPS_HAVE_MPI
             void broadcast(const alps::mpi::communicator& comm, int root)
             {
-                using alps::mpi::broadcast;
                 if(comm.rank() == root) throw_if_empty();
-                broadcast(comm, beta_, root);
-                broadcast(comm, n_max_, root);
-                {
-                    int stat = static_cast<int>(statistics_);
-                    broadcast(comm, stat, root);
-                    statistics_=statistics::statistics_type(stat);
-                }
+                alps::mpi::broadcast_packed(comm, *this, root);
+            }
+
+            /// Pack for an MPI transfer
+            void pack(alps::mpi::packer& p) const
+            {
+                p << beta_ << n_max_ << static_cast<int>(statistics_);
+            }
+
+            /// Unpack
+            void unpack(alps::mpi::unpacker& u)
+            {
+                int stat = 0;
+                u >> beta_ >> n_max_ >> stat;
+                statistics_=statistics::statistics_type(stat);
 
                 try {
                     check_range();
                 } catch (const std::exception& exc) {
                     // FIXME? Try to communiucate the error with all ranks, at least in debug mode?
                     int wrank=alps::mpi::communicator().rank();
-                    std::cerr << "legendre_mesh<>::broadcast() exception at WORLD rank=" << wrank << std::endl
+                    std::cerr << "legendre_mesh<>::unpack() exception at WORLD rank=" << wrank << std::endl
                               << exc.what()
                               << "\nAborting." << std::endl;
                     MPI_Abort(MPI_COMM_WORLD,1);
@@ -1030,10 +1108,11 @@ namespace alps {
             void compute_points(){
                 //This is sort of trivial in the current implementation.
                 //We use P_0, P_1, P_2, ..., P_{n_max_-1}
-                _points().resize(extent());
+                std::vector<double> points(extent());
                 for(int i=0;i<n_max_;++i){
-                    _points()[i]=i;
+                    points[i]=i;
                 }
+                set_points(points);
             }
         };
         ///Stream output operator, e.g. for printing to file
@@ -1049,20 +1128,22 @@ namespace alps {
 
             statistics::statistics_type statistics_;
 
-            std::vector<piecewise_polynomial<T> > basis_functions_;
+            /// shared between copies and between meshes constructed with equal basis functions
+            detail::shared_mesh_data<std::vector<piecewise_polynomial<T> > > basis_functions_;
 
             bool valid_;
 
             void set_validity() {
                 valid_ = true;
                 valid_ = valid_ && dim_ > 0;
-                valid_ = valid_ && std::size_t(dim_) == basis_functions_.size();
+                valid_ = valid_ && std::size_t(dim_) == basis_functions_.get().size();
                 valid_ = valid_ && beta_ >= 0.0;
                 valid_ = valid_ && (statistics_==statistics::FERMIONIC || statistics_==statistics::BOSONIC);
 
-                if (basis_functions_.size() > 1u) {
-                    for (std::size_t l=0; l < basis_functions_.size()-1; ++l) {
-                        valid_ = valid_ && (basis_functions_[l].section_edges() == basis_functions_[l+1].section_edges());
+                const std::vector<piecewise_polynomial<T> > &basis_functions = basis_functions_.get();
+                if (basis_functions.size() > 1u) {
+                    for (std::size_t l=0; l < basis_functions.size()-1; ++l) {
+                        valid_ = valid_ && (basis_functions[l].section_edges() == basis_functions[l+1].section_edges());
                     }
                 }
             }
@@ -1075,9 +1156,8 @@ namespace alps {
 
         public:
             typedef generic_index<numerical_mesh> index_type;
-            numerical_mesh(const numerical_mesh<T>& rhs) : beta_(rhs.beta_), dim_(rhs.dim_), basis_functions_(rhs.basis_functions_), statistics_(rhs.statistics_), valid_(rhs.valid_) {
+            numerical_mesh(const numerical_mesh<T>& rhs) : base_mesh(rhs), beta_(rhs.beta_), dim_(rhs.dim_), statistics_(rhs.statistics_), basis_functions_(rhs.basis_functions_), valid_(rhs.valid_) {
                 set_validity();
-                compute_points();
             }
             numerical_mesh(gf::statistics::statistics_type statistics=statistics::FERMIONIC):
                     beta_(0.0), dim_(0), statistics_(statistics), basis_functions_(), valid_(false) {}
@@ -1118,7 +1198,12 @@ namespace alps {
             const piecewise_polynomial<T>& basis_function(int l) const {
                 assert(l>=0 && l < dim_);
                 check_validity();
-                return basis_functions_[l];
+                return basis_functions_.get()[l];
+            }
+            /// evaluator computing all basis functions at once; construct it once and reuse it for many points
+            piecewise_polynomial_evaluator<T> basis_evaluator() const {
+                check_validity();
+                return piecewise_polynomial_evaluator<T>(basis_functions_.get());
             }
 
 
@@ -1132,7 +1217,7 @@ namespace alps {
                 if (this->statistics_ != other.statistics_) {
                     throw std::runtime_error("Do not swap numerical meshes with different statistics!");
                 }
-                swap(this->basis_functions_, other.basis_functions_);
+                this->basis_functions_.swap(other.basis_functions_);
                 base_mesh::swap(other);
             }
 
@@ -1141,7 +1226,9 @@ namespace alps {
                 this->dim_ = other.dim_;
                 this->statistics_ = other.statistics_;
                 this->basis_functions_ = other.basis_functions_;
+                this->valid_ = other.valid_;
                 base_mesh::operator=(other);
+                return *this;
             }
 
             void save(alps::hdf5::archive& ar, const std::string& path) const
@@ -1152,7 +1239,7 @@ namespace alps {
                 ar[path+"/statistics"] << int(statistics_);
                 ar[path+"/beta"] << beta_;
                 for (int l=0; l < dim_; ++l) {
-                    basis_functions_[l].save(ar, path+"/basis_functions"+std::to_string(l));
+                    basis_functions_.get()[l].save(ar, path+"/basis_functions"+std::to_string(l));
                 }
             }
 
@@ -1171,10 +1258,11 @@ namespace alps {
                 }
 
                 ar[path+"/beta"] >> beta;
-                basis_functions_.resize(dim);
+                std::vector<piecewise_polynomial<T> > basis_functions(dim);
                 for (int l=0; l < dim; ++l) {
-                    basis_functions_[l].load(ar, path+"/basis_functions"+std::to_string(l));
+                    basis_functions[l].load(ar, path+"/basis_functions"+std::to_string(l));
                 }
+                basis_functions_ = detail::shared_mesh_data<std::vector<piecewise_polynomial<T> > >(basis_functions);
 
                 statistics_ = static_cast<statistics::statistics_type>(stat);
                 beta_=beta;
@@ -1198,21 +1286,24 @@ namespace alps {
 #ifdef ALPS_HAVE_MPI
             void broadcast(const alps::mpi::communicator& comm, int root)
             {
-                using alps::mpi::broadcast;
                 if(comm.rank() == root) check_validity();
+                alps::mpi::broadcast_packed(comm, *this, root);
+            }
 
-                broadcast(comm, beta_, root);
-                broadcast(comm, dim_, root);
-                {
-                    int stat = static_cast<int>(statistics_);
-                    broadcast(comm, stat, root);
-                    statistics_=statistics::statistics_type(stat);
-                }
+            /// Pack for an MPI transfer
+            void pack(alps::mpi::packer& p) const
+            {
+                p << beta_ << dim_ << static_cast<int>(statistics_) << basis_functions_.get();
+            }
 
-                basis_functions_.resize(dim_);
-                for (int l=0; l < dim_; ++l) {
-                    basis_functions_[l].broadcast(comm, root);
-                }
+            /// Unpack
+            void unpack(alps::mpi::unpacker& u)
+            {
+                int stat = 0;
+                std::vector<piecewise_polynomial<T> > basis_functions;
+                u >> beta_ >> dim_ >> stat >> basis_functions;
+                statistics_=statistics::statistics_type(stat);
+                basis_functions_ = detail::shared_mesh_data<std::vector<piecewise_polynomial<T> > >(basis_functions);
 
                 set_validity();
                 try {
@@ -1220,7 +1311,7 @@ namespace alps {
                 } catch (const std::exception& exc) {
                     // FIXME? Try to communiucate the error with all ranks, at least in debug mode?
                     int wrank=alps::mpi::communicator().rank();
-                    std::cerr << "numerical_mesh<>::broadcast() exception at WORLD rank=" << wrank << std::endl
+                    std::cerr << "numerical_mesh<>::unpack() exception at WORLD rank=" << wrank << std::endl
                               << exc.what()
                               << "\nAborting." << std::endl;
                     MPI_Abort(MPI_COMM_WORLD,1);
@@ -1230,10 +1321,11 @@ namespace alps {
 #endif
 
             void compute_points(){
-                _points().resize(extent());
+                std::vector<double> points(extent());
                 for(int i=0;i<dim_;++i){
-                    _points()[i]=i;
+                    points[i]=i;
                 }
+                set_points(points);
             }
         };
 
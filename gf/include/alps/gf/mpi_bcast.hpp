@@ -12,10 +12,37 @@
 #define ALPS_GF_MPI_BCAST_HPP_c030bec39d4b43b9a24a16b5805f542d
 
 #include <alps/utilities/mpi.hpp>
+#include <alps/utilities/mpi_pack.hpp>
+#include <alps/type_traits/index_sequence.hpp>
 #include <iostream>
+#include <tuple>
 namespace alps {
     namespace gf {
         namespace detail {
+            /// A tuple of meshes, packed as one object
+            template <typename MESHES, typename Seq=make_index_sequence<std::tuple_size<MESHES>::value> >
+            struct packed_meshes;
+
+            template <typename MESHES, size_t...Is>
+            struct packed_meshes<MESHES, index_sequence<Is...> > {
+                MESHES& meshes;
+                void pack(alps::mpi::packer& p) const {
+                    using swallow = int[];
+                    (void)swallow{0, (std::get<Is>(meshes).pack(p), 0)...};
+                }
+                void unpack(alps::mpi::unpacker& u) {
+                    using swallow = int[];
+                    (void)swallow{0, (std::get<Is>(meshes).unpack(u), 0)...};
+                }
+            };
+
+            /// Broadcast a tuple of meshes in a single message
+            template <typename MESHES>
+            void broadcast_meshes(const alps::mpi::communicator& comm, MESHES& meshes, int root) {
+                packed_meshes<MESHES> message{meshes};
+                alps::mpi::broadcast_packed(comm, message, root);
+            }
+
             /// Broadcast a vector
             /** @note Non-default allocator is silently unsupported. */ 
             template <typename T>
@@ -7,6 +7,7 @@
 #ifndef ALPSCORE_PIEACEWISE_POLYNOMIAL_HPP
 #define ALPSCORE_PIEACEWISE_POLYNOMIAL_HPP
 
+#include <algorithm>
 #include <complex>
 #include <cmath>
 #include <type_traits>
@@ -63,6 +64,16 @@ namespace alps {
                 return std::conj(a);
             }
 
+            /// Evaluates \sum_{p=0}^k c[p] dx^p by Horner's rule
+            template<class T>
+            inline T horner(const T *c, int k, double dx) {
+                T r = c[k];
+                for (int p = k - 1; p >= 0; --p) {
+                    r = r * dx + c[p];
+                }
+                return r;
+            }
+
             template<typename T, typename Op>
             struct pp_element_wise_op {
                 void perform(const T *p1, const T *p2, T *p_r, int k1, int k2, int k_r) const {
@@ -295,6 +306,31 @@ namespace alps {
                 return r;
             }
 
+            /**
+             * Compute the values at n points x[0] <= x[1] <= ... <= x[n-1] into out[0..n-1].
+             *
+             * The sections are found by walking along the sorted points instead of a binary search per point.
+             */
+            void compute_values(const double *x, std::size_t n, T *out) const {
+                check_validity();
+                if (n == 0) {
+                    return;
+                }
+                check_range(x[0]);
+                check_range(x[n-1]);
+                const T *coeff = coeff_.origin();
+                int section = find_section(x[0]);
+                for (std::size_t i = 0; i < n; ++i) {
+                    if (i > 0 && x[i] < x[i-1]) {
+                        throw std::runtime_error("The given x must be sorted in ascending order.");
+                    }
+                    while (section < n_sections_ - 1 && x[i] >= section_edges_[section + 1]) {
+                        ++section;
+                    }
+                    out[i] = detail::horner(coeff + section * (k_ + 1), k_, x[i] - section_edges_[section]);
+                }
+            }
+
             /// Find the section involving the given x
             int find_section(double x) const {
 #ifndef NDEBUG
@@ -392,15 +428,23 @@ namespace alps {
             /// Broadcast
             void broadcast(const alps::mpi::communicator& comm, int root)
             {
-                using alps::mpi::broadcast;
+                alps::mpi::broadcast_packed(comm, *this, root);
+            }
 
-                broadcast(comm, k_, root);
-                broadcast(comm, n_sections_, root);
-                section_edges_.resize(n_sections_+1);
-                broadcast(comm, &section_edges_[0], n_sections_+1, root);
+            /// Pack for an MPI transfer
+            void pack(alps::mpi::packer& p) const
+            {
+                p << k_ << n_sections_ << section_edges_;
+                p.write(coeff_.origin(), coeff_.num_elements());
+            }
 
+            /// Unpack
+            void unpack(alps::mpi::unpacker& u)
+            {
+                u >> k_ >> n_sections_ >> section_edges_;
+                if (k_ < 0 || n_sections_ < 1) throw std::runtime_error("Invalid piecewise_polynomial in unpack()");
                 coeff_.resize(boost::extents[n_sections_][k_+1]);
-                broadcast(comm, coeff_.origin(), (k_+1)*n_sections_, root);
+                u.read(coeff_.origin(), coeff_.num_elements());
 
                 set_validity();
                 check_validity();
@@ -450,6 +494,118 @@ namespace alps {
                 pps[l] = (1.0 / std::sqrt(norm)) * pp_new;
             }
         }
+
+/**
+ * Evaluates a set of piecewise polynomials with common section edges at once.
+ *
+ * The section is found once per point for all functions, and the coefficients are stored as
+ * [section][power][function], so that each Horner step is a contiguous loop over the functions
+ * which the compiler vectorizes.
+ */
+        template<typename T>
+        class piecewise_polynomial_evaluator {
+        public:
+            piecewise_polynomial_evaluator() : k_(-1), n_functions_(0) {}
+
+            /// Construct from functions sharing the same section edges
+            explicit piecewise_polynomial_evaluator(const std::vector<piecewise_polynomial<T> > &functions) :
+                    k_(0), n_functions_(functions.size()) {
+                if (functions.empty()) {
+                    throw std::runtime_error("piecewise_polynomial_evaluator needs at least one function.");
+                }
+                section_edges_ = functions[0].section_edges();
+                for (std::size_t l = 0; l < functions.size(); ++l) {
+                    if (functions[l].section_edges() != section_edges_) {
+                        throw std::runtime_error("Cannot evaluate piecewise polynomials with different sections at once!");
+                    }
+                    k_ = std::max(k_, functions[l].order());
+                }
+                const int n_sections = section_edges_.size() - 1;
+                coeff_.assign(n_sections * (k_ + 1) * n_functions_, T(0.0));
+                for (int s = 0; s < n_sections; ++s) {
+                    for (int l = 0; l < n_functions_; ++l) {
+                        for (int p = 0; p < functions[l].order() + 1; ++p) {
+                            coeff_[(s * (k_ + 1) + p) * n_functions_ + l] = functions[l].coefficient(s, p);
+                        }
+                    }
+                }
+            }
+
+            /// Number of functions
+            int num_functions() const {
+                return n_functions_;
+            }
+
+            /// Maximum order of the polynomials
+            int order() const {
+                return k_;
+            }
+
+            /// Return a refence to end points
+            const std::vector<double> &section_edges() const {
+                return section_edges_;
+            }
+
+            /// Compute the values of all functions at x into out[0..num_functions()-1]
+            void compute_values(double x, T *out) const {
+                const int section = find_section(x);
+                evaluate(section, x - section_edges_[section], out);
+            }
+
+            /**
+             * Compute the values of all functions at n points x[0] <= x[1] <= ... <= x[n-1].
+             *
+             * The value of function l at x[i] is stored in out[i*num_functions()+l].
+             */
+            void compute_values(const double *x, std::size_t n, T *out) const {
+                if (n == 0) {
+                    return;
+                }
+                find_section(x[n-1]); // range check
+                int section = find_section(x[0]);
+                const int n_sections = section_edges_.size() - 1;
+                for (std::size_t i = 0; i < n; ++i) {
+                    if (i > 0 && x[i] < x[i-1]) {
+                        throw std::runtime_error("The given x must be sorted in ascending order.");
+                    }
+                    while (section < n_sections - 1 && x[i] >= section_edges_[section + 1]) {
+                        ++section;
+                    }
+                    evaluate(section, x[i] - section_edges_[section], out + i * n_functions_);
+                }
+            }
+
+        private:
+            int k_;
+            int n_functions_;
+            std::vector<double> section_edges_;
+            /// coefficients [s,p,l]
+            std::vector<T> coeff_;
+
+            int find_section(double x) const {
+                if (section_edges_.empty()) {
+                    throw std::runtime_error("piecewise_polynomial_evaluator object is not properly constructed!");
+                }
+                if (x < section_edges_.front() || x > section_edges_.back()) {
+                    throw std::runtime_error("Give x is out of the range.");
+                }
+                if (x == section_edges_.back()) {
+                    return section_edges_.size() - 2;
+                }
+                return std::upper_bound(section_edges_.begin(), section_edges_.end(), x) - section_edges_.begin() - 1;
+            }
+
+            void evaluate(int section, double dx, T *out) const {
+                const T *c = &coeff_[section * (k_ + 1) * n_functions_];
+                std::copy(c + k_ * n_functions_, c + (k_ + 1) * n_functions_, out);
+                for (int p = k_ - 1; p >= 0; --p) {
+                    const T *cp = c + p * n_functions_;
+                    for (int l = 0; l < n_functions_; ++l) {
+                        out[l] = out[l] * dx + cp[l];
+                    }
+                }
+            }
+        };
     }
 }
 
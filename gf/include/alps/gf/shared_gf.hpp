@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file shared_gf.hpp
+    @brief Read-only Green's functions stored once per node in MPI-3 shared memory
+ */
+
+#ifndef ALPSCORE_GF_SHARED_GF_HPP
+#define ALPSCORE_GF_SHARED_GF_HPP
+
+#include <tuple>
+
+#include <alps/utilities/mpi.hpp>
+#include <alps/utilities/mpi_shared.hpp>
+
+#include <alps/gf/gf_base.hpp>
+
+#if MPI_VERSION >= 3
+
+namespace alps {
+  namespace gf {
+
+    /**
+     * @brief Green's function broadcast from one rank and shared by the ranks of each node
+     *
+     * The meshes are copied to every rank, the data is stored once per node in an MPI-3
+     * shared-memory window and accessed through a GF view (`view()`). The data must not be
+     * modified; the window is freed when the last copy of the object is destroyed.
+     *
+     * @tparam VTYPE  - value type
+     * @tparam MESHES - meshes of the GF
+     */
+    template<class VTYPE, class ...MESHES>
+    class shared_gf {
+    public:
+      /// Value type
+      using value_type = VTYPE;
+      /// mesh types tuple
+      using mesh_types = std::tuple<MESHES...>;
+      /// type of the broadcast GF
+      using gf_type = greenf<VTYPE, MESHES...>;
+      /// type of the view of the shared data
+      using view_type = greenf_view<VTYPE, MESHES...>;
+
+    private:
+      /// global meshes
+      mesh_types meshes_;
+      /// data of the node
+      alps::mpi::shared_array<VTYPE> data_;
+      /// view of the data
+      view_type view_;
+
+      static mesh_types broadcast_meshes(const alps::mpi::communicator &comm, const gf_type &g, int root) {
+        mesh_types meshes;
+        if (comm.rank() == root) meshes = g.meshes();
+        detail::broadcast_meshes(comm, meshes, root);
+        return meshes;
+      }
+
+      template<size_t...Is>
+      static size_t size(const mesh_types &meshes, index_sequence<Is...>) {
+        size_t n = 1;
+        using swallow = int[];
+        (void)swallow{0, (n *= std::get < Is >(meshes).extent(), 0)...};
+        return n;
+      }
+
+    public:
+      /// Broadcast the GF `g` stored on `root`; `g` is ignored on the other ranks. Collective over `comm`.
+      shared_gf(const alps::mpi::communicator &comm, const gf_type &g, int root) :
+        meshes_(broadcast_meshes(comm, g, root)),
+        data_(alps::mpi::broadcast_shared(comm, comm.rank() == root ? g.data().data() : static_cast<const VTYPE *>(0),
+                                          size(meshes_, make_index_sequence<sizeof...(MESHES)>()), root)),
+        view_(data_.data(), meshes_) {}
+
+      /// @return view of the shared GF
+      const view_type &view() const { return view_; }
+
+      /// @return meshes of the GF
+      const mesh_types &meshes() const { return meshes_; }
+
+      /// @return value at the given indices
+      template<class...Indices>
+      const VTYPE &operator()(Indices...inds) const { return view_(inds...); }
+    };
+  }
+}
+
+#endif /* MPI_VERSION >= 3 */
+
+#endif //ALPSCORE_GF_SHARED_GF_HPP
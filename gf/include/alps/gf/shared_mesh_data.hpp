@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <boost/multi_array.hpp>
+
+#include "piecewise_polynomial.hpp"
+
+namespace alps {
+    namespace gf {
+        namespace detail {
+
+            /// Hash of mesh points
+            inline std::size_t hash_mesh_data(const std::vector<double> &points) {
+                return boost::hash_range(points.begin(), points.end());
+            }
+
+            /// Hash of momentum/real space mesh points
+            inline std::size_t hash_mesh_data(const boost::multi_array<double, 2> &points) {
+                std::size_t seed = boost::hash_range(points.shape(), points.shape() + 2);
+                boost::hash_range(seed, points.origin(), points.origin() + points.num_elements());
+                return seed;
+            }
+
+            /// Hash of a set of basis functions
+            template<typename T>
+            std::size_t hash_mesh_data(const std::vector<piecewise_polynomial<T> > &functions) {
+                std::size_t seed = 0;
+                for (std::size_t l = 0; l < functions.size(); ++l) {
+                    const piecewise_polynomial<T> &f = functions[l];
+                    boost::hash_combine(seed, f.order());
+                    boost::hash_range(seed, f.section_edges().begin(), f.section_edges().end());
+                    for (int s = 0; s < f.num_sections(); ++s) {
+                        for (int p = 0; p < f.order() + 1; ++p) {
+                            boost::hash_combine(seed, f.coefficient(s, p));
+                        }
+                    }
+                }
+                return seed;
+            }
+
+            /**
+             * Reference-counted, immutable data of a mesh (points, basis functions, ...).
+             *
+             * Copies share the data, so copying a mesh is O(1). Data passed to the constructor is interned in a
+             * process-wide table: meshes constructed independently from equal data share one object, and
+             * comparing them is a pointer comparison. Data of different interned objects is known to differ.
+             * Only data modified through `modify()` (copy-on-write) is compared element by element.
+             */
+            template<typename T>
+            class shared_mesh_data {
+                struct entry {
+                    entry(const T &v, bool i) : value(v), interned(i) {}
+                    entry(T &&v, bool i) : value(std::move(v)), interned(i) {}
+                    T value;
+                    bool interned;
+                };
+
+                /// Table of the interned data; holds weak references only
+                class intern_table {
+                    std::mutex mutex_;
+                    std::unordered_multimap<std::size_t, std::weak_ptr<entry> > table_;
+                    std::size_t sweep_size_;
+
+                public:
+                    intern_table() : sweep_size_(64) {}
+
+                    std::shared_ptr<entry> intern(T &&value) {
+                        const std::size_t hash = hash_mesh_data(value);
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        typedef typename std::unordered_multimap<std::size_t, std::weak_ptr<entry> >::iterator iterator;
+                        std::pair<iterator, iterator> range = table_.equal_range(hash);
+                        for (iterator it = range.first; it != range.second; ++it) {
+                            std::shared_ptr<entry> existing = it->second.lock();
+                            if (existing && existing->value == value) {
+                                return existing;
+                            }
+                        }
+                        std::shared_ptr<entry> created = std::make_shared<entry>(std::move(value), true);
+                        table_.insert(std::make_pair(hash, std::weak_ptr<entry>(created)));
+                        // drop the entries of destroyed meshes once the table has doubled
+                        if (table_.size() >= 2 * sweep_size_) {
+                            for (iterator it = table_.begin(); it != table_.end(); ) {
+                                it = it->second.expired() ? table_.erase(it) : ++it;
+                            }
+                            sweep_size_ = std::max(sweep_size_, table_.size());
+                        }
+                        return created;
+                    }
+                };
+
+                static intern_table &table() {
+                    static intern_table instance;
+                    return instance;
+                }
+
+                static const std::shared_ptr<entry> &empty() {
+                    static const std::shared_ptr<entry> instance = table().intern(T());
+                    return instance;
+                }
+
+                std::shared_ptr<entry> ptr_;
+
+            public:
+                /// Shared default-constructed data
+                shared_mesh_data() : ptr_(empty()) {}
+
+                /// Interned copy of the given data
+                explicit shared_mesh_data(T value) : ptr_(table().intern(std::move(value))) {}
+
+                /// Read access
+                const T &get() const { return ptr_->value; }
+
+                /// Write access; detaches this object from the data shared with others
+                T &modify() {
+                    if (ptr_->interned || ptr_.use_count() > 1) {
+                        ptr_ = std::make_shared<entry>(ptr_->value, false);
+                    }
+                    return ptr_->value;
+                }
+
+                /// Interned data equal to this one; `*this` unless the data was modified through `modify()`
+                shared_mesh_data interned() const {
+                    return ptr_->interned ? *this : shared_mesh_data(ptr_->value);
+                }
+
+                /**
+                 * Identity of the data, for use as a key ordered by `std::owner_less`.
+                 *
+                 * Interned data is never modified, so the identities of interned data are equal if and only if
+                 * the data is equal; they stay distinct from those of data created later even after the data is
+                 * destroyed.
+                 */
+                std::weak_ptr<const void> identity() const { return ptr_; }
+
+                /// True if the data is shared with `rhs` (no comparison of the data)
+                bool is_shared_with(const shared_mesh_data &rhs) const { return ptr_ == rhs.ptr_; }
+
+                bool operator==(const shared_mesh_data &rhs) const {
+                    if (ptr_ == rhs.ptr_) return true;
+                    if (ptr_->interned && rhs.ptr_->interned) return false;
+                    return ptr_->value == rhs.ptr_->value;
+                }
+
+                bool operator!=(const shared_mesh_data &rhs) const { return !(*this == rhs); }
+
+                void swap(shared_mesh_data &other) { ptr_.swap(other.ptr_); }
+            };
+        }
+    }
+}
@@ -20,22 +20,34 @@ namespace alps {
 
 #ifdef ALPS_HAVE_MPI
       template <typename TAILT>
-      void broadcast_tail(const alps::mpi::communicator& comm,
-                          int& min_order, int& max_order,
-                          std::vector<TAILT>& tails,
-                          const TAILT& tail_init,
-                          int root)
+      void pack_tail(alps::mpi::packer& p,
+                     int min_order, int max_order,
+                     const std::vector<TAILT>& tails)
       {
-        using alps::mpi::broadcast;
-        broadcast(comm, min_order, root);
-        broadcast(comm, max_order, root);
+        p << min_order << max_order;
 
         if (min_order==TAIL_NOT_SET) return;
-        if (comm.rank()!=root) {
-          tails.resize(max_order+1, tail_init);
+        // the tails are small, so their data go with the meshes
+        for (int i=min_order; i<=max_order; ++i) {
+          tails[i].pack(p);
+          p.write(tails[i].data().data(), tails[i].data().size());
         }
+      }
+
+      template <typename TAILT>
+      void unpack_tail(alps::mpi::unpacker& u,
+                       int& min_order, int& max_order,
+                       std::vector<TAILT>& tails,
+                       const TAILT& tail_init)
+      {
+        u >> min_order >> max_order;
+
+        if (min_order==TAIL_NOT_SET) return;
+        if (min_order<0 || max_order<min_order) throw std::runtime_error("Invalid tail orders in unpack()");
+        tails.resize(max_order+1, tail_init);
         for (int i=min_order; i<=max_order; ++i) {
-          tails[i].broadcast(comm,root);
+          tails[i].unpack(u);
+          u.read(tails[i].data().data(), tails[i].data().size());
         }
       }
 #endif
@@ -208,11 +220,27 @@ namespace alps {
         void broadcast(const alps::mpi::communicator& comm, int root)
         {
           // FIXME: use clone-swap?
-          gf_type::broadcast(comm,root);
-          detail::broadcast_tail(comm,
-                                 min_tail_order_, max_tail_order_,
-                                 tails_, tail_type(tuple_tail < 1, std::tuple_size<typename HEADGF::mesh_types>::value >(meshes())),
-                                 root);
+#ifndef NDEBUG
+          if(comm.rank() == root && this->is_empty()) throw std::runtime_error("gf is empty");
+#endif
+          alps::mpi::broadcast_packed(comm, *this, root);
+          this->broadcast_data(comm, root);
+        }
+
+        /// Pack the meshes of the GF and the tails for an MPI transfer
+        void pack(alps::mpi::packer& p) const
+        {
+          gf_type::pack(p);
+          detail::pack_tail(p, min_tail_order_, max_tail_order_, tails_);
+        }
+
+        /// Unpack the GF and the tails
+        void unpack(alps::mpi::unpacker& u)
+        {
+          gf_type::unpack(u);
+          detail::unpack_tail(u,
+                              min_tail_order_, max_tail_order_,
+                              tails_, tail_type(tuple_tail < 1, std::tuple_size<typename HEADGF::mesh_types>::value >(meshes())));
         }
 #endif
       };
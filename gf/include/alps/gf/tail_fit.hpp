@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <alps/gf/gf.hpp>
+#include <alps/gf/transform_cache.hpp>
+
+/**
+ * Least-squares fit of the high-frequency tail G(i\omega_n) ~ \sum_m c_m/(i\omega_n)^m on the last Matsubara points.
+ *
+ * The design matrix A_{nm} = (i\omega_n)^{-m} only depends on the frequencies and the fitted orders, so its
+ * pseudo-inverse P is computed once per set of frequencies (and cached), and the coefficients of all indices
+ * of the GF are obtained by one matrix product c = P G. Tails that are already known are kept as constraints:
+ * their contribution is subtracted as c_fit = P G - (P A_known) c_known.
+ * Real tails are fitted with real coefficients, i.e. to the real and imaginary parts of G at once.
+ */
+namespace alps {
+namespace gf {
+
+namespace detail {
+
+/// Pseudo-inverse of the design matrix of the fit, and its product with the columns of the known orders
+template<typename T> struct tail_projector {
+  typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic> matrix_type;
+  /// fitted orders x (n or 2n for real coefficients) points
+  matrix_type p;
+  /// fitted orders x known orders
+  matrix_type p_known;
+};
+
+/// Column of the design matrix for order m: (i\omega_n)^{-m}, stacked as [Re; Im] for real coefficients
+inline void tail_design_column(const std::vector<double> &omega, int m, double scale,
+                               Eigen::Matrix<std::complex<double>, Eigen::Dynamic, 1> &col) {
+  col.resize(omega.size());
+  for (size_t n=0; n<omega.size(); ++n) col(n) = std::pow(std::complex<double>(0., omega[n]/scale), -m);
+}
+inline void tail_design_column(const std::vector<double> &omega, int m, double scale, Eigen::VectorXd &col) {
+  size_t nfit = omega.size();
+  col.resize(2*nfit);
+  for (size_t n=0; n<nfit; ++n) {
+    std::complex<double> a = std::pow(std::complex<double>(0., omega[n]/scale), -m);
+    col(n) = a.real();
+    col(nfit + n) = a.imag();
+  }
+}
+
+/// Fit matrices for the frequencies `omega`, fitted orders `orders` and known orders `known`
+template<typename T>
+tail_projector<T> *make_tail_projector(const std::vector<double> &omega, const std::vector<int> &orders,
+                                       const std::vector<int> &known) {
+  typedef typename tail_projector<T>::matrix_type matrix_type;
+  typedef Eigen::Matrix<T, Eigen::Dynamic, 1> vector_type;
+  // the columns are scaled by the largest frequency to keep the system well conditioned
+  double scale = 0;
+  for (size_t n=0; n<omega.size(); ++n) scale = std::max(scale, std::abs(omega[n]));
+  vector_type col;
+  tail_design_column(omega, 0, 1., col);
+  matrix_type a(col.size(), orders.size()), a_known(col.size(), known.size());
+  for (size_t j=0; j<orders.size(); ++j) {
+    tail_design_column(omega, orders[j], scale, col);
+    a.col(j) = col;
+  }
+  for (size_t j=0; j<known.size(); ++j) {
+    tail_design_column(omega, known[j], 1., col);
+    a_known.col(j) = col;
+  }
+  // with real coefficients, even (odd) orders only enter the real (imaginary) parts, so counting points is not enough
+  Eigen::ColPivHouseholderQR<matrix_type> qr(a);
+  if (qr.rank() < a.cols())
+    throw std::invalid_argument("Tail fit with more coefficients than the data points determine");
+  tail_projector<T> *proj = new tail_projector<T>;
+  proj->p = qr.solve(matrix_type::Identity(a.rows(), a.rows()));
+  for (size_t j=0; j<orders.size(); ++j) proj->p.row(j) *= std::pow(scale, orders[j]);
+  proj->p_known = proj->p*a_known;
+  return proj;
+}
+
+/// Fit matrices, computed once per set of parameters (the least recently used ones are dropped from the cache)
+template<typename T>
+std::shared_ptr<const tail_projector<T> > tail_fit_projector(const std::vector<double> &omega, const std::vector<int> &orders,
+                                                             const std::vector<int> &known) {
+  typedef std::tuple<std::vector<double>, std::vector<int>, std::vector<int> > key_type;
+  static transform_cache<key_type, tail_projector<T> > cache;
+  return cache.get(key_type(omega, orders, known), [&]() { return make_tail_projector<T>(omega, orders, known); });
+}
+
+typedef Eigen::Matrix<std::complex<double>, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> complex_row_block;
+typedef Eigen::Map<const complex_row_block> const_complex_block;
+
+/// c = P G for complex coefficients
+inline void apply_tail_projector(const tail_projector<std::complex<double> > &proj, const_complex_block g,
+                                 Eigen::Matrix<std::complex<double>, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> &c) {
+  c.noalias() = proj.p*g;
+}
+/// c = P [Re G; Im G] for real coefficients
+inline void apply_tail_projector(const tail_projector<double> &proj, const_complex_block g,
+                                 Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> &c) {
+  typedef Eigen::Map<const Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>, 0,
+                     Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic> > part_type;
+  size_t nfit = g.rows(), nother = g.cols();
+  const double *data = reinterpret_cast<const double *>(g.data());
+  Eigen::Stride<Eigen::Dynamic, Eigen::Dynamic> stride(2*nother, 2);
+  c.noalias() = proj.p.leftCols(nfit)*part_type(data, nfit, nother, stride);
+  c.noalias() += proj.p.rightCols(nfit)*part_type(data + 1, nfit, nother, stride);
+}
+
+}
+
+/**
+ * Fits the tails of orders `min_order`..`max_order` of `g` on its last `nfit` Matsubara frequencies.
+ * Tails already set in `g` (orders between `min_tail_order()` and `max_tail_order()`) are kept fixed, and their
+ * contribution is subtracted before the other orders are fitted.
+ */
+template<class HEADGF, class TAILGF>
+void fit_tail(detail::gf_tail_base<HEADGF, TAILGF> &g, int nfit, int max_order, int min_order = 1) {
+  typedef typename TAILGF::value_type tail_value_type;
+  static_assert(std::is_same<typename HEADGF::value_type, std::complex<double> >::value,
+                "the tail is fitted to a complex Matsubara Green's function");
+  static const size_t N = std::tuple_size<typename HEADGF::mesh_types>::value;
+  const HEADGF &head = g;
+  const std::vector<double> &points = head.mesh1().points();
+  int nw = int(points.size());
+  if (nfit < 1 || nfit > nw)
+    throw std::invalid_argument("Tail fit requires 1 <= nfit <= number of frequencies");
+  if (min_order < 0 || max_order < min_order)
+    throw std::invalid_argument("Tail fit requires 0 <= min_order <= max_order");
+  std::vector<double> omega(points.end() - nfit, points.end());
+  for (size_t n=0; n<omega.size(); ++n) {
+    if (omega[n] == 0) throw std::invalid_argument("Tail fit on the zero frequency");
+  }
+  std::vector<int> orders, known;
+  if (g.min_tail_order() != TAIL_NOT_SET) {
+    for (int m=g.min_tail_order(); m<=g.max_tail_order(); ++m) known.push_back(m);
+  }
+  for (int m=min_order; m<=max_order; ++m) {
+    if (std::find(known.begin(), known.end(), m) == known.end()) orders.push_back(m);
+  }
+  if (orders.empty()) return;
+
+  size_t nother = head.data().size()/nw;
+  std::shared_ptr<const detail::tail_projector<tail_value_type> > proj =
+      detail::tail_fit_projector<tail_value_type>(omega, orders, known);
+  Eigen::Matrix<tail_value_type, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> c(orders.size(), nother);
+  detail::apply_tail_projector(*proj, detail::const_complex_block(head.data().data() + (nw - nfit)*nother, nfit, nother), c);
+  for (size_t j=0; j<known.size(); ++j) {
+    Eigen::Map<const Eigen::Matrix<tail_value_type, 1, Eigen::Dynamic> > ck(g.tail(known[j]).data().data(), nother);
+    c.noalias() -= proj->p_known.col(j)*ck;
+  }
+  for (size_t j=0; j<orders.size(); ++j) {
+    TAILGF tail(tuple_tail < 1, N >(head.meshes()));
+    Eigen::Map<Eigen::Matrix<tail_value_type, 1, Eigen::Dynamic> >(tail.data().data(), nother) = c.row(j);
+    g.set_tail(orders[j], tail);
+  }
+}
+
+/**
+ * Returns a copy of `g` with the tails of orders `min_order`..`max_order` fitted on its last `nfit` Matsubara frequencies,
+ * e.g. `fit_tail<greenf<double, index_mesh> >(g_omega, 20, 3)`
+ */
+template<class TAILGF, class S, mesh::frequency_positivity_type PTYPE, class ...MESHES>
+gf_tail<greenf<std::complex<double>, matsubara_mesh<PTYPE>, MESHES...>, TAILGF>
+fit_tail(const detail::gf_base<std::complex<double>, S, matsubara_mesh<PTYPE>, MESHES...> &g, int nfit, int max_order, int min_order = 1) {
+  gf_tail<greenf<std::complex<double>, matsubara_mesh<PTYPE>, MESHES...>, TAILGF> result(g);
+  fit_tail(result, nfit, max_order, min_order);
+  return result;
+}
+
+}
+} // end alps::
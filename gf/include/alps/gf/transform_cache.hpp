@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include <alps/utilities/lru_cache.hpp>
+
+namespace alps {
+namespace gf {
+namespace detail {
+
+/**
+ * Thread-safe cache of transformation matrices, keyed by the parameters they are computed from.
+ *
+ * At most `capacity` matrices are kept; when a new one is added, the least recently used one is dropped.
+ * Matrices still held by callers stay alive through their shared pointers.
+ */
+template<typename KEY, typename VALUE, typename COMPARE = std::less<KEY> >
+class transform_cache : public alps::lru_cache<KEY, std::shared_ptr<const VALUE>, COMPARE> {
+    typedef alps::lru_cache<KEY, std::shared_ptr<const VALUE>, COMPARE> base_type;
+  public:
+    explicit transform_cache(std::size_t capacity = 16) : base_type(capacity) {}
+
+    /// The matrix for `key`; `make()` returns a newly allocated one if it is not cached
+    template<typename MAKE> std::shared_ptr<const VALUE> get(const KEY &key, MAKE make) {
+      return base_type::get(key, [&]() { return std::shared_ptr<const VALUE>(make()); });
+    }
+};
+
+}
+}
+}
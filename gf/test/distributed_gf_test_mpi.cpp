@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/* Test of the distributed GF. Run with several ranks, e.g. ALPS_TEST_MPI_NPROC=3 */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+
+#include <alps/gf/distributed_gf.hpp>
+#include <alps/gf/mesh.hpp>
+#include <alps/testing/unique_file.hpp>
+#include <alps/utilities/gtest_par_xml_output.hpp>
+
+namespace g = alps::gf;
+
+class DistributedGFTest : public ::testing::Test
+{
+public:
+  typedef g::greenf<std::complex<double>, g::matsubara_positive_mesh, g::index_mesh, g::index_mesh> gf_type;
+  typedef g::distributed_gf<std::complex<double>, 1, g::matsubara_positive_mesh, g::index_mesh, g::index_mesh> dist_gf_type;
+  alps::mpi::communicator comm;
+  const int nfreq;
+  const int nk;
+  const int norb;
+  gf_type gf;
+
+  DistributedGFTest(): nfreq(4), nk(7), norb(2),
+                       gf(g::matsubara_positive_mesh(5.0, nfreq), g::index_mesh(nk), g::index_mesh(norb)) {
+    for (g::matsubara_index w(0); w < nfreq; ++w)
+      for (g::index k(0); k < nk; ++k)
+        for (g::index i(0); i < norb; ++i)
+          gf(w, k, i) = value(w(), k(), i());
+  }
+
+  static std::complex<double> value(int w, int k, int i) {
+    return std::complex<double>(100 * w + 10 * k + i, w - k);
+  }
+};
+
+TEST_F(DistributedGFTest, Partition) {
+  dist_gf_type dgf(comm, gf.meshes());
+  size_t total = 0;
+  for (int r = 0; r < comm.size(); ++r) {
+    EXPECT_EQ(total, dgf.offset(r));
+    total += dgf.extent(r);
+    if (r > 0) {
+      EXPECT_LE(dgf.extent(r), dgf.extent(r - 1));
+    }
+  }
+  EXPECT_EQ(size_t(nk), total);
+  for (size_t k = 0; k < size_t(nk); ++k) {
+    int r = dgf.owner(k);
+    EXPECT_LE(dgf.offset(r), k);
+    EXPECT_LT(k, dgf.offset(r) + dgf.extent(r));
+  }
+  EXPECT_EQ(size_t(dgf.local().mesh2().extent()), dgf.local_extent());
+}
+
+TEST_F(DistributedGFTest, ScatterGather) {
+  const int root = comm.size() - 1;
+  dist_gf_type dgf(comm, comm.rank() == root ? gf : gf_type(), root);
+  for (g::matsubara_index w(0); w < nfreq; ++w)
+    for (g::index k(0); k < int(dgf.local_extent()); ++k)
+      for (g::index i(0); i < norb; ++i)
+        ASSERT_EQ(value(w(), k() + dgf.local_offset(), i()), dgf.local()(w, k, i));
+
+  gf_type gathered = dgf.gather(root);
+  if (comm.rank() == root) {
+    EXPECT_EQ(gf, gathered);
+  } else {
+    EXPECT_TRUE(gathered.is_empty());
+  }
+  EXPECT_EQ(gf, dgf.allgather());
+}
+
+TEST_F(DistributedGFTest, ScatterMismatchedMeshes) {
+  gf_type other(g::matsubara_positive_mesh(10.0, nfreq), g::index_mesh(nk), g::index_mesh(norb));
+  dist_gf_type dgf(comm, gf.meshes());
+  EXPECT_THROW(dgf.scatter(other, 0), std::invalid_argument);
+}
+
+TEST_F(DistributedGFTest, Reduce) {
+  dist_gf_type dgf(comm, gf.meshes());
+  gf_type contribution = gf;
+  contribution *= double(comm.rank() + 1);
+  dgf.reduce(contribution);
+  const double factor = comm.size() * (comm.size() + 1) / 2.;
+  for (g::matsubara_index w(0); w < nfreq; ++w)
+    for (g::index k(0); k < int(dgf.local_extent()); ++k)
+      for (g::index i(0); i < norb; ++i)
+        ASSERT_EQ(factor * value(w(), k() + dgf.local_offset(), i()), dgf.local()(w, k, i));
+}
+
+TEST_F(DistributedGFTest, SaveLoad) {
+  std::string filename;
+  if (comm.rank() == 0)
+    filename = alps::testing::temporary_filename("distributed_gf.h5.");
+  alps::mpi::broadcast(comm, filename, 0);
+
+  dist_gf_type dgf(comm, gf, 0);
+  dgf.save(filename, "/gf");
+
+  // readable as a regular GF
+  {
+    alps::hdf5::archive ar(filename, "r");
+    gf_type loaded;
+    loaded.load(ar, "/gf");
+    EXPECT_EQ(gf, loaded);
+  }
+  // and as a GF distributed along another mesh
+  {
+    alps::hdf5::archive ar(filename, "r");
+    g::distributed_gf<std::complex<double>, 0, g::matsubara_positive_mesh, g::index_mesh, g::index_mesh>
+        other(comm);
+    other.load(ar, "/gf");
+    EXPECT_EQ(gf.meshes(), other.meshes());
+    EXPECT_EQ(gf, other.allgather());
+  }
+  comm.barrier();
+  if (comm.rank() == 0)
+    std::remove(filename.c_str());
+}
+
+int main(int argc, char** argv)
+{
+  alps::mpi::environment env(argc, argv);
+  alps::gtest_par_xml_output tweak;
+  tweak(alps::mpi::communicator().rank(), argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
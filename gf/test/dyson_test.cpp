@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include "gtest/gtest.h"
+#include <alps/gf/gf.hpp>
+#include "alps/gf/dyson.hpp"
+
+namespace g = alps::gf;
+
+typedef g::greenf<std::complex<double>, g::matsubara_positive_mesh, g::momentum_index_mesh, g::index_mesh, g::index_mesh> gk_type;
+typedef g::greenf<double, g::momentum_index_mesh, g::index_mesh, g::index_mesh> hk_type;
+
+/// Checks the batched Dyson solver against the inverse of each orbital matrix, for fixed-size and generic kernels
+class DysonTest : public ::testing::TestWithParam<int>
+{
+public:
+  const int nfreq, nk, norb;
+  const double mu;
+  g::matsubara_positive_mesh mesh_w;
+  g::momentum_index_mesh mesh_k;
+  g::index_mesh mesh_orb;
+  gk_type sigma;
+  hk_type hk;
+
+  DysonTest(): nfreq(5), nk(3), norb(GetParam()), mu(0.3),
+      mesh_w(10.0, nfreq), mesh_k(nk, 1), mesh_orb(norb),
+      sigma(mesh_w, mesh_k, mesh_orb, mesh_orb), hk(mesh_k, mesh_orb, mesh_orb) {
+    for (g::momentum_index k(0); k<nk; ++k) {
+      for (g::index a(0); a<norb; ++a)
+        for (g::index b(0); b<norb; ++b) {
+          hk(k, a, b) = std::cos(1.+k()+a()+b()) + (a() == b() ? 2.*a() : 0.);
+          for (g::matsubara_index w(0); w<nfreq; ++w)
+            sigma(w, k, a, b) = std::complex<double>(0.1*std::sin(w()+2.*k()-a()+3.*b()), -0.2*(a() == b())/(w()+1.));
+        }
+    }
+  }
+};
+
+TEST_P(DysonTest, MatchesBlockInverse) {
+  gk_type gk(mesh_w, mesh_k, mesh_orb, mesh_orb);
+  alps::thread_pool pool(3);
+  g::solve_dyson(gk, sigma, hk, mu, pool);
+  for (g::matsubara_index w(0); w<nfreq; ++w)
+    for (g::momentum_index k(0); k<nk; ++k) {
+      alps::numerics::tensor<std::complex<double>, 2> m(norb, norb);
+      for (int a=0; a<norb; ++a)
+        for (int b=0; b<norb; ++b)
+          m(a, b) = std::complex<double>(mu, mesh_w.points()[w()])*double(a == b)
+                    - hk(k, g::index(a), g::index(b)) - sigma(w, k, g::index(a), g::index(b));
+      alps::numerics::tensor<std::complex<double>, 2> inv = m.inverse();
+      for (int a=0; a<norb; ++a)
+        for (int b=0; b<norb; ++b)
+          EXPECT_NEAR(0, std::abs(inv(a, b) - gk(w, k, g::index(a), g::index(b))), 1e-12);
+    }
+
+  // in place, and back
+  g::solve_dyson(sigma, sigma, hk, mu, pool);
+  EXPECT_NEAR(0, (sigma - gk).norm(), 1e-12);
+  g::invert_orbital_matrices(gk, pool);
+  g::invert_orbital_matrices(gk);
+  EXPECT_NEAR(0, (sigma - gk).norm(), 1e-10);
+}
+
+INSTANTIATE_TEST_CASE_P(OrbitalCounts, DysonTest, ::testing::Values(1, 2, 3, 5, 8, 11));
+
+TEST(Dyson, MismatchedMeshes) {
+  g::matsubara_positive_mesh mesh_w(10.0, 4);
+  g::momentum_index_mesh mesh_k(2, 1);
+  gk_type gk(mesh_w, mesh_k, g::index_mesh(2), g::index_mesh(2));
+  hk_type hk(mesh_k, g::index_mesh(3), g::index_mesh(3));
+  EXPECT_THROW(g::solve_dyson(gk, gk, hk, 0.), std::invalid_argument);
+
+  g::greenf<std::complex<double>, g::index_mesh, g::index_mesh> rect(g::index_mesh(2), g::index_mesh(3));
+  EXPECT_THROW(g::invert_orbital_matrices(rect), std::invalid_argument);
+}
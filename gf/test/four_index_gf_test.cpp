@@ -112,6 +112,33 @@ TEST_F(FourIndexGFTest,saveload)
     //boost::filesystem::remove("g5.h5");
 }
 
+TEST_F(FourIndexGFTest,loadslice)
+{
+    namespace g=alps::gf;
+    for (int w=0; w<nfreq; ++w)
+        for (int i=0; i<nsites; ++i)
+            for (int j=0; j<nsites; ++j)
+                for (int s=0; s<nspins; ++s)
+                    gf(g::matsubara_index(w),g::momentum_index(i), g::momentum_index(j), g::index(s))=std::complex<double>(w+10*i, j+10*s);
+    {
+        alps::hdf5::archive oar("gf_4i_loadslice.h5","w");
+        gf.save(oar,"/gf");
+    }
+    alps::hdf5::archive iar("gf_4i_loadslice.h5");
+    auto slice=gf_type::load_slice(iar, "/gf", g::all, g::index_range(2), g::index_range(1,2), g::all);
+    EXPECT_EQ(gf.mesh1(), slice.mesh1());
+    EXPECT_EQ(1, slice.mesh2().extent());
+    EXPECT_EQ(2, slice.mesh3().extent());
+    EXPECT_EQ(gf.mesh4(), slice.mesh4());
+    for (int w=0; w<nfreq; ++w)
+        for (int j=0; j<2; ++j)
+            for (int s=0; s<nspins; ++s)
+                EXPECT_EQ(gf(g::matsubara_index(w),g::momentum_index(2), g::momentum_index(j+1), g::index(s)),
+                          slice(g::matsubara_index(w),g::index(0), g::index(j), g::index(s)));
+
+    EXPECT_THROW(gf_type::load_slice(iar, "/gf", g::all, g::index_range(nsites), g::all, g::all), alps::hdf5::archive_error);
+}
+
 TEST_F(FourIndexGFTest,saveloadstream)
 {
     namespace g=alps::gf;
@@ -110,3 +110,117 @@ TEST_F(AtomicFourierTestGF,MatsubaraToTimeFourierAwayHalfFilling){
 
   EXPECT_NEAR((g_tau-g_tau_2).norm(), 0, 1.e-7);
 }
+
+TEST_F(AtomicFourierTestGF,TimeToMatsubaraFourier){
+  mu=0;
+  U=0.2;
+  initialize_as_atomic_itime(g_tau);
+  density_matrix_type c1=density_matrix_type(alps::gf::index_mesh(2));
+  density_matrix_type c2=density_matrix_type(alps::gf::index_mesh(2));
+  density_matrix_type c3=density_matrix_type(alps::gf::index_mesh(2));
+  for(alps::gf::index i(0); i<2; ++i){
+    c1(i)=1;
+    c2(i)=U*density()-mu;
+    c3(i)=(1-density())*mu*mu+density()*(mu-U)*(mu-U);
+  }
+  g_tau.set_tail(1,c1);
+  g_tau.set_tail(2,c2);
+  g_tau.set_tail(3,c3);
+
+  fourier_time_to_frequency(g_tau, g_omega);
+
+  initialize_as_atomic_matsubara(gf2);
+  EXPECT_NEAR((g_omega-gf2).norm(), 0, 1.e-8);
+  EXPECT_EQ(3, g_omega.max_tail_order());
+  EXPECT_EQ(c2(alps::gf::index(1)), g_omega.tail(2)(alps::gf::index(1)));
+}
+TEST_F(AtomicFourierTestGF,TimeToMatsubaraFourierPositiveNegative){
+  initialize_as_atomic_itime(g_tau);
+  density_matrix_type c1=density_matrix_type(alps::gf::index_mesh(2));
+  c1.initialize();
+  c1(alps::gf::index(0))=1;
+  c1(alps::gf::index(1))=1;
+  g_tau.set_tail(1,c1);
+
+  typedef alps::gf::two_index_gf<std::complex<double>, alps::gf::matsubara_pn_mesh, alps::gf::index_mesh> pn_gf_type;
+  alps::gf::two_index_gf_with_tail<pn_gf_type, density_matrix_type> g_pn(pn_gf_type(alps::gf::matsubara_pn_mesh(beta,2*nfreq),
+                                                                                   alps::gf::index_mesh(2)));
+  fourier_time_to_frequency(g_tau, g_pn);
+
+  //only the first tail order is subtracted, so the spline error decays as 1/wn^2 instead of 1/wn^4
+  for(alps::gf::matsubara_pn_mesh::index_type n(0);n<2*nfreq;++n){
+    int m=n()-nfreq;
+    std::complex<double> exact=(m>=0)?atomic_matsubara(m):std::conj(atomic_matsubara(-m-1));
+    EXPECT_NEAR(std::abs(g_pn(n,alps::gf::index(0))-exact), 0, 1.e-5);
+  }
+}
+TEST_F(AtomicFourierTestGF,FourierRoundTrip){
+  mu=0;
+  U=0.2;
+  initialize_as_atomic_matsubara(g_omega);
+  density_matrix_type c1=density_matrix_type(alps::gf::index_mesh(2));
+  density_matrix_type c2=density_matrix_type(alps::gf::index_mesh(2));
+  for(alps::gf::index i(0); i<2; ++i){
+    c1(i)=1;
+    c2(i)=U*density()-mu;
+  }
+  g_omega.set_tail(1,c1);
+  g_omega.set_tail(2,c2);
+  fourier_frequency_to_time(g_omega, g_tau);
+  g_tau.set_tail(1,c1);
+  g_tau.set_tail(2,c2);
+  fourier_time_to_frequency(g_tau, gf2);
+
+  EXPECT_NEAR((g_omega-gf2).norm(), 0, 1.e-6);
+}
+
+namespace {
+  // direct summation of the omega -> tau kernel for `nother` interleaved vectors
+  std::vector<double> direct_transform(const std::vector<std::complex<double> > &input, const std::vector<double> &omega,
+                                       const std::vector<double> &tau, size_t nother, double beta) {
+    std::vector<double> output(tau.size()*nother, 0.);
+    for (size_t t=0; t<tau.size(); ++t)
+      for (size_t k=0; k<omega.size(); ++k)
+        for (size_t i=0; i<nother; ++i)
+          output[t*nother+i] += 2/beta*(cos(omega[k]*tau[t])*input[k*nother+i].real() + sin(omega[k]*tau[t])*input[k*nother+i].imag());
+    return output;
+  }
+}
+
+TEST(FourierKernel, FFTMatchesDirectSum){
+  const double beta=5;
+  const size_t nfreq=37, nother=3;
+  for (int zeta=0; zeta<2; ++zeta) {
+    // fewer tau intervals than frequencies exercises the folding of aliased frequencies
+    for (int ntau=5; ntau<=2*int(nfreq); ntau+=ntau) {
+      std::vector<double> omega(nfreq), tau(ntau+1);
+      for (size_t n=0; n<nfreq; ++n) omega[n]=(2.*n+zeta)*M_PI/beta;
+      for (int j=0; j<=ntau; ++j) tau[j]=j*beta/ntau;
+      std::vector<std::complex<double> > input(nfreq*nother);
+      for (size_t n=0; n<input.size(); ++n) input[n]=std::complex<double>(std::sin(0.3*n), 1./(n+1.));
+
+      ASSERT_EQ(ntau, alps::gf::detail::uniform_itime_intervals(tau, beta));
+      ASSERT_EQ(zeta, alps::gf::detail::positive_matsubara_statistics(omega, beta));
+      std::vector<double> output(tau.size()*nother);
+      alps::gf::detail::transform_no_tail(&input[0], omega, &output[0], tau, nother, beta);
+      std::vector<double> reference=direct_transform(input, omega, tau, nother, beta);
+      for (size_t i=0; i<output.size(); ++i) EXPECT_NEAR(reference[i], output[i], 1e-10);
+    }
+  }
+}
+
+TEST(FourierKernel, NonUniformMatchesDirectSum){
+  const double beta=5;
+  const size_t nfreq=20, nother=2;
+  std::vector<double> omega(nfreq), tau;
+  for (size_t n=0; n<nfreq; ++n) omega[n]=(2.*n+1)*M_PI/beta;
+  for (int j=0; j<=10; ++j) tau.push_back(beta*(j/10.)*(j/10.));
+  ASSERT_EQ(0, alps::gf::detail::uniform_itime_intervals(tau, beta));
+  std::vector<std::complex<double> > input(nfreq*nother);
+  for (size_t n=0; n<input.size(); ++n) input[n]=std::complex<double>(1./(n+2.), std::cos(0.7*n));
+
+  std::vector<double> output(tau.size()*nother);
+  alps::gf::detail::transform_no_tail(&input[0], omega, &output[0], tau, nother, beta);
+  std::vector<double> reference=direct_transform(input, omega, tau, nother, beta);
+  for (size_t i=0; i<output.size(); ++i) EXPECT_NEAR(reference[i], output[i], 1e-10);
+}
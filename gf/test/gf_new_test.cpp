@@ -119,6 +119,39 @@ TEST(GreensFunction, BasicArithmetics2DMixedTypes) {
 }
 
 
+TEST(GreensFunction, LazyArithmetics) {
+  alps::gf::matsubara_positive_mesh x(100, 10);
+  alps::gf::index_mesh y(4);
+  typedef greenf<std::complex<double>, alps::gf::matsubara_positive_mesh, alps::gf::index_mesh> gf_type;
+  greenf<double, alps::gf::matsubara_positive_mesh, alps::gf::index_mesh> g0(x, y);
+  gf_type sigma(x, y);
+  gf_type delta(x, y);
+  for (alps::gf::matsubara_positive_mesh::index_type w(0); w < x.extent(); ++w) {
+    for (alps::gf::index_mesh::index_type i(0); i < y.extent(); ++i) {
+      g0(w, i) = 1.0 * i() + w();
+      sigma(w, i) = std::complex<double>(i(), w());
+      delta(w, i) = std::complex<double>(w(), 1.0);
+    }
+  }
+  const double a = 0.5;
+  const std::complex<double> b(0.0, 2.0);
+  gf_type g = lazy(g0) + a * lazy(sigma) - b * lazy(delta);
+  gf_type g2;
+  g2 = lazy(g) / 2;
+  g2 += -lazy(delta);
+  for (alps::gf::matsubara_positive_mesh::index_type w(0); w < x.extent(); ++w) {
+    for (alps::gf::index_mesh::index_type i(0); i < y.extent(); ++i) {
+      std::complex<double> expected = g0(w, i) + a * sigma(w, i) - b * delta(w, i);
+      ASSERT_NEAR(0.0, std::abs(expected - g(w, i)), 1e-12);
+      ASSERT_NEAR(0.0, std::abs(expected / 2.0 - delta(w, i) - g2(w, i)), 1e-12);
+    }
+  }
+  ASSERT_EQ(g.meshes(), g2.meshes());
+  gf_type other(alps::gf::matsubara_positive_mesh(200, 10), y);
+  EXPECT_THROW(lazy(g) + lazy(other), std::invalid_argument);
+  EXPECT_THROW(g += lazy(other), std::invalid_argument);
+}
+
 TEST(GreensFunction, BasicArithmetics2DScaling) {
   alps::gf::matsubara_positive_mesh x(100, 10);
   alps::gf::index_mesh y(10);
@@ -394,3 +427,20 @@ TEST(GreensFunction, ConstructorTests){
     }
   }
 }
+
+TEST(GreensFunction, PermuteMeshes) {
+  alps::gf::matsubara_positive_mesh w(5.0, 7);
+  alps::gf::momentum_index_mesh k(5, 1);
+  alps::gf::index_mesh a(2);
+  alps::gf::greenf<std::complex<double>, alps::gf::matsubara_positive_mesh, alps::gf::momentum_index_mesh, alps::gf::index_mesh, alps::gf::index_mesh> G(w, k, a, a);
+  for (size_t i = 0; i < G.data().size(); ++i) G.data().data()[i] = std::complex<double>(i, -double(i));
+  alps::gf::greenf<std::complex<double>, alps::gf::momentum_index_mesh, alps::gf::matsubara_positive_mesh, alps::gf::index_mesh, alps::gf::index_mesh> Gk = alps::gf::permute<1, 0, 2, 3>(G);
+  EXPECT_EQ(k, Gk.mesh1());
+  EXPECT_EQ(w, Gk.mesh2());
+  for (alps::gf::matsubara_index iw(0); iw < 7; ++iw)
+    for (alps::gf::momentum_index ik(0); ik < 5; ++ik)
+      for (alps::gf::index i(0); i < 2; ++i)
+        for (alps::gf::index j(0); j < 2; ++j)
+          ASSERT_EQ(G(iw, ik, i, j), Gk(ik, iw, i, j));
+  EXPECT_EQ(G, (alps::gf::permute<1, 0, 2, 3>(Gk)));
+}
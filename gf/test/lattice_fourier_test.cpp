@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include "gtest/gtest.h"
+#include <alps/gf/gf.hpp>
+#include "alps/gf/lattice_fourier.hpp"
+
+namespace g = alps::gf;
+
+/// Two-dimensional lattice of 4x3 sites with spacing 0.5, in a shuffled order, and a random G(omega, R, orbital)
+class LatticeFourierTest : public ::testing::Test
+{
+public:
+  typedef g::greenf<std::complex<double>, g::matsubara_positive_mesh, g::real_space_index_mesh, g::index_mesh> r_gf_type;
+  typedef g::greenf<std::complex<double>, g::matsubara_positive_mesh, g::momentum_index_mesh, g::index_mesh> k_gf_type;
+  const int nx, ny, nfreq, norb;
+  g::momentum_index_mesh::container_type rpts, kpts;
+  r_gf_type g_r;
+
+  LatticeFourierTest(): nx(4), ny(3), nfreq(3), norb(2),
+      rpts(boost::extents[nx*ny][2]), kpts(boost::extents[nx*ny][2]) {
+    for (int s=0; s<nx*ny; ++s) {
+      int p = (5*s + 3)%(nx*ny);
+      int q = (7*s + 1)%(nx*ny);
+      // R = 0.5*(x, y) + (1, -1), k on the Brillouin zone (-pi/a, pi/a]
+      rpts[p][0] = 0.5*(s/ny) + 1;
+      rpts[p][1] = 0.5*(s%ny) - 1;
+      kpts[q][0] = 2*M_PI/(0.5*nx)*(s/ny - nx/2);
+      kpts[q][1] = 2*M_PI/(0.5*ny)*(s%ny);
+    }
+    g_r = r_gf_type(g::matsubara_positive_mesh(5.0, nfreq), g::real_space_index_mesh(rpts), g::index_mesh(norb));
+    for (g::matsubara_index w(0); w<nfreq; ++w)
+      for (g::real_space_index_mesh::index_type r(0); r<nx*ny; ++r)
+        for (g::index i(0); i<norb; ++i)
+          g_r(w, r, i) = std::complex<double>(std::sin(1.+w()+3*r()+7*i()), std::cos(2.*w()-r()+i()));
+  }
+
+  /// direct sum G(k) = \sum_R e^{-ik.R} G(R)
+  std::complex<double> direct(const g::momentum_index_mesh::container_type &k, int q, int w, int i) {
+    std::complex<double> sum = 0;
+    for (int p=0; p<nx*ny; ++p) {
+      double kr = k[q][0]*rpts[p][0] + k[q][1]*rpts[p][1];
+      sum += std::polar(1., -kr)*g_r(g::matsubara_index(w), g::real_space_index_mesh::index_type(p), g::index(i));
+    }
+    return sum;
+  }
+};
+
+TEST_F(LatticeFourierTest, GridMatchesDirectSum) {
+  EXPECT_TRUE(g::lattice_fourier_plan(g::momentum_index_mesh(kpts), g::real_space_index_mesh(rpts))->is_grid());
+  k_gf_type g_k(g::matsubara_positive_mesh(5.0, nfreq), g::momentum_index_mesh(kpts), g::index_mesh(norb));
+  g::real_space_to_momentum(g_r, g_k);
+  for (int w=0; w<nfreq; ++w)
+    for (int q=0; q<nx*ny; ++q)
+      for (int i=0; i<norb; ++i) {
+        std::complex<double> value = g_k(g::matsubara_index(w), g::momentum_index_mesh::index_type(q), g::index(i));
+        EXPECT_NEAR(0, std::abs(direct(kpts, q, w, i) - value), 1e-12);
+      }
+
+  r_gf_type back(g_r.mesh1(), g_r.mesh2(), g_r.mesh3());
+  g::momentum_to_real_space(g_k, back);
+  EXPECT_NEAR(0, (g_r - back).norm(), 1e-12);
+}
+
+TEST_F(LatticeFourierTest, IrregularFallback) {
+  // a path through the Brillouin zone is not a grid
+  g::momentum_index_mesh::container_type path(boost::extents[5][2]);
+  for (int q=0; q<5; ++q) {
+    path[q][0] = 0.3*q;
+    path[q][1] = 0.1*q*q;
+  }
+  EXPECT_FALSE(g::lattice_fourier_plan(g::momentum_index_mesh(path), g::real_space_index_mesh(rpts))->is_grid());
+  k_gf_type g_k(g::matsubara_positive_mesh(5.0, nfreq), g::momentum_index_mesh(path), g::index_mesh(norb));
+  g::real_space_to_momentum(g_r, g_k);
+  for (int w=0; w<nfreq; ++w)
+    for (int q=0; q<5; ++q)
+      for (int i=0; i<norb; ++i) {
+        std::complex<double> value = g_k(g::matsubara_index(w), g::momentum_index_mesh::index_type(q), g::index(i));
+        EXPECT_NEAR(0, std::abs(direct(path, q, w, i) - value), 1e-12);
+      }
+}
+
+TEST_F(LatticeFourierTest, RealInputFirstMesh) {
+  g::real_space_index_mesh rmesh(rpts);
+  g::momentum_index_mesh kmesh(kpts);
+  g::greenf<double, g::real_space_index_mesh, g::index_mesh> h_r(rmesh, g::index_mesh(norb));
+  for (g::real_space_index_mesh::index_type r(0); r<nx*ny; ++r)
+    for (g::index i(0); i<norb; ++i)
+      h_r(r, i) = 0.5*r() - i();
+  g::greenf<std::complex<double>, g::momentum_index_mesh, g::index_mesh> h_k(kmesh, g::index_mesh(norb));
+  g::real_space_to_momentum(h_r, h_k);
+  g::greenf<std::complex<double>, g::real_space_index_mesh, g::index_mesh> back(h_r.mesh1(), h_r.mesh2());
+  g::momentum_to_real_space(h_k, back);
+  for (g::real_space_index_mesh::index_type r(0); r<nx*ny; ++r)
+    for (g::index i(0); i<norb; ++i)
+      EXPECT_NEAR(0, std::abs(back(r, i) - h_r(r, i)), 1e-12);
+}
+
+TEST_F(LatticeFourierTest, MismatchedMeshes) {
+  k_gf_type g_k(g::matsubara_positive_mesh(5.0, nfreq), g::momentum_index_mesh(kpts), g::index_mesh(norb + 1));
+  EXPECT_THROW(g::real_space_to_momentum(g_r, g_k), std::invalid_argument);
+  g::momentum_index_mesh::container_type k3(boost::extents[nx*ny][3]);
+  k_gf_type g_k3(g::matsubara_positive_mesh(5.0, nfreq), g::momentum_index_mesh(k3), g::index_mesh(norb));
+  EXPECT_THROW(g::real_space_to_momentum(g_r, g_k3), std::invalid_argument);
+}
+
+TEST_F(LatticeFourierTest, PlanIsCachedByMeshIdentity) {
+  g::momentum_index_mesh kmesh(kpts);
+  g::real_space_index_mesh rmesh(rpts);
+  std::shared_ptr<const g::detail::lattice_fourier_plan> plan = g::lattice_fourier_plan(kmesh, rmesh);
+  // meshes constructed independently from equal points share the plan
+  EXPECT_EQ(plan.get(), g::lattice_fourier_plan(g::momentum_index_mesh(kpts), g::real_space_index_mesh(rpts)).get());
+  // points modified in place get their own plan
+  g::momentum_index_mesh shifted(kpts);
+  shifted.points()[0][0] += 0.1;
+  std::shared_ptr<const g::detail::lattice_fourier_plan> other = g::lattice_fourier_plan(shifted, rmesh);
+  EXPECT_NE(plan.get(), other.get());
+  EXPECT_FALSE(other->is_grid());
+  shifted.points()[0][0] -= 0.1;
+  EXPECT_EQ(plan.get(), g::lattice_fourier_plan(shifted, rmesh).get());
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include "gtest/gtest.h"
+#include <alps/gf/gf.hpp>
+#include "alps/gf/legendre.hpp"
+
+/// Single level with energy eps: G(tau) = -exp(-eps*tau)/(1+exp(-beta*eps)), G(iwn) = 1/(iwn-eps)
+class LegendreTransformTest : public ::testing::Test
+{
+public:
+  const double beta;
+  const double eps;
+  const int nl;
+  typedef alps::gf::two_index_gf<double, alps::gf::legendre_mesh, alps::gf::index_mesh> legendre_gf_type;
+  legendre_gf_type g_l;
+
+  LegendreTransformTest(): beta(10), eps(0.5), nl(40),
+      g_l(alps::gf::legendre_mesh(beta, nl), alps::gf::index_mesh(2)) {
+    // Simpson integration of the exact G(tau), accumulated as weighted samples
+    const int nsamples=200001;
+    std::vector<double> tau(nsamples), weight(nsamples);
+    for(int i=0; i<nsamples; ++i){
+      tau[i]=beta*i/(nsamples-1);
+      weight[i]=beta/(nsamples-1)/3*g_tau(tau[i])*((i==0 || i==nsamples-1)?1.:(i%2==1)?4.:2.);
+    }
+    std::vector<double> coeffs(nl, 0.);
+    alps::gf::legendre_accumulator acc(g_l.mesh1());
+    acc.add(&tau[0], &weight[0], nsamples, &coeffs[0]);
+    for(alps::gf::legendre_mesh::index_type l(0); l<nl; ++l){
+      g_l(l, alps::gf::index(0))=coeffs[l()];
+      g_l(l, alps::gf::index(1))=2*coeffs[l()];
+    }
+  }
+  double g_tau(double tau){
+    return -std::exp(-eps*tau)/(1+std::exp(-beta*eps));
+  }
+  std::complex<double> g_omega(double wn){
+    return 1./(std::complex<double>(0., wn)-eps);
+  }
+};
+
+TEST_F(LegendreTransformTest, ToItime){
+  typedef alps::gf::two_index_gf<double, alps::gf::itime_mesh, alps::gf::index_mesh> itime_gf_type;
+  itime_gf_type g(alps::gf::itime_mesh(beta, 101), alps::gf::index_mesh(2));
+  legendre_to_itime(g_l, g);
+  for(alps::gf::itime_mesh::index_type t(0); t<101; ++t){
+    double tau=g.mesh1().points()[t()];
+    EXPECT_NEAR(g_tau(tau), g(t, alps::gf::index(0)), 1e-6);
+    EXPECT_NEAR(2*g_tau(tau), g(t, alps::gf::index(1)), 1e-6);
+  }
+}
+
+TEST_F(LegendreTransformTest, ToMatsubara){
+  typedef alps::gf::two_index_gf<std::complex<double>, alps::gf::matsubara_pn_mesh, alps::gf::index_mesh> matsubara_gf_type;
+  matsubara_gf_type g(alps::gf::matsubara_pn_mesh(beta, 20), alps::gf::index_mesh(2));
+  legendre_to_matsubara(g_l, g);
+  for(alps::gf::matsubara_pn_mesh::index_type n(0); n<20; ++n){
+    double wn=g.mesh1().points()[n()];
+    EXPECT_NEAR(0, std::abs(g_omega(wn)-g(n, alps::gf::index(0))), 1e-6);
+    EXPECT_NEAR(0, std::abs(2.*g_omega(wn)-g(n, alps::gf::index(1))), 1e-6);
+  }
+}
+
+TEST_F(LegendreTransformTest, MismatchedMeshes){
+  typedef alps::gf::two_index_gf<std::complex<double>, alps::gf::matsubara_positive_mesh, alps::gf::index_mesh> matsubara_gf_type;
+  matsubara_gf_type g(alps::gf::matsubara_positive_mesh(2*beta, 20), alps::gf::index_mesh(2));
+  EXPECT_THROW(legendre_to_matsubara(g_l, g), std::invalid_argument);
+}
+
+TEST(LegendreTransform, MatricesAreCached){
+  alps::gf::legendre_mesh lmesh(5., 20);
+  alps::gf::matsubara_positive_mesh mmesh(5., 100);
+  EXPECT_EQ(alps::gf::legendre_matsubara_matrix(lmesh, mmesh).get(),
+            alps::gf::legendre_matsubara_matrix(alps::gf::legendre_mesh(5., 20), alps::gf::matsubara_positive_mesh(5., 100)).get());
+  EXPECT_NE(alps::gf::legendre_matsubara_matrix(lmesh, mmesh).get(),
+            alps::gf::legendre_matsubara_matrix(lmesh, alps::gf::matsubara_positive_mesh(5., 101)).get());
+  alps::gf::itime_mesh tmesh(5., 51);
+  EXPECT_EQ(alps::gf::legendre_itime_matrix(lmesh, tmesh).get(), alps::gf::legendre_itime_matrix(lmesh, tmesh).get());
+}
+
+TEST(LegendreTransform, CacheIsBounded){
+  alps::gf::detail::transform_cache<int, double> cache(2);
+  int made = 0;
+  auto make = [&made]() { return new double(++made); };
+  std::shared_ptr<const double> first = cache.get(1, make);
+  cache.get(2, make);
+  cache.get(1, make);
+  // 2 is the least recently used one and is dropped
+  cache.get(3, make);
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ(first.get(), cache.get(1, make).get());
+  EXPECT_EQ(3, made);
+  EXPECT_EQ(4., *cache.get(2, make));
+  cache.set_capacity(0);
+  EXPECT_EQ(0u, cache.size());
+  // the dropped matrices stay valid for their holders
+  EXPECT_EQ(1., *first);
+}
+
+TEST(LegendreTransform, BatchedAccumulation){
+  const double beta=3;
+  alps::gf::legendre_accumulator acc(beta, 30);
+  std::vector<double> tau, weight;
+  for(int i=0; i<13; ++i){
+    tau.push_back(beta*std::fmod(0.37*i, 1.));
+    weight.push_back(std::cos(i));
+  }
+  std::vector<double> single(acc.size(), 0.), batched(acc.size(), 0.);
+  for(size_t i=0; i<tau.size(); ++i) acc.add(tau[i], weight[i], &single[0]);
+  acc.add(&tau[0], &weight[0], tau.size(), &batched[0]);
+  for(int l=0; l<acc.size(); ++l) EXPECT_NEAR(single[l], batched[l], 1e-12);
+  // P_l(1)=1 and P_l(-1)=(-1)^l
+  std::vector<double> ends(acc.size(), 0.);
+  acc.add(0., 1., &ends[0]);
+  acc.add(beta, 1., &ends[0]);
+  for(int l=0; l<acc.size(); ++l) EXPECT_NEAR((l%2==0)?2*std::sqrt(2.*l+1):0., ends[l], 1e-12);
+}
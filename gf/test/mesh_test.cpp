@@ -464,6 +464,89 @@ TEST(Mesh,SwapNumericalMesh) {
     ASSERT_THROW(mesh1.swap(mesh3), std::runtime_error);
 }
 
+TEST(Mesh,NumericalMeshBasisEvaluator) {
+    const int n_section = 2, k = 2;
+    const double beta = 100.0;
+    typedef alps::gf::piecewise_polynomial<double> pp_type;
+
+    std::vector<double> section_edges(n_section+1);
+    section_edges[0] = -1.0;
+    section_edges[1] =  0.0;
+    section_edges[2] =  1.0;
+
+    std::vector<pp_type> basis_functions;
+    for (int l = 0; l < 3; ++l) {
+        pp_type p(k, section_edges);
+        for (int s = 0; s < n_section; ++s) {
+            p.coefficient(s, l) = 1.0 + s;
+        }
+        basis_functions.push_back(p);
+    }
+    alps::gf::numerical_mesh<double> mesh(beta, basis_functions, alps::gf::statistics::FERMIONIC);
+
+    alps::gf::piecewise_polynomial_evaluator<double> evaluator = mesh.basis_evaluator();
+    ASSERT_EQ(mesh.extent(), evaluator.num_functions());
+    std::vector<double> values(mesh.extent());
+    evaluator.compute_values(0.5, &values[0]);
+    for (int l = 0; l < mesh.extent(); ++l) {
+        EXPECT_NEAR(mesh.basis_function(l).compute_value(0.5), values[l], 1e-12);
+    }
+}
+
+TEST(Mesh,SharedMeshData) {
+    // copies and independently constructed equal meshes share their points
+    alps::gf::matsubara_positive_mesh m1(5.0, 100);
+    alps::gf::matsubara_positive_mesh m2(m1);
+    alps::gf::matsubara_positive_mesh m3(5.0, 100);
+    EXPECT_EQ(m1.points().data(), m2.points().data());
+    EXPECT_EQ(m1.points().data(), m3.points().data());
+    alps::gf::itime_mesh t1(5.0, 101), t2(5.0, 101);
+    EXPECT_EQ(t1.points().data(), t2.points().data());
+    alps::gf::itime_mesh t3(5.0, 11);
+    EXPECT_NE(t1.points().data(), t3.points().data());
+
+    // writing to the points of a momentum mesh unshares them
+    alps::gf::momentum_index_mesh::container_type points(boost::extents[4][2]);
+    for (int i = 0; i < 4; ++i) {
+        points[i][0] = i;
+        points[i][1] = -i;
+    }
+    const alps::gf::momentum_index_mesh k1(points), k2(points);
+    EXPECT_EQ(k1.points().data(), k2.points().data());
+    EXPECT_EQ(k1, k2);
+    alps::gf::momentum_index_mesh k3(k1);
+    EXPECT_EQ(k1.points().data(), static_cast<const alps::gf::momentum_index_mesh&>(k3).points().data());
+    k3.points()[1][1] = 7;
+    EXPECT_NE(k1, k3);
+    EXPECT_EQ(-1, k1.points()[1][1]);
+    k3.points()[1][1] = -1;
+    EXPECT_EQ(k1, k3);
+}
+
+TEST(Mesh,SharedNumericalMeshBasis) {
+    std::vector<double> section_edges(3);
+    section_edges[0] = -1.0;
+    section_edges[1] =  0.0;
+    section_edges[2] =  1.0;
+    std::vector<alps::gf::piecewise_polynomial<double> > basis1, basis2;
+    for (int l = 0; l < 2; ++l) {
+        alps::gf::piecewise_polynomial<double> p(2, section_edges);
+        p.coefficient(0, l) = 1.0;
+        basis1.push_back(p);
+        basis2.push_back(p);
+    }
+    basis2[1].coefficient(1, 2) = 3.0;
+
+    alps::gf::numerical_mesh<double> mesh1(10.0, basis1), mesh2(10.0, basis1), mesh3(10.0, basis2);
+    EXPECT_EQ(&mesh1.basis_function(0), &mesh2.basis_function(0));
+    EXPECT_TRUE(mesh1 == mesh2);
+    EXPECT_FALSE(mesh1 == mesh3);
+    alps::gf::numerical_mesh<double> mesh4;
+    mesh4 = mesh3;
+    EXPECT_TRUE(mesh4 == mesh3);
+    EXPECT_EQ(2, mesh4.extent());
+}
+
 TEST(Mesh,NumericalMeshSave) {
     const int n_section = 2, k = 3;
     const double beta = 100.0;
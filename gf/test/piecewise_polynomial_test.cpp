@@ -159,3 +159,78 @@ TEST(PiecewisePolynomial, Copy) {
     EXPECT_NO_THROW({p2 = p;});
     EXPECT_TRUE(p2 == p);
 }
+
+namespace {
+    // functions of different orders with non-trivial coefficients on uneven sections
+    std::vector<alps::gf::piecewise_polynomial<double> > make_test_functions(std::vector<double> &section_edges) {
+        const int n_section = 5;
+        section_edges.resize(n_section+1);
+        for (int s = 0; s < n_section + 1; ++s) {
+            section_edges[s] = -1.0 + 2.0 * (s * s) / (n_section * n_section);
+        }
+        std::vector<alps::gf::piecewise_polynomial<double> > functions;
+        for (int n = 0; n < 4; ++n) {
+            const int k = 1 + 2 * n;
+            boost::multi_array<double,2> coeff(boost::extents[n_section][k+1]);
+            for (int s = 0; s < n_section; ++s) {
+                for (int p = 0; p < k + 1; ++p) {
+                    coeff[s][p] = std::sin(1.0 + s + 3.0 * p + 7.0 * n);
+                }
+            }
+            functions.push_back(alps::gf::piecewise_polynomial<double>(n_section, section_edges, coeff));
+        }
+        return functions;
+    }
+}
+
+TEST(PiecewisePolynomial, ComputeValuesSorted) {
+    std::vector<double> section_edges;
+    std::vector<alps::gf::piecewise_polynomial<double> > functions = make_test_functions(section_edges);
+
+    // includes all section edges and repeated points
+    std::vector<double> x(section_edges);
+    for (int i = 0; i < 50; ++i) {
+        x.push_back(-1.0 + 2.0 * i / 49.0);
+    }
+    x.push_back(0.5);
+    std::sort(x.begin(), x.end());
+
+    for (std::size_t n = 0; n < functions.size(); ++n) {
+        std::vector<double> values(x.size());
+        functions[n].compute_values(&x[0], x.size(), &values[0]);
+        for (std::size_t i = 0; i < x.size(); ++i) {
+            EXPECT_NEAR(functions[n].compute_value(x[i]), values[i], 1e-12);
+        }
+    }
+
+    std::vector<double> unsorted(x.rbegin(), x.rend()), values(x.size());
+    EXPECT_THROW(functions[0].compute_values(&unsorted[0], unsorted.size(), &values[0]), std::runtime_error);
+    double outside[] = {0.0, 1.5};
+    EXPECT_THROW(functions[0].compute_values(outside, 2, &values[0]), std::runtime_error);
+}
+
+TEST(PiecewisePolynomial, Evaluator) {
+    std::vector<double> section_edges;
+    std::vector<alps::gf::piecewise_polynomial<double> > functions = make_test_functions(section_edges);
+    alps::gf::piecewise_polynomial_evaluator<double> evaluator(functions);
+    ASSERT_EQ(4, evaluator.num_functions());
+    ASSERT_EQ(7, evaluator.order());
+
+    std::vector<double> x;
+    for (int i = 0; i < 33; ++i) {
+        x.push_back(-1.0 + 2.0 * i / 32.0);
+    }
+    std::vector<double> values(x.size() * functions.size()), single(functions.size());
+    evaluator.compute_values(&x[0], x.size(), &values[0]);
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        evaluator.compute_values(x[i], &single[0]);
+        for (std::size_t n = 0; n < functions.size(); ++n) {
+            EXPECT_NEAR(functions[n].compute_value(x[i]), values[i * functions.size() + n], 1e-12);
+            EXPECT_NEAR(functions[n].compute_value(x[i]), single[n], 1e-12);
+        }
+    }
+
+    std::vector<alps::gf::piecewise_polynomial<double> > mismatched(functions);
+    mismatched.push_back(alps::gf::piecewise_polynomial<double>(1, std::vector<double>{-1.0, 1.0}));
+    EXPECT_THROW(alps::gf::piecewise_polynomial_evaluator<double> e(mismatched), std::runtime_error);
+}
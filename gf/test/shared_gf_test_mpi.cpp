@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/* Test of the GF shared within a node. Run with several ranks, e.g. ALPS_TEST_MPI_NPROC=3 */
+
+#include <gtest/gtest.h>
+
+#include <alps/gf/shared_gf.hpp>
+#include <alps/gf/mesh.hpp>
+#include <alps/utilities/gtest_par_xml_output.hpp>
+
+namespace g = alps::gf;
+
+class SharedGFTest : public ::testing::Test
+{
+public:
+  typedef g::greenf<std::complex<double>, g::matsubara_positive_mesh, g::index_mesh> gf_type;
+  typedef g::shared_gf<std::complex<double>, g::matsubara_positive_mesh, g::index_mesh> shared_gf_type;
+  alps::mpi::communicator comm;
+  const int nfreq;
+  const int nk;
+  gf_type gf;
+
+  SharedGFTest(): nfreq(6), nk(5), gf(g::matsubara_positive_mesh(5.0, nfreq), g::index_mesh(nk)) {
+    for (g::matsubara_index w(0); w < nfreq; ++w)
+      for (g::index k(0); k < nk; ++k)
+        gf(w, k) = std::complex<double>(10 * w() + k(), -w());
+  }
+};
+
+TEST_F(SharedGFTest, Broadcast) {
+  for (int root = 0; root < comm.size(); ++root) {
+    gf_type empty;
+    shared_gf_type shared(comm, comm.rank() == root ? gf : empty, root);
+    EXPECT_EQ(gf.meshes(), shared.meshes());
+    EXPECT_EQ(gf, gf_type(shared.view()));
+    EXPECT_EQ(gf(g::matsubara_index(3), g::index(2)), shared(g::matsubara_index(3), g::index(2)));
+  }
+}
+
+int main(int argc, char** argv)
+{
+  alps::mpi::environment env(argc, argv);
+  alps::gtest_par_xml_output tweak;
+  tweak(alps::mpi::communicator().rank(), argc, argv);
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
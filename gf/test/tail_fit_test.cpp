@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include "gtest/gtest.h"
+#include <alps/gf/gf.hpp>
+#include "alps/gf/tail_fit.hpp"
+
+namespace g = alps::gf;
+
+/// G(iw, i, j) = \sum_{m=1}^{4} c_m(i, j)/(iw)^m with real coefficients
+class TailFitTest : public ::testing::Test
+{
+public:
+  typedef g::greenf<std::complex<double>, g::matsubara_positive_mesh, g::index_mesh, g::index_mesh> omega_gf;
+  typedef g::greenf<double, g::index_mesh, g::index_mesh> tail_gf;
+  typedef g::greenf<std::complex<double>, g::index_mesh, g::index_mesh> complex_tail_gf;
+  const int nfreq, norb, max_order;
+  omega_gf gf;
+
+  TailFitTest(): nfreq(200), norb(3), max_order(4),
+      gf(g::matsubara_positive_mesh(10.0, nfreq), g::index_mesh(norb), g::index_mesh(norb)) {
+    for (g::matsubara_index w(0); w<nfreq; ++w) {
+      std::complex<double> iw(0., gf.mesh1().points()[w()]);
+      for (g::index i(0); i<norb; ++i)
+        for (g::index j(0); j<norb; ++j) {
+          std::complex<double> value = 0;
+          for (int m=1; m<=max_order; ++m) value += coefficient(m, i(), j())/std::pow(iw, m);
+          gf(w, i, j) = value;
+        }
+    }
+  }
+
+  static double coefficient(int m, int i, int j) {
+    return (i == j && m == 1) ? 1. : 0.5*std::sin(1.+m+2*i+3*j);
+  }
+};
+
+TEST_F(TailFitTest, RecoversCoefficients) {
+  g::gf_tail<omega_gf, tail_gf> fitted = g::fit_tail<tail_gf>(gf, 40, max_order);
+  EXPECT_EQ(1, fitted.min_tail_order());
+  EXPECT_EQ(max_order, fitted.max_tail_order());
+  EXPECT_EQ(gf, static_cast<const omega_gf &>(fitted));
+  for (int m=1; m<=max_order; ++m)
+    for (g::index i(0); i<norb; ++i)
+      for (g::index j(0); j<norb; ++j)
+        EXPECT_NEAR(coefficient(m, i(), j()), fitted.tail(m)(i, j), 1e-8) << "order " << m;
+}
+
+TEST_F(TailFitTest, ComplexCoefficients) {
+  g::gf_tail<omega_gf, complex_tail_gf> fitted = g::fit_tail<complex_tail_gf>(gf, 40, max_order);
+  for (int m=1; m<=max_order; ++m)
+    for (g::index i(0); i<norb; ++i)
+      for (g::index j(0); j<norb; ++j)
+        EXPECT_NEAR(0, std::abs(coefficient(m, i(), j()) - fitted.tail(m)(i, j)), 1e-6) << "order " << m;
+}
+
+TEST_F(TailFitTest, KnownMoments) {
+  g::gf_tail<omega_gf, tail_gf> g_tail(gf);
+  g::index_mesh orbitals(norb);
+  tail_gf c1(orbitals, orbitals);
+  for (g::index i(0); i<norb; ++i)
+    for (g::index j(0); j<norb; ++j)
+      c1(i, j) = coefficient(1, i(), j());
+  g_tail.set_tail(1, c1);
+  // the first moment is fixed, so 3 points are enough for the remaining three orders
+  g::fit_tail(g_tail, 3, max_order);
+  EXPECT_EQ(c1, g_tail.tail(1));
+  for (int m=2; m<=max_order; ++m)
+    for (g::index i(0); i<norb; ++i)
+      for (g::index j(0); j<norb; ++j)
+        EXPECT_NEAR(coefficient(m, i(), j()), g_tail.tail(m)(i, j), 1e-8) << "order " << m;
+}
+
+TEST_F(TailFitTest, InvalidArguments) {
+  EXPECT_THROW(g::fit_tail<tail_gf>(gf, 0, 3), std::invalid_argument);
+  EXPECT_THROW(g::fit_tail<tail_gf>(gf, nfreq + 1, 3), std::invalid_argument);
+  EXPECT_THROW(g::fit_tail<tail_gf>(gf, 1, 3), std::invalid_argument);
+  EXPECT_THROW(g::fit_tail<tail_gf>(gf, 10, 0), std::invalid_argument);
+}
+
+TEST_F(TailFitTest, RankDeficientOrders) {
+  g::gf_tail<omega_gf, tail_gf> g_tail(gf);
+  g::index_mesh orbitals(norb);
+  tail_gf c2(orbitals, orbitals);
+  g_tail.set_tail(2, c2);
+  // two points for two real coefficients, but orders 1 and 3 both only enter the imaginary part
+  EXPECT_THROW(g::fit_tail(g_tail, 1, 3), std::invalid_argument);
+  EXPECT_NO_THROW(g::fit_tail(g_tail, 2, 3));
+}
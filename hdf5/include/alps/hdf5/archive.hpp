@@ -19,6 +19,10 @@
 
 #endif
 
+#ifdef ALPS_HAVE_MPI
+#include <alps/utilities/mpi.hpp>
+#endif
+
 #include <map>
 #include <vector>
 #include <string>
@@ -91,6 +95,31 @@ namespace alps {
             };
         }
 
+        /// HDF5 archive.
+        ///
+        /// Concurrency contract (only relevant if ALPSCore is built without `ALPS_SINGLE_THREAD`):
+        ///  - An `archive` object must not be used by several threads at once; give each thread
+        ///    its own object (copying an archive is cheap and shares the open file).
+        ///  - Opening, copying and closing archives is always safe; the registry of open files
+        ///    is only locked for the duration of these calls.
+        ///  - If the HDF5 library is thread-safe (`H5_HAVE_THREADSAFE`), operations on different
+        ///    files do not block each other in ALPSCore; operations on the same writable file are
+        ///    serialized by a per-file lock, and files opened read-only are accessed without locking.
+        ///  - Otherwise the HDF5 library itself is not reentrant, and all operations are
+        ///    serialized by one process-wide lock.
+        ///  - Reopening a file for writing while other threads read it through a read-only archive
+        ///    is not supported.
+        ///
+        /// Parallel (MPI-IO) mode: an archive constructed with a communicator opens one file shared by
+        /// all ranks of the communicator. Opening, closing and every operation that writes (groups,
+        /// attributes, scalars and datasets) is collective and must be called by all ranks with the
+        /// same path and global `size`; each rank passes its own slice through `chunk` and `offset`
+        /// of `write(path, value, size, chunk, offset)`, and the slices are written in one collective
+        /// transfer. A rank without data passes a `chunk` containing a zero. Reads, including those of
+        /// the file metadata, are independent: any rank may read on its own.
+        /// This mode needs an HDF5 library built with parallel support, see `has_parallel_io()`.
+        template<typename T> class mapped_array;
+
         class archive {
             private:
                archive& operator=(const archive&) =delete; /* not implemented*/ // FIXME: ...or implement via `swap()`?
@@ -111,6 +140,10 @@ namespace alps {
                 archive(std::string const & filename, std::string mode = "r");
                 archive(std::string const & filename, int prop);
                 archive(archive const & arg);
+#ifdef ALPS_HAVE_MPI
+                /// open the file shared by all ranks of `comm` in parallel (MPI-IO) mode; collective
+                archive(std::string const & filename, alps::mpi::communicator const & comm, std::string mode = "r");
+#endif
 
                 virtual ~archive();
                 static void abort();
@@ -126,9 +159,18 @@ namespace alps {
                 /// open a new archive file
                 /// check that the archive is not already opened and construct archive.
                 void open(const std::string & filename, const std::string &mode = "r");
+#ifdef ALPS_HAVE_MPI
+                /// open a file shared by all ranks of `comm` in parallel (MPI-IO) mode; collective
+                void open(const std::string & filename, alps::mpi::communicator const & comm, const std::string &mode = "r");
+#endif
                 void close();
                 bool is_open();
 
+                /// true if the archive is open in parallel (MPI-IO) mode
+                bool is_parallel() const;
+                /// true if the HDF5 library ALPSCore is linked against supports MPI-IO
+                static bool has_parallel_io();
+
                 bool is_data(std::string path) const;
                 bool is_attribute(std::string path) const;
                 bool is_group(std::string path) const;
@@ -199,10 +241,18 @@ namespace alps {
 
                 template<typename T> auto is_datatype_impl(std::string path, T) const -> ONLY_NATIVE(T, bool);
 
+                /// read-only access to the dataset `path` of arithmetic type `T` (see alps/hdf5/mapped_array.hpp).
+                /// Contiguous, unfiltered datasets of a file opened read-only are memory-mapped if their element
+                /// type matches `T` exactly; all other datasets are read into memory.
+                template<typename T> auto map(std::string path) const -> ONLY_NATIVE(T, mapped_array<T>);
+
             private:
 
                 void construct(std::string const & filename, std::size_t props = READ);
-                std::string file_key(std::string filename, bool memory) const;
+#ifdef ALPS_HAVE_MPI
+                void construct(std::string const & filename, alps::mpi::communicator const & comm, std::size_t props);
+#endif
+                std::string file_key(std::string filename, bool memory, bool parallel = false) const;
 
                 std::string current_;
                 detail::archivecontext * context_;
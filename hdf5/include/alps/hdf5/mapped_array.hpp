@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#ifndef ALPS_HDF5_MAPPED_ARRAY_HPP
+#define ALPS_HDF5_MAPPED_ARRAY_HPP
+
+#include <alps/hdf5/archive.hpp>
+#include <alps/numeric/tensors/tensor_base.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <numeric>
+
+namespace alps {
+    namespace hdf5 {
+
+        /// Read-only contiguous array returned by `archive::map<T>(path)`.
+        ///
+        /// If the dataset could be memory-mapped (`is_mapped()`), the elements are paged in from
+        /// the file on first access; otherwise they were read into memory when the array was created.
+        /// Copies share the underlying mapping, which stays valid after the archive is closed.
+        template<typename T> class mapped_array {
+            public:
+                typedef T value_type;
+                typedef T const * const_iterator;
+
+                mapped_array()
+                    : data_(NULL), mapped_(false)
+                {}
+
+                mapped_array(std::shared_ptr<void const> holder, T const * data, std::vector<std::size_t> const & extent, bool mapped)
+                    : holder_(holder), data_(data), extent_(extent), mapped_(mapped)
+                {}
+
+                /// pointer to the first element, the data is stored in row-major order
+                T const * data() const { return data_; }
+                /// total number of elements
+                std::size_t size() const {
+                    return std::accumulate(extent_.begin(), extent_.end(), std::size_t(1), std::multiplies<std::size_t>());
+                }
+                /// shape of the dataset
+                std::vector<std::size_t> const & extent() const { return extent_; }
+                std::size_t dimensions() const { return extent_.size(); }
+                /// true if the data is backed by a memory mapping of the file
+                bool is_mapped() const { return mapped_; }
+
+                T const & operator[](std::size_t i) const { return data_[i]; }
+                const_iterator begin() const { return data_; }
+                const_iterator end() const { return data_ + size(); }
+
+                /// tensor view of the data; the view is only valid as long as this array (or a copy) is alive
+                template<std::size_t N> numerics::tensor_view<T const, N> view() const {
+                    if (N != extent_.size())
+                        throw wrong_dimensions("the dataset does not have the requested number of dimensions" + ALPS_STACKTRACE);
+                    std::array<std::size_t, N> shape{};
+                    std::copy(extent_.begin(), extent_.end(), shape.begin());
+                    return numerics::tensor_view<T const, N>(data_, shape);
+                }
+
+            private:
+                std::shared_ptr<void const> holder_;
+                T const * data_;
+                std::vector<std::size_t> extent_;
+                bool mapped_;
+        };
+    }
+}
+
+#endif
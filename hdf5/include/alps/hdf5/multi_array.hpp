@@ -13,6 +13,8 @@
 
 #include <boost/multi_array.hpp>
 
+#include <array>
+
 namespace alps {
     namespace hdf5 {
 
@@ -204,6 +206,32 @@ namespace alps {
                 }
             }
         }
+        /// load the block `[offset, offset + count)` of the array stored at `path`; `value` is resized to `count`
+        template<typename T, std::size_t N, typename A> void load_slice(
+              archive & ar
+            , std::string const & path
+            , boost::multi_array<T, N, A> & value
+            , std::array<std::size_t, N> const & offset
+            , std::array<std::size_t, N> const & count
+        ) {
+            if (ar.is_group(path))
+                throw invalid_path("invalid path");
+            if (!is_continuous<T>::value)
+                throw wrong_type("partial load is only implemented for continuous types" + ALPS_STACKTRACE);
+            if (ar.is_complex(path) != has_complex_elements<T>::value)
+                throw archive_error("no complex value in archive" + ALPS_STACKTRACE);
+            std::vector<std::size_t> size(ar.extent(path));
+            if (size.size() < N)
+                throw wrong_dimensions("dimensions mismatched." + ALPS_STACKTRACE);
+            value.resize(count);
+            if (value.num_elements() == 0)
+                return;
+            std::vector<std::size_t> chunk(count.begin(), count.end());
+            std::vector<std::size_t> local_offset(offset.begin(), offset.end());
+            std::copy(size.begin() + N, size.end(), std::back_inserter(chunk));
+            std::fill_n(std::back_inserter(local_offset), size.size() - N, 0);
+            ar.read(path, get_pointer(value), chunk, local_offset);
+        }
         // template<typename T, std::size_t N, typename A> void load(
         //       archive & ar
         //     , std::string const & path
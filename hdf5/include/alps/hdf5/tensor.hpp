@@ -107,6 +107,35 @@ namespace alps {
       }
     }
 
+    /**
+     * Load the block `[offset, offset + count)` of the tensor stored at `path` into `value`;
+     * only this block is read from the file. `value` is reshaped to `count`.
+     */
+    template<typename T, std::size_t N> void load_slice(
+      archive & ar
+      , std::string const & path
+      , numerics::detail::tensor_base<T, N, numerics::detail::data_storage<T> > & value
+      , std::array<std::size_t, N> const & offset
+      , std::array<std::size_t, N> const & count
+    ) {
+      if (ar.is_group(path))
+        throw invalid_path("invalid path");
+      if (ar.is_complex(path) != is_complex<T>::value)
+        throw archive_error("no complex value in archive" + ALPS_STACKTRACE);
+      std::vector<std::size_t> size(ar.extent(path));
+      if (size.size() < N)
+        throw wrong_dimensions("dimensions mismatched.");
+      value.reshape(count);
+      if (value.size() == 0)
+        return;
+      // trailing dimensions of the elements (e.g. real and imaginary part) are always read completely
+      std::vector<std::size_t> chunk(count.begin(), count.end());
+      std::vector<std::size_t> local_offset(offset.begin(), offset.end());
+      std::copy(size.begin() + N, size.end(), std::back_inserter(chunk));
+      std::fill_n(std::back_inserter(local_offset), size.size() - N, 0);
+      ar.read(path, get_pointer(value), chunk, local_offset);
+    }
+
   }
 }
 #endif //ALPSCORE_TENSOR_HPP_H
@@ -53,13 +53,19 @@ namespace alps {
             open(filename, mode);
         }
 
+#ifdef ALPS_HAVE_MPI
+        archive::archive(std::string const & filename, alps::mpi::communicator const & comm, std::string mode) : context_(NULL) {
+            open(filename, comm, mode);
+        }
+#endif
+
         archive::archive(archive const & arg)
             : current_(arg.current_)
             , context_(arg.context_)
         {
             if (context_ != NULL) {
                 ALPS_HDF5_LOCK_MUTEX
-                ++ref_cnt_[file_key(context_->filename_, context_->memory_)].second;
+                ++ref_cnt_[file_key(context_->filename_, context_->memory_, context_->parallel_)].second;
             }
         }
 
@@ -92,10 +98,13 @@ namespace alps {
         void archive::close() {
             if (context_ == NULL)
                 throw archive_closed("the archive is closed" + ALPS_STACKTRACE);
+            {
+                ALPS_HDF5_FAKE_THREADSAFETY
+                H5Fflush(context_->file_id_, H5F_SCOPE_GLOBAL);
+            }
             ALPS_HDF5_LOCK_MUTEX
-            H5Fflush(context_->file_id_, H5F_SCOPE_GLOBAL);
-            if (!--ref_cnt_[file_key(context_->filename_, context_->memory_)].second) {
-                ref_cnt_.erase(file_key(context_->filename_, context_->memory_));
+            if (!--ref_cnt_[file_key(context_->filename_, context_->memory_, context_->parallel_)].second) {
+                ref_cnt_.erase(file_key(context_->filename_, context_->memory_, context_->parallel_));
                 delete context_;
             }
             context_ = NULL;
@@ -115,10 +124,33 @@ namespace alps {
             );
         }
 
+#ifdef ALPS_HAVE_MPI
+        void archive::open(const std::string & filename, alps::mpi::communicator const & comm, const std::string &mode) {
+            if(is_open())
+                throw archive_opened("the archive '"+ filename + "' is already opened" + ALPS_STACKTRACE);
+            if (mode.find_first_not_of("rwa")!=std::string::npos)
+                throw wrong_mode("Incorrect mode '"+mode+"' opening file '"+filename+"' in parallel mode" + ALPS_STACKTRACE);
+
+            construct(filename, comm, mode.find_first_of("wa") == std::string::npos ? READ : WRITE);
+        }
+#endif
+
         bool archive::is_open() {
             return context_ != NULL;
         }
 
+        bool archive::is_parallel() const {
+            return context_ != NULL && context_->parallel_;
+        }
+
+        bool archive::has_parallel_io() {
+            #if defined(ALPS_HAVE_MPI) && defined(H5_HAVE_PARALLEL)
+                return true;
+            #else
+                return false;
+            #endif
+        }
+
         std::string const & archive::get_filename() const {
             if (context_ == NULL)
                 throw archive_closed("the archive is closed" + ALPS_STACKTRACE);
@@ -146,7 +178,6 @@ namespace alps {
         }
 
         void archive::set_context(std::string const & context) {
-            ALPS_HDF5_LOCK_MUTEX
             current_ = complete_path(context);
         }
 
@@ -434,8 +465,25 @@ namespace alps {
             }
         }
 
-        std::string archive::file_key(std::string filename, bool memory) const {
-            return (memory ? "m" : "_") + filename;
+#ifdef ALPS_HAVE_MPI
+        void archive::construct(std::string const & filename, alps::mpi::communicator const & comm, std::size_t props) {
+            ALPS_HDF5_LOCK_MUTEX
+            detail::check_error(H5Eset_auto2(H5E_DEFAULT, NULL, NULL));
+            if (ref_cnt_.find(file_key(filename, false, true)) == ref_cnt_.end())
+                ref_cnt_.insert(std::make_pair(
+                      file_key(filename, false, true)
+                    , std::make_pair(context_ = new detail::archivecontext(filename, props & WRITE, comm), 1)
+                ));
+            else {
+                context_ = ref_cnt_.find(file_key(filename, false, true))->second.first;
+                context_->grant(props & WRITE, false);
+                ++ref_cnt_.find(file_key(filename, false, true))->second.second;
+            }
+        }
+#endif
+
+        std::string archive::file_key(std::string filename, bool memory, bool parallel) const {
+            return (parallel ? "p" : (memory ? "m" : "_")) + filename;
         }
 
 #ifndef ALPS_SINGLE_THREAD
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include <memory>
+#include <vector>
+#include <numeric>
+#include <functional>
+#include <type_traits>
+
+#include <hdf5.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define ALPS_HDF5_HAVE_MMAP
+    #include <sys/mman.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#include <alps/hdf5/archive.hpp>
+#include <alps/hdf5/mapped_array.hpp>
+#include <alps/utilities/cast.hpp>
+
+#include "common.hpp"
+#include "archivecontext.hpp"
+
+namespace alps {
+    namespace hdf5 {
+        namespace detail {
+
+#ifdef ALPS_HDF5_HAVE_MMAP
+            struct munmap_deleter {
+                std::size_t length;
+                void operator()(void const * addr) const {
+                    munmap(const_cast<void *>(addr), length);
+                }
+            };
+#endif
+
+            // maps `bytes` bytes at `offset` of `filename` into memory; returns an empty pointer if this is not possible
+            inline std::shared_ptr<void const> map_file_region(std::string const & filename, haddr_t offset, std::size_t bytes) {
+#ifdef ALPS_HDF5_HAVE_MMAP
+                long page_size = sysconf(_SC_PAGESIZE);
+                if (page_size <= 0)
+                    return std::shared_ptr<void const>();
+                haddr_t page_offset = offset - offset % static_cast<haddr_t>(page_size);
+                std::size_t length = bytes + static_cast<std::size_t>(offset - page_offset);
+                int fd = ::open(filename.c_str(), O_RDONLY);
+                if (fd < 0)
+                    return std::shared_ptr<void const>();
+                void * addr = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(page_offset));
+                ::close(fd);
+                if (addr == MAP_FAILED)
+                    return std::shared_ptr<void const>();
+                munmap_deleter deleter = { length };
+                std::shared_ptr<void const> region(addr, deleter);
+                return std::shared_ptr<void const>(region, static_cast<char const *>(addr) + (offset - page_offset));
+#else
+                return std::shared_ptr<void const>();
+#endif
+            }
+
+            template<typename T> struct is_mappable
+                : public std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>
+            {};
+
+            template<typename T> typename std::enable_if<is_mappable<T>::value, std::shared_ptr<void const> >::type
+            map_dataset(archivecontext const & context, std::string const & path, std::size_t size) {
+                // the file must be a plain posix file that nobody writes to through this process
+                if (context.write_ || context.memory_ || context.parallel_ || size == 0)
+                    return std::shared_ptr<void const>();
+                {
+                    property_type fapl_id(H5Fget_access_plist(context.file_id_));
+                    if (H5Pget_driver(fapl_id) != H5FD_SEC2)
+                        return std::shared_ptr<void const>();
+                }
+                data_type data_id(H5Dopen2(context.file_id_, path.c_str(), H5P_DEFAULT));
+                {
+                    property_type dcpl_id(H5Dget_create_plist(data_id));
+                    if (H5Pget_layout(dcpl_id) != H5D_CONTIGUOUS || check_error(H5Pget_nfilters(dcpl_id)) != 0)
+                        return std::shared_ptr<void const>();
+                }
+                type_type type_id(H5Dget_type(data_id));
+                type_type native_id(get_native_type(T()));
+                if (check_error(H5Tequal(type_id, native_id)) <= 0)
+                    return std::shared_ptr<void const>();
+                haddr_t offset = H5Dget_offset(data_id);
+                if (offset == HADDR_UNDEF || offset % alignof(T) != 0)
+                    return std::shared_ptr<void const>();
+                return map_file_region(context.filename_, offset, size * sizeof(T));
+            }
+
+            template<typename T> typename std::enable_if<!is_mappable<T>::value, std::shared_ptr<void const> >::type
+            map_dataset(archivecontext const &, std::string const &, std::size_t) {
+                return std::shared_ptr<void const>();
+            }
+        }
+
+        template<typename T>
+        auto archive::map(std::string path) const -> ONLY_NATIVE(T, mapped_array<T>) {
+            ALPS_HDF5_FAKE_THREADSAFETY
+            if (context_ == NULL)
+                throw archive_closed("the archive is closed" + ALPS_STACKTRACE);
+            path = complete_path(path);
+            if (path.find_last_of('@') == std::string::npos ? !is_data(path) : !is_attribute(path))
+                throw path_not_found("the path does not exist: " + path + ALPS_STACKTRACE);
+            if (is_scalar(path))
+                throw wrong_type("scalar - vector conflict in path: " + path + ALPS_STACKTRACE);
+            std::vector<std::size_t> data_size = extent(path);
+            std::size_t size = std::accumulate(data_size.begin(), data_size.end(), std::size_t(1), std::multiplies<std::size_t>());
+            if (path.find_last_of('@') == std::string::npos) {
+                std::shared_ptr<void const> region = detail::map_dataset<T>(*context_, path, size);
+                if (region)
+                    return mapped_array<T>(region, static_cast<T const *>(region.get()), data_size, true);
+            }
+            std::shared_ptr<T> buffer(new T[size], std::default_delete<T[]>());
+            if (size > 0)
+                read(path, buffer.get(), data_size);
+            return mapped_array<T>(buffer, buffer.get(), data_size, false);
+        }
+        #define ALPS_HDF5_MAP(T) template mapped_array<T> archive::map<T>(std::string) const;
+        ALPS_FOREACH_NATIVE_HDF5_TYPE(ALPS_HDF5_MAP)
+    }
+}
@@ -5,6 +5,7 @@
  */
 
 #include <iostream>
+#include <algorithm>
 
 #include <hdf5.h>
 
@@ -184,7 +185,8 @@ namespace alps {
                         else {
                             detail::check_error(H5Pset_fill_time(prop_id, H5D_FILL_TIME_NEVER));
                             std::size_t dataset_size = std::accumulate(size.begin(), size.end(), std::size_t(sizeof( T )), std::multiplies<std::size_t>());
-                            if (dataset_size < ALPS_HDF5_SZIP_BLOCK_SIZE * sizeof( T ))
+                            // ranks of a parallel file write different slices, which compact datasets do not allow
+                            if (dataset_size < ALPS_HDF5_SZIP_BLOCK_SIZE * sizeof( T ) && !context_->parallel_)
                                 detail::check_error(H5Pset_layout(prop_id, H5D_COMPACT));
                             else if (dataset_size < (1ULL<<32))
                                 detail::check_error(H5Pset_layout(prop_id, H5D_CONTIGUOUS));
@@ -221,12 +223,18 @@ namespace alps {
                     detail::data_type raii_id(data_id);
                     detail::native_ptr_converter<T> converter(std::accumulate(chunk.begin(), chunk.end(), std::size_t(1), std::multiplies<std::size_t>()));
                     if (std::equal(chunk.begin(), chunk.end(), size.begin()))
-                        detail::check_error(H5Dwrite(raii_id, type_id, H5S_ALL, H5S_ALL, H5P_DEFAULT, converter.apply(value)));
-                    else {
+                        detail::check_error(H5Dwrite(raii_id, type_id, H5S_ALL, H5S_ALL, context_->xfer_id_, converter.apply(value)));
+                    else if (std::find(chunk.begin(), chunk.end(), std::size_t(0)) != chunk.end()) {
+                        // nothing to write, but the rank still has to take part in a collective transfer
+                        detail::space_type space_id(H5Dget_space(raii_id));
+                        detail::check_error(H5Sselect_none(space_id));
+                        detail::space_type mem_id(H5Scopy(space_id));
+                        detail::check_error(H5Dwrite(raii_id, type_id, mem_id, space_id, context_->xfer_id_, converter.apply(value)));
+                    } else {
                         detail::space_type space_id(H5Dget_space(raii_id));
                         detail::check_error(H5Sselect_hyperslab(space_id, H5S_SELECT_SET, &offset_hid.front(), NULL, &chunk_hid.front(), NULL));
                         detail::space_type mem_id(detail::space_type(H5Screate_simple(static_cast<int>(chunk_hid.size()), &chunk_hid.front(), NULL)));
-                        detail::check_error(H5Dwrite(raii_id, type_id, mem_id, space_id, H5P_DEFAULT, converter.apply(value)));
+                        detail::check_error(H5Dwrite(raii_id, type_id, mem_id, space_id, context_->xfer_id_, converter.apply(value)));
                     }
                 }
             } else {
@@ -26,16 +26,43 @@ namespace alps {
                 , memory_(memory)
                 , filename_(filename)
                 , filename_new_(filename)
+                , parallel_(false)
+                , xfer_id_(H5P_DEFAULT)
+#ifdef ALPS_HAVE_MPI
+                , comm_(MPI_COMM_NULL, alps::mpi::comm_attach)
+#endif
             {
                 construct();
             }
 
+#ifdef ALPS_HAVE_MPI
+            archivecontext::archivecontext(std::string const & filename, bool write, alps::mpi::communicator const & comm)
+                : compress_(false)
+                , write_(write)
+                , replace_(false)
+                , memory_(false)
+                , filename_(filename)
+                , filename_new_(filename)
+                , parallel_(true)
+                , xfer_id_(H5P_DEFAULT)
+                , comm_(comm, alps::mpi::comm_duplicate)
+            {
+                #ifndef H5_HAVE_PARALLEL
+                    throw archive_error("the hdf5 library has no MPI-IO support, cannot open " + filename + " in parallel mode" + ALPS_STACKTRACE);
+                #endif
+                construct();
+            }
+#endif
+
             archivecontext::~archivecontext() {
                 destruct(true);
             }
 
             void archivecontext::grant(bool write, bool replace) {
                 if (!write_ && (write || replace)) {
+                    #ifndef ALPS_SINGLE_THREAD
+                        boost::lock_guard<boost::recursive_mutex> guard(mutex_);
+                    #endif
                     destruct(false);
                     write_ = write || replace;
                     replace_ = !memory_ && replace;
@@ -89,15 +116,33 @@ namespace alps {
                     #else
                         #define ALPS_HDF5_FILE_ACCESS H5P_DEFAULT
                     #endif
+                    #if defined(ALPS_HAVE_MPI) && defined(H5_HAVE_PARALLEL)
+                        property_type mpio_access_id(H5Pcreate(H5P_FILE_ACCESS));
+                        if (parallel_) {
+                            #ifndef ALPS_HDF5_CLOSE_GREEDY
+                                check_error(H5Pset_fclose_degree(mpio_access_id, H5F_CLOSE_SEMI));
+                            #endif
+                            check_error(H5Pset_fapl_mpio(mpio_access_id, comm_, MPI_INFO_NULL));
+                            // metadata reads stay independent, so that a rank may read on its own
+                            #if H5_VERSION_GE(1,10,0)
+                                check_error(H5Pset_coll_metadata_write(mpio_access_id, true));
+                            #endif
+                            xfer_id_ = check_error(H5Pcreate(H5P_DATASET_XFER));
+                            check_error(H5Pset_dxpl_mpio(xfer_id_, H5FD_MPIO_COLLECTIVE));
+                        }
+                        hid_t file_access_id = parallel_ ? hid_t(mpio_access_id) : hid_t(ALPS_HDF5_FILE_ACCESS);
+                    #else
+                        hid_t file_access_id = ALPS_HDF5_FILE_ACCESS;
+                    #endif
                     if (write_) {
-                        if ((file_id_ = H5Fopen(filename_new_.c_str(), H5F_ACC_RDWR, ALPS_HDF5_FILE_ACCESS)) < 0) {
+                        if ((file_id_ = H5Fopen(filename_new_.c_str(), H5F_ACC_RDWR, file_access_id)) < 0) {
                             property_type fcrt_id(H5Pcreate(H5P_FILE_CREATE));
                             check_error(H5Pset_link_creation_order(fcrt_id, (H5P_CRT_ORDER_TRACKED | H5P_CRT_ORDER_INDEXED)));
                             check_error(H5Pset_attr_creation_order(fcrt_id, (H5P_CRT_ORDER_TRACKED | H5P_CRT_ORDER_INDEXED)));
-                            check_error(file_id_ = H5Fcreate(filename_new_.c_str(), H5F_ACC_TRUNC, fcrt_id, ALPS_HDF5_FILE_ACCESS));
+                            check_error(file_id_ = H5Fcreate(filename_new_.c_str(), H5F_ACC_TRUNC, fcrt_id, file_access_id));
                         }
                     } else
-                        check_error(file_id_ = H5Fopen(filename_new_.c_str(), H5F_ACC_RDONLY, ALPS_HDF5_FILE_ACCESS));
+                        check_error(file_id_ = H5Fopen(filename_new_.c_str(), H5F_ACC_RDONLY, file_access_id));
                     #ifdef ALPS_HDF5_CLOSE_GREEDY
                         #undef(ALPS_HDF5_FILE_ACCESS)
                     #endif
@@ -106,6 +151,10 @@ namespace alps {
 
             void archivecontext::destruct(bool abort) {
                 try {
+                    if (xfer_id_ != H5P_DEFAULT) {
+                        H5Pclose(xfer_id_);
+                        xfer_id_ = H5P_DEFAULT;
+                    }
                     H5Fflush(file_id_, H5F_SCOPE_GLOBAL);
                     #ifndef ALPS_HDF5_CLOSE_GREEDY
                         if (
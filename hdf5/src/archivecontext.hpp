@@ -8,10 +8,20 @@
 
 #include <string>
 
+#include <alps/hdf5/config.hpp>
+
 #include <boost/noncopyable.hpp>
 
+#ifndef ALPS_SINGLE_THREAD
+    #include <boost/thread.hpp>
+#endif
+
 #include <hdf5.h>
 
+#ifdef ALPS_HAVE_MPI
+    #include <alps/utilities/mpi.hpp>
+#endif
+
 namespace alps {
     namespace hdf5 {
         namespace detail {
@@ -19,6 +29,10 @@ namespace alps {
             struct archivecontext : boost::noncopyable {
 
                     archivecontext(std::string const & filename, bool write, bool replace, bool compress, bool memory);
+#ifdef ALPS_HAVE_MPI
+                    /// context of a file shared by all ranks of `comm` (MPI-IO); collective
+                    archivecontext(std::string const & filename, bool write, alps::mpi::communicator const & comm);
+#endif
                     ~archivecontext();
 
                     void grant(bool write, bool replace);
@@ -30,12 +44,46 @@ namespace alps {
                     std::string filename_;
                     std::string filename_new_;
                     hid_t file_id_;
+                    bool parallel_;
+                    /// dataset transfer properties: collective for parallel files, H5P_DEFAULT otherwise
+                    hid_t xfer_id_;
+#ifdef ALPS_HAVE_MPI
+                    /// duplicate of the communicator of a parallel file, alive as long as the file is open
+                    alps::mpi::communicator comm_;
+#endif
+
+#ifndef ALPS_SINGLE_THREAD
+                    /// serializes operations on this file only; never taken for read-only files
+                    boost::recursive_mutex mutex_;
+#endif
 
                 private:
 
                     void construct();
                     void destruct(bool abort);
             };
+
+#ifndef ALPS_SINGLE_THREAD
+            /// Scoped lock of a single file. Read-only files are immutable while open,
+            /// so no lock is taken for them and concurrent readers never contend.
+            class context_lock : boost::noncopyable {
+                public:
+                    explicit context_lock(archivecontext * context)
+                        : context_(context != NULL && context->write_ ? context : NULL)
+                    {
+                        if (context_ != NULL)
+                            context_->mutex_.lock();
+                    }
+
+                    ~context_lock() {
+                        if (context_ != NULL)
+                            context_->mutex_.unlock();
+                    }
+
+                private:
+                    archivecontext * context_;
+            };
+#endif
         }
     }
 }
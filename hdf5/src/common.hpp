@@ -13,14 +13,20 @@
 
 #include <hdf5.h>
 
+// ALPS_HDF5_LOCK_MUTEX guards the process-wide registry of open files (archive::ref_cnt_),
+// ALPS_HDF5_LOCK_CONTEXT guards a single file (see detail::context_lock in archivecontext.hpp)
 #ifdef ALPS_SINGLE_THREAD
     #define ALPS_HDF5_LOCK_MUTEX
+    #define ALPS_HDF5_LOCK_CONTEXT
 #else
     #define ALPS_HDF5_LOCK_MUTEX boost::lock_guard<boost::recursive_mutex> guard(mutex_);
+    #define ALPS_HDF5_LOCK_CONTEXT detail::context_lock context_guard(context_);
 #endif
 
+// a thread-safe HDF5 library only needs the per-file lock to keep compound operations
+// atomic, otherwise every call into the library has to be serialized process-wide
 #ifdef H5_HAVE_THREADSAFE
-    #define ALPS_HDF5_FAKE_THREADSAFETY
+    #define ALPS_HDF5_FAKE_THREADSAFETY ALPS_HDF5_LOCK_CONTEXT
 #else
     #define ALPS_HDF5_FAKE_THREADSAFETY ALPS_HDF5_LOCK_MUTEX
 #endif
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include <alps/hdf5/archive.hpp>
+#include <alps/hdf5/mapped_array.hpp>
+#include <alps/hdf5/vector.hpp>
+#include <alps/hdf5/tensor.hpp>
+
+#include <alps/testing/unique_file.hpp>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+class hdf5_map_test : public ::testing::Test {
+  public:
+    alps::testing::unique_file ufile_;
+    std::vector<double> data_;
+
+    hdf5_map_test() : ufile_("hdf5_map.h5.", alps::testing::unique_file::REMOVE_AFTER), data_(3 * 1000) {
+        for (std::size_t i = 0; i < data_.size(); ++i)
+            data_[i] = 0.5 * i;
+        alps::numerics::tensor<double, 2> t(3, 1000);
+        std::copy(data_.begin(), data_.end(), t.storage().data());
+        alps::hdf5::archive ar(ufile_.name(), "w");
+        ar["/vector"] << data_;
+        ar["/tensor"] << t;
+        ar["/small"] << std::vector<int>(3, 7);
+        ar["/scalar"] << 1.0;
+    }
+};
+
+TEST_F(hdf5_map_test, MapContiguous) {
+    alps::hdf5::archive ar(ufile_.name(), "r");
+    alps::hdf5::mapped_array<double> m = ar.map<double>("/vector");
+    EXPECT_TRUE(m.is_mapped());
+    ASSERT_EQ(data_.size(), m.size());
+    EXPECT_TRUE(std::equal(data_.begin(), data_.end(), m.begin()));
+}
+
+TEST_F(hdf5_map_test, OutlivesArchive) {
+    alps::hdf5::mapped_array<double> m;
+    {
+        alps::hdf5::archive ar(ufile_.name(), "r");
+        m = ar.map<double>("/tensor");
+    }
+    ASSERT_EQ(2u, m.dimensions());
+    EXPECT_EQ(3u, m.extent()[0]);
+    EXPECT_EQ(1000u, m.extent()[1]);
+    alps::numerics::tensor_view<const double, 2> v = m.view<2>();
+    EXPECT_EQ(data_[1000 + 17], v(1, 17));
+    EXPECT_THROW(m.view<1>(), alps::hdf5::wrong_dimensions);
+}
+
+TEST_F(hdf5_map_test, Fallback) {
+    {
+        // conversion of the element type
+        alps::hdf5::archive ar(ufile_.name(), "r");
+        alps::hdf5::mapped_array<float> m = ar.map<float>("/vector");
+        EXPECT_FALSE(m.is_mapped());
+        ASSERT_EQ(data_.size(), m.size());
+        EXPECT_EQ(float(data_[42]), m[42]);
+        // compact layout
+        alps::hdf5::mapped_array<int> s = ar.map<int>("/small");
+        EXPECT_FALSE(s.is_mapped());
+        EXPECT_EQ(std::vector<int>(3, 7), std::vector<int>(s.begin(), s.end()));
+    }
+    {
+        // writable file
+        alps::hdf5::archive ar(ufile_.name(), "a");
+        alps::hdf5::mapped_array<double> m = ar.map<double>("/vector");
+        EXPECT_FALSE(m.is_mapped());
+        EXPECT_TRUE(std::equal(data_.begin(), data_.end(), m.begin()));
+    }
+}
+
+TEST_F(hdf5_map_test, Errors) {
+    alps::hdf5::archive ar(ufile_.name(), "r");
+    EXPECT_THROW(ar.map<double>("/scalar"), alps::hdf5::wrong_type);
+    EXPECT_THROW(ar.map<double>("/nonexistent"), alps::hdf5::path_not_found);
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/* Test of the parallel (MPI-IO) archive mode. Run with several ranks, e.g. ALPS_TEST_MPI_NPROC=4 */
+
+#include <alps/hdf5/archive.hpp>
+#include <alps/hdf5/vector.hpp>
+#include <alps/testing/unique_file.hpp>
+#include <alps/utilities/gtest_par_xml_output.hpp>
+#include <alps/utilities/mpi.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+class hdf5_mpio_test : public ::testing::Test {
+  public:
+    alps::mpi::communicator comm_;
+    std::string filename_;
+
+    hdf5_mpio_test() {
+        if (comm_.rank() == 0)
+            filename_ = alps::testing::temporary_filename("hdf5_mpio.h5.");
+        alps::mpi::broadcast(comm_, filename_, 0);
+    }
+
+    ~hdf5_mpio_test() {
+        comm_.barrier();
+        if (comm_.rank() == 0)
+            std::remove(filename_.c_str());
+    }
+};
+
+#ifndef ALPS_TEST_HDF5_PARALLEL
+// without parallel HDF5 only the error is tested
+TEST_F(hdf5_mpio_test, NoParallelSupport) {
+    EXPECT_FALSE(alps::hdf5::archive::has_parallel_io());
+    EXPECT_THROW(alps::hdf5::archive(filename_, comm_, "w"), alps::hdf5::archive_error);
+}
+#else
+
+TEST_F(hdf5_mpio_test, WriteSlices) {
+    const std::size_t nlocal = 10;
+    const int rank = comm_.rank();
+    const int nranks = comm_.size();
+    {
+        alps::hdf5::archive ar(filename_, comm_, "w");
+        EXPECT_TRUE(ar.is_parallel());
+        std::vector<double> local(nlocal, rank);
+        ar.write("/data", &local.front()
+                 , std::vector<std::size_t>(1, nlocal * nranks)
+                 , std::vector<std::size_t>(1, nlocal)
+                 , std::vector<std::size_t>(1, nlocal * rank));
+        ar["/nranks"] << nranks;
+    }
+    {
+        alps::hdf5::archive ar(filename_, comm_, "r");
+        int n;
+        ar["/nranks"] >> n;
+        EXPECT_EQ(nranks, n);
+        EXPECT_EQ(std::vector<std::size_t>(1, nlocal * nranks), ar.extent("/data"));
+        std::vector<double> slice(nlocal);
+        int other = (rank + 1) % nranks;
+        ar.read("/data", &slice.front(), std::vector<std::size_t>(1, nlocal), std::vector<std::size_t>(1, nlocal * other));
+        EXPECT_EQ(std::vector<double>(nlocal, other), slice);
+    }
+}
+
+TEST_F(hdf5_mpio_test, EmptySlice) {
+    const int rank = comm_.rank();
+    {
+        alps::hdf5::archive ar(filename_, comm_, "w");
+        std::vector<int> local(rank == 0 ? 4 : 1, 42);
+        ar.write("/data", &local.front()
+                 , std::vector<std::size_t>(1, 4)
+                 , std::vector<std::size_t>(1, rank == 0 ? 4 : 0)
+                 , std::vector<std::size_t>(1, 0));
+    }
+    if (rank == 0) {
+        alps::hdf5::archive ar(filename_, "r");
+        std::vector<int> data;
+        ar["/data"] >> data;
+        EXPECT_EQ(std::vector<int>(4, 42), data);
+    }
+}
+
+TEST_F(hdf5_mpio_test, RankLocalRead) {
+    {
+        alps::hdf5::archive ar(filename_, comm_, "w");
+        ar["/value"] << 7;
+    }
+    alps::hdf5::archive ar(filename_, comm_, "r");
+    // metadata and data reads are independent, so one rank may read alone
+    if (comm_.rank() == comm_.size() - 1) {
+        int value;
+        ar["/value"] >> value;
+        EXPECT_EQ(7, value);
+    }
+}
+
+TEST_F(hdf5_mpio_test, OwnCommunicator) {
+    std::unique_ptr<alps::hdf5::archive> ar;
+    {
+        alps::mpi::communicator dup(comm_, alps::mpi::comm_duplicate);
+        ar.reset(new alps::hdf5::archive(filename_, dup, "w"));
+    }
+    // the archive keeps its own duplicate of the freed communicator
+    (*ar)["/value"] << comm_.rank();
+    ar.reset();
+    alps::hdf5::archive in(filename_, "r");
+    int value;
+    in["/value"] >> value;
+    EXPECT_EQ(0, value);
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    alps::mpi::environment env(argc, argv);
+    alps::gtest_par_xml_output tweak;
+    tweak(alps::mpi::communicator().rank(), argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -103,3 +103,47 @@ TEST(hdf5, TestingTensorComplex){
     }
   }
 }
+
+TEST(hdf5, TestingTensorSlice){
+  alps::testing::unique_file ufile("tensor_slice.h5.", alps::testing::unique_file::REMOVE_AFTER);
+  const std::string&  filename = ufile.name();
+
+  alps::numerics::tensor<std::complex<double>, 3> v(4, 5, 6);
+  boost::multi_array<double, 2> m(boost::extents[5][6]);
+  for(int i = 0; i< 4; ++i) {
+    for (int j = 0; j < 5; ++j) {
+      for (int k = 0; k < 6; ++k) {
+        v(i, j, k) = std::complex<double>(i + j, k);
+        m[j][k] = 10 * j + k;
+      }
+    }
+  }
+  {
+    alps::hdf5::archive ar(filename, "w");
+    ar["/tensor"] << v;
+    ar["/multi_array"] << m;
+  }
+
+  alps::hdf5::archive ar(filename, "r");
+  alps::numerics::tensor<std::complex<double>, 3> w;
+  alps::hdf5::load_slice(ar, "/tensor", w, {{2, 1, 0}}, {{1, 3, 6}});
+  ASSERT_EQ(1u, w.shape()[0]);
+  ASSERT_EQ(3u, w.shape()[1]);
+  ASSERT_EQ(6u, w.shape()[2]);
+  for (int j = 0; j < 3; ++j) {
+    for (int k = 0; k < 6; ++k) {
+      EXPECT_EQ(v(2, j + 1, k), w(0, j, k));
+    }
+  }
+  EXPECT_THROW(alps::hdf5::load_slice(ar, "/tensor", w, {{3, 0, 0}}, {{2, 5, 6}}), alps::hdf5::archive_error);
+
+  boost::multi_array<double, 2> n;
+  alps::hdf5::load_slice(ar, "/multi_array", n, {{3, 2}}, {{2, 3}});
+  ASSERT_EQ(2u, n.shape()[0]);
+  ASSERT_EQ(3u, n.shape()[1]);
+  for (int j = 0; j < 2; ++j) {
+    for (int k = 0; k < 3; ++k) {
+      EXPECT_EQ(m[j + 3][k + 2], n[j][k]);
+    }
+  }
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include <alps/hdf5/archive.hpp>
+#include <alps/hdf5/vector.hpp>
+#include <alps/testing/unique_file.hpp>
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <memory>
+
+#include "gtest/gtest.h"
+
+// Built only with ALPS_ENABLE_THREADS
+
+// each thread reads its own read-only file, then all threads read the same file
+TEST(hdf5, ConcurrentReadOnlyArchives) {
+    const unsigned nthreads = 4;
+    std::vector<std::shared_ptr<alps::testing::unique_file> > files;
+    for (unsigned i = 0; i < nthreads; ++i) {
+        files.push_back(std::make_shared<alps::testing::unique_file>("hdf5_threads.h5.", alps::testing::unique_file::REMOVE_AFTER));
+        alps::hdf5::archive ar(files.back()->name(), "w");
+        ar["/value"] << std::vector<double>(1000, i);
+    }
+
+    std::atomic<unsigned> failures(0);
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < nthreads; ++i)
+        threads.push_back(std::thread([&files, &failures, i, nthreads]() {
+            for (unsigned rep = 0; rep < 10; ++rep) {
+                unsigned j = (rep % 2) ? i : 0;
+                alps::hdf5::archive ar(files[j]->name(), "r");
+                std::vector<double> data;
+                ar["/value"] >> data;
+                if (data.size() != 1000 || data.front() != j || data.back() != j)
+                    ++failures;
+            }
+        }));
+    for (unsigned i = 0; i < nthreads; ++i)
+        threads[i].join();
+    EXPECT_EQ(0u, failures.load());
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
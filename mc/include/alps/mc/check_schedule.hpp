@@ -6,7 +6,9 @@
 
 #pragma once
 
+#include <chrono>
 #include <ctime>
+#include <type_traits>
 
 namespace alps {
 
@@ -108,6 +110,104 @@ namespace alps {
         };
 
 
+        /// Class template to check for simulation completion with checks that overlap the computation
+        /**
+           The MPI adapter starts a non-blocking reduction of the progress when `pending()` returns `true`
+           and calls `start()`; it keeps sweeping and calls `update()` when the reduction has completed.
+           The time between `start()` and `update()` (the latency of the check, including the wait for
+           the slowest rank) is measured, and the next check is delayed to at least `latency_factor`
+           times the latency, but not more than `tmax`, so that checks never dominate the run time.
+
+           Typename CLOCK_T provides time-related types and methods
+        */
+        template <typename CLOCK_T>
+        class generic_async_check_schedule : public generic_check_schedule<CLOCK_T> {
+            typedef generic_check_schedule<CLOCK_T> base_type;
+
+            public:
+            typedef typename base_type::clock_type clock_type;
+            typedef typename base_type::time_point_type time_point_type;
+            typedef typename base_type::time_duration_type time_duration_type;
+
+            private:
+            clock_type clock_;
+
+            time_duration_type max_check_;
+            double latency_factor_;
+
+            bool in_flight_;
+            time_point_type start_time_;
+            time_point_type last_check_time_;
+            time_duration_type latency_;
+
+            public:
+            /// Constructor using default clock instance
+            /**
+               \param[in] tmin minimum time to check if simulation has finished
+               \param[in] tmax maximum time to check if simulation has finished
+               \param[in] latency_factor minimum time between checks, in units of the latency of the last check
+            */
+            generic_async_check_schedule(double tmin, double tmax, double latency_factor = 10)
+                : base_type(tmin, tmax),
+                  clock_(),
+                  max_check_(tmax),
+                  latency_factor_(latency_factor),
+                  in_flight_(false),
+                  start_time_(),
+                  last_check_time_(),
+                  latency_()
+            { }
+
+            /// Constructor using a given clock instance
+            /**
+               \param[in] tmin minimum time to check if simulation has finished
+               \param[in] tmax maximum time to check if simulation has finished
+               \param[in] latency_factor minimum time between checks, in units of the latency of the last check
+               \param[in] clock Clock object to use
+            */
+            generic_async_check_schedule(double tmin, double tmax, double latency_factor, const clock_type& clock)
+                : base_type(tmin, tmax, clock),
+                  clock_(clock),
+                  max_check_(tmax),
+                  latency_factor_(latency_factor),
+                  in_flight_(false),
+                  start_time_(),
+                  last_check_time_(),
+                  latency_()
+            { }
+
+            /// Returns `true` if no check is in progress and it's time to start one
+            bool pending() const
+            {
+                if (in_flight_) return false;
+                if (!base_type::pending()) return false;
+                time_duration_type min_gap = latency_factor_ * latency_;
+                if (min_gap > max_check_) min_gap = max_check_;
+                return clock_.time_diff(clock_.now_time(), last_check_time_) >= min_gap;
+            }
+
+            /// Marks the start of a check
+            void start()
+            {
+                start_time_ = clock_.now_time();
+                in_flight_ = true;
+            }
+
+            /// Schedule the next check based on the fraction of the simulation completed, at the end of a check
+            void update(double fraction)
+            {
+                time_point_type now = clock_.now_time();
+                if (in_flight_) latency_ = clock_.time_diff(now, start_time_);
+                in_flight_ = false;
+                last_check_time_ = now;
+                base_type::update(fraction);
+            }
+
+            /// Returns the latency of the last check
+            time_duration_type latency() const { return latency_; }
+        };
+
+
         /// Type for POSIX wall-clock time
         class posix_wall_clock {
           public:
@@ -126,8 +226,41 @@ namespace alps {
                 return std::difftime(t1, t0);
             }
         };
+
+        /// Type for monotonic wall-clock time, in seconds, fine enough to time a collective operation
+        class steady_wall_clock {
+          public:
+            /// Type for "point at time" (that is, duration from some epoch)
+            typedef double time_point_type;
+
+            /// Type for "duration of time" (that is, difference between to points in time)
+            typedef double time_duration_type;
+
+            /// Returns current time point
+            static time_point_type now_time()
+            {
+                return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            }
+
+            /// Returns a difference (duration) between time points
+            static time_duration_type time_diff(time_point_type t1, time_point_type t0)
+            {
+                return t1 - t0;
+            }
+        };
     } // detail::
         
     typedef detail::generic_check_schedule<detail::posix_wall_clock> check_schedule;
 
+    /// Schedule checker whose checks the MPI adapter overlaps with the sweeps
+    typedef detail::generic_async_check_schedule<detail::steady_wall_clock> async_check_schedule;
+
+    /// Whether the MPI adapter runs the checks of `ScheduleChecker` as non-blocking reductions
+    /** A custom schedule checker may specialize this if it provides `start()` like `async_check_schedule`. */
+    template <typename ScheduleChecker>
+    struct is_async_schedule : std::false_type {};
+
+    template <typename CLOCK_T>
+    struct is_async_schedule< detail::generic_async_check_schedule<CLOCK_T> > : std::true_type {};
+
 } // namespace alps 
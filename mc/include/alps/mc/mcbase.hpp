@@ -45,8 +45,11 @@ namespace alps {
             results_type collect_results() const;
             results_type collect_results(result_names_type const & names) const;
 
-            void save(std::string const & filename) const;
-            void load(std::string const & filename);
+            /// Path of the state of clone `clone` in a simulation file
+            static std::string clone_path(std::size_t clone);
+
+            void save(std::string const & filename, std::size_t clone = 0) const;
+            void load(std::string const & filename, std::size_t clone = 0);
             virtual void save(alps::hdf5::archive & ar) const;
             virtual void load(alps::hdf5::archive & ar);
 
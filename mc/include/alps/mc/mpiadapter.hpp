@@ -13,11 +13,29 @@
 
 #if defined(ALPS_HAVE_MPI)
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
 #include <alps/accumulators/mpi.hpp>
+#include <alps/hdf5/archive.hpp>
 #include <alps/mc/check_schedule.hpp>
+#include <alps/utilities/mpi_pack.hpp>
 
 namespace alps {
 
+    /// How the clones of an MPI simulation write their checkpoints
+    enum checkpoint_mode {
+        /// All clones at the same check, made valid together by rank 0 writing the checkpoint index
+        coordinated_checkpoint,
+        /// Each clone on its own clock, without communication
+        per_rank_checkpoint
+    };
+
     namespace detail {
 
         /// Base class for mcmpiadapter; should never be instantiated by a user
@@ -52,6 +70,12 @@ namespace alps {
                 , communicator(comm)
                 , schedule_checker(check)
                 , clone(comm.rank())
+                , seed_offset(comm.rank()*rng_seed_step + rng_seed_base)
+                , checkpoint_interval(0)
+                , checkpoint_kind(coordinated_checkpoint)
+                , last_checkpoint(clock_type::now_time())
+                , checkpoint_generation(0)
+                , checkpoint_clones(0)
             {}
 
        public:
@@ -59,19 +83,194 @@ namespace alps {
                 return fraction;
             }
 
+            /// Runs the simulation until the sum of the completed fractions of all ranks reaches 1 or `stop_callback` returns `true`
+            /**
+               The progress, the stop flag and the checkpoint request of the ranks are reduced together at each
+               check. With a schedule checker for which `is_async_schedule` holds (e.g. `async_check_schedule`)
+               the reduction is non-blocking: it is started at the check and its result is used at the first sweep
+               after it has completed, so the ranks do not wait for each other. The stop flag then enters the reduction
+               from every rank; a `stop_callback` without a communicator avoids its separate broadcast.
+
+               @return `false` on every rank if `stop_callback` returned `true` on any rank
+            */
             bool run(boost::function<bool ()> const & stop_callback) {
-                bool done = false, stopped = false;
-                do {
-                    this->update();
-                    this->measure();
-                    if (stopped || schedule_checker.pending()) {
-                        stopped = stop_callback();
-                        double local_fraction = stopped ? 1. : Base::fraction_completed();
-                        schedule_checker.update(fraction = alps::mpi::all_reduce(communicator, local_fraction, std::plus<double>()));
-                        done = fraction >= 1.;
+                return run_checks(stop_callback, is_async_schedule<ScheduleChecker>());
+            }
+
+            /// Enables checkpoints
+            /**
+               The state of each clone, as written by `save(alps::hdf5::archive&)`, goes to its own file
+               `basename.clone<N>.h5` (per-rank mode) or `basename.g<generation>.clone<N>.h5` (coordinated mode),
+               under `mcbase::clone_path(N)`. In coordinated mode rank 0 then writes the index `basename.h5`;
+               a checkpoint becomes valid only with the index, so an interrupted checkpoint leaves the previous one.
+
+               Checkpoints are written every `interval` seconds (0: only at the end) and when `run()` returns,
+               also when it is stopped by a signal or the time limit.
+
+               @param basename Name of the checkpoint files without the extension
+               @param interval Time between checkpoints, in seconds
+               @param mode Whether the clones write checkpoints together or independently
+            */
+            void enable_checkpoints(std::string const & basename, double interval, checkpoint_mode mode = coordinated_checkpoint) {
+                if (basename.empty()) throw std::invalid_argument("Empty checkpoint file name");
+                if (interval < 0) throw std::invalid_argument("Negative checkpoint interval");
+                checkpoint_base = basename;
+                checkpoint_interval = interval;
+                checkpoint_kind = mode;
+                last_checkpoint = clock_type::now_time();
+            }
+
+            /// Writes a checkpoint; collective in coordinated mode
+            void checkpoint() {
+                if (checkpoint_base.empty()) throw std::logic_error("Checkpoints are not enabled");
+                last_checkpoint = clock_type::now_time();
+                if (checkpoint_kind == per_rank_checkpoint) {
+                    // the file is replaced only when complete; it records how many clone files may exist
+                    std::string file = clone_file(checkpoint_base, clone);
+                    save_clone(file + ".tmp", std::max<std::size_t>(communicator.size(), checkpoint_clones));
+                    if (std::rename((file + ".tmp").c_str(), file.c_str()) != 0)
+                        throw std::runtime_error("Cannot rename the checkpoint " + file + ".tmp");
+                    // the measurements of the merged clones are now in this file
+                    for (std::size_t i = 0; i < merged_files.size(); ++i) std::remove(merged_files[i].c_str());
+                    merged_files.clear();
+                    checkpoint_clones = communicator.size();
+                    return;
+                }
+
+                const int generation = checkpoint_generation + 1;
+                const std::string file = clone_file(generation_prefix(checkpoint_base, generation), clone);
+                int failed = 0;
+                try {
+                    save_clone(file, communicator.size());
+                } catch (std::exception const & exc) {
+                    std::cerr << "Checkpoint of clone " << clone << " failed: " << exc.what() << std::endl;
+                    failed = 1;
+                }
+                if (alps::mpi::all_reduce(communicator, failed, std::plus<int>()) > 0) {
+                    std::remove(file.c_str());
+                    throw std::runtime_error("Checkpoint failed; the previous checkpoint " + checkpoint_base + ".h5 is kept");
+                }
+
+                if (communicator.rank() == 0) {
+                    const std::string index = checkpoint_base + ".h5";
+                    try {
+                        std::remove((index + ".tmp").c_str());
+                        {
+                            alps::hdf5::archive ar(index + ".tmp", "w");
+                            ar["/checkpoint/clones"] << std::size_t(communicator.size());
+                            ar["/checkpoint/generation"] << generation;
+                        }
+                        if (std::rename((index + ".tmp").c_str(), index.c_str()) != 0)
+                            throw std::runtime_error("Cannot rename the checkpoint index " + index + ".tmp");
+                    } catch (std::exception const & exc) {
+                        std::cerr << "Checkpoint index failed: " << exc.what() << std::endl;
+                        failed = 1;
                     }
-                } while(!done);
-                return !stopped;
+                }
+                // the other ranks must not wait for an index that never comes
+                if (alps::mpi::all_reduce(communicator, failed, std::plus<int>()) > 0) {
+                    std::remove(file.c_str());
+                    throw std::runtime_error("Checkpoint index failed; the previous checkpoint " + checkpoint_base + ".h5 is kept");
+                }
+                // the new checkpoint is valid, the previous one can go
+                if (checkpoint_generation > 0) {
+                    const std::string previous = generation_prefix(checkpoint_base, checkpoint_generation);
+                    std::remove(clone_file(previous, clone).c_str());
+                    if (communicator.rank() == 0) {
+                        for (std::size_t k = communicator.size(); k < checkpoint_clones; ++k)
+                            std::remove(clone_file(previous, k).c_str());
+                    }
+                }
+                checkpoint_generation = generation;
+                checkpoint_clones = communicator.size();
+            }
+
+            /// Restores the clones from a checkpoint; collective
+            /**
+               The coordinated checkpoint named by `basename.h5` is used if it exists, otherwise the per-rank
+               files `basename.clone<N>.h5`. The number of ranks may differ from the number of saved clones:
+               with fewer ranks, rank r restores clone r and adds the measurements of clones r+P, r+2P, ...;
+               with more ranks, rank r restores the configuration of clone r%C, clears its measurements and
+               reseeds its random number generator, so that no measurement is counted twice. In per-rank mode,
+               the files of the merged clones are removed by the next checkpoint of the rank that merged them.
+
+               @return `false` if there is no checkpoint
+               @throw std::runtime_error on all ranks if any rank cannot read its part of the checkpoint
+            */
+            bool restore(std::string const & basename) {
+                std::string prefix;
+                std::vector<std::size_t> clones;
+                std::size_t bound = 0;
+                int generation = 0;
+                bool per_rank = false;
+                int failed = 0;
+                if (communicator.rank() == 0) {
+                    try {
+                        if (std::ifstream((basename + ".h5").c_str())) {
+                            alps::hdf5::archive ar(basename + ".h5");
+                            ar["/checkpoint/clones"] >> bound;
+                            ar["/checkpoint/generation"] >> generation;
+                            prefix = generation_prefix(basename, generation);
+                            for (std::size_t k = 0; k < bound; ++k) clones.push_back(k);
+                        } else {
+                            // each file records how many clone files may exist; some of them may already be merged
+                            per_rank = true;
+                            prefix = basename;
+                            bound = 1;
+                            for (std::size_t k = 0; k < bound; ++k) {
+                                if (!std::ifstream(clone_file(prefix, k).c_str())) continue;
+                                alps::hdf5::archive ar(clone_file(prefix, k));
+                                std::size_t recorded;
+                                ar["/checkpoint/clones"] >> recorded;
+                                bound = std::max(bound, recorded);
+                                clones.push_back(k);
+                            }
+                        }
+                    } catch (std::exception const & exc) {
+                        std::cerr << "Reading checkpoint " << basename << " failed: " << exc.what() << std::endl;
+                        failed = 1;
+                    }
+                }
+                // the other ranks must not wait for a list of clones that never comes
+                if (alps::mpi::all_reduce(communicator, failed, std::plus<int>()) > 0)
+                    throw std::runtime_error("Cannot read the checkpoint " + basename);
+                alps::mpi::broadcast_packed(communicator, prefix, 0);
+                alps::mpi::broadcast_packed(communicator, clones, 0);
+                alps::mpi::broadcast(communicator, bound, 0);
+                alps::mpi::broadcast(communicator, generation, 0);
+                alps::mpi::broadcast(communicator, per_rank, 0);
+                if (clones.empty()) return false;
+
+                const std::size_t nclones = clones.size();
+                const std::size_t nranks = communicator.size();
+                const std::size_t own = clone;
+                merged_files.clear();
+                try {
+                    load_clone(clone_file(prefix, clones[own % nclones]), clones[own % nclones]);
+                    if (own >= nclones) {
+                        this->measurements.reset();
+                        this->random = alps::random01(std::size_t(this->parameters["SEED"]) + seed_offset);
+                    } else {
+                        for (std::size_t i = own + nranks; i < nclones; i += nranks) {
+                            alps::hdf5::archive ar(clone_file(prefix, clones[i]));
+                            typename Base::observable_collection_type extra;
+                            ar[mcbase::clone_path(clones[i]) + "/measurements"] >> extra;
+                            this->measurements.merge(extra);
+                            if (per_rank) merged_files.push_back(clone_file(prefix, clones[i]));
+                        }
+                    }
+                } catch (std::exception const & exc) {
+                    std::cerr << "Restoring clone " << clone << " failed: " << exc.what() << std::endl;
+                    failed = 1;
+                }
+                // a rank that cannot restore its clone must not leave the others running alone
+                if (alps::mpi::all_reduce(communicator, failed, std::plus<int>()) > 0) {
+                    merged_files.clear();
+                    throw std::runtime_error("Restoring the checkpoint " + basename + " failed");
+                }
+                checkpoint_generation = generation;
+                checkpoint_clones = bound;
+                return true;
             }
 
             typename Base::results_type collect_results() const {
@@ -104,6 +303,114 @@ namespace alps {
             ScheduleChecker schedule_checker;
             double fraction;
             int clone;
+
+        private:
+            typedef posix_wall_clock clock_type;
+
+            /// Local part of the check: the fraction, or 1 if stopped, the checkpoint request and the stop flag
+            void check_values(bool stopped, double * local) const {
+                local[0] = stopped ? 1. : Base::fraction_completed();
+                local[1] = checkpoint_kind == coordinated_checkpoint && checkpoint_due() ? 1. : 0.;
+                local[2] = stopped ? 1. : 0.;
+            }
+
+            /// Uses the reduced check values; returns `true` when done
+            bool checked(double const * global) {
+                schedule_checker.update(fraction = global[0]);
+                const bool done = fraction >= 1.;
+                if (!done && global[1] > 0) checkpoint();
+                return done;
+            }
+
+            /// Writes the final checkpoint; returns `false` if any rank was stopped
+            bool finish(double const * global) {
+                // the final state, also when stopped by a signal or the time limit
+                if (!checkpoint_base.empty()) checkpoint();
+                return !(global[2] > 0);
+            }
+
+            /// Run with blocking checks
+            bool run_checks(boost::function<bool ()> const & stop_callback, std::false_type) {
+                bool done = false, stopped = false;
+                double local[3], global[3];
+                do {
+                    this->update();
+                    this->measure();
+                    if (checkpoint_kind == per_rank_checkpoint && checkpoint_due())
+                        checkpoint();
+                    if (stopped || schedule_checker.pending()) {
+                        stopped = stop_callback();
+                        // the fraction, the checkpoint request and the stop flag go in one reduction
+                        check_values(stopped, local);
+                        alps::mpi::all_reduce(communicator, local, 3, global, std::plus<double>());
+                        done = checked(global);
+                    }
+                } while(!done);
+                return finish(global);
+            }
+
+            /// Run with checks overlapping the sweeps
+            bool run_checks(boost::function<bool ()> const & stop_callback, std::true_type) {
+#if MPI_VERSION >= 3
+                bool done = false, stopped = false;
+                double local[3], global[3];
+                alps::mpi::request check;
+                do {
+                    this->update();
+                    this->measure();
+                    if (checkpoint_kind == per_rank_checkpoint && checkpoint_due())
+                        checkpoint();
+                    if (check.active()) {
+                        // every rank uses the same result, so the checkpoints stay collective
+                        if (check.test()) done = checked(global);
+                    } else if (stopped || schedule_checker.pending()) {
+                        stopped = stop_callback();
+                        check_values(stopped, local);
+                        schedule_checker.start();
+                        check = alps::mpi::iall_reduce(communicator, local, 3, global, std::plus<double>());
+                    }
+                } while(!done);
+                return finish(global);
+#else
+                return run_checks(stop_callback, std::false_type());
+#endif
+            }
+
+            std::size_t seed_offset;
+            std::string checkpoint_base;
+            double checkpoint_interval;
+            checkpoint_mode checkpoint_kind;
+            clock_type::time_point_type last_checkpoint;
+            int checkpoint_generation;
+            std::size_t checkpoint_clones;
+            std::vector<std::string> merged_files;
+
+            bool checkpoint_due() const {
+                return !checkpoint_base.empty() && checkpoint_interval > 0
+                    && clock_type::time_diff(clock_type::now_time(), last_checkpoint) >= checkpoint_interval;
+            }
+
+            static std::string generation_prefix(std::string const & basename, int generation) {
+                return basename + ".g" + std::to_string(generation);
+            }
+
+            static std::string clone_file(std::string const & prefix, std::size_t k) {
+                return prefix + ".clone" + std::to_string(k) + ".h5";
+            }
+
+            /// Writes the clone to a new file, with the number of clone files that may exist
+            void save_clone(std::string const & filename, std::size_t clones) const {
+                // "w" does not truncate an existing file
+                std::remove(filename.c_str());
+                alps::hdf5::archive ar(filename, "w");
+                ar["/checkpoint/clones"] << clones;
+                ar[mcbase::clone_path(clone)] << static_cast<Base const &>(*this);
+            }
+
+            void load_clone(std::string const & filename, std::size_t k) {
+                alps::hdf5::archive ar(filename);
+                ar[mcbase::clone_path(k)] >> static_cast<Base &>(*this);
+            }
         };
     } // detail::
 
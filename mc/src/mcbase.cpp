@@ -20,14 +20,18 @@ namespace alps {
         return parameters.define<long>("SEED", 42, "PRNG seed");
     }
 
-  void mcbase::save(std::string const & filename) const {
+    std::string mcbase::clone_path(std::size_t clone) {
+        return "/simulation/realizations/0/clones/" + std::to_string(clone);
+    }
+
+    void mcbase::save(std::string const & filename, std::size_t clone) const {
         alps::hdf5::archive ar(filename, "w");
-        ar["/simulation/realizations/0/clones/0"] << *this;
+        ar[clone_path(clone)] << *this;
     }
 
-    void mcbase::load(std::string const & filename) {
+    void mcbase::load(std::string const & filename, std::size_t clone) {
         alps::hdf5::archive ar(filename);
-        ar["/simulation/realizations/0/clones/0"] >> *this;
+        ar[clone_path(clone)] >> *this;
     }
 
     bool mcbase::run(boost::function<bool ()> const & stop_callback) {
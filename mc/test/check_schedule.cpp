@@ -101,6 +101,50 @@ TEST(CheckScheduleTest, UseFakeTimer)
     EXPECT_TRUE(checker.pending());
 }
 
+typedef alps::detail::generic_async_check_schedule<fake_timer> test_async_check_schedule;
+
+TEST(CheckScheduleTest, AsyncLatency)
+{
+    const std::size_t MIN_CHECK=3;
+    const std::size_t MAX_CHECK=50;
+    const double LATENCY_FACTOR=10;
+
+    fake_timer timer;
+    timer.reset(10000);
+
+    test_async_check_schedule checker(MIN_CHECK, MAX_CHECK, LATENCY_FACTOR, timer);
+    EXPECT_TRUE(checker.pending());
+
+    // no new check while one is in flight
+    checker.start();
+    EXPECT_FALSE(checker.pending());
+    timer.advance(2);
+    checker.update(0.05);
+    EXPECT_EQ(2, checker.latency());
+
+    // the next check is delayed to 10 times the latency
+    timer.advance(MIN_CHECK+1);
+    EXPECT_FALSE(checker.pending());
+    timer.advance(20-(MIN_CHECK+1));
+    EXPECT_TRUE(checker.pending());
+
+    // ...but not beyond the maximum interval
+    checker.start();
+    timer.advance(10);
+    checker.update(0.1);
+    EXPECT_EQ(10, checker.latency());
+    timer.advance(MAX_CHECK-1);
+    EXPECT_FALSE(checker.pending());
+    timer.advance(2);
+    EXPECT_TRUE(checker.pending());
+}
+
+TEST(CheckScheduleTest, IsAsync)
+{
+    EXPECT_FALSE(alps::is_async_schedule<alps::check_schedule>::value);
+    EXPECT_TRUE(alps::is_async_schedule<alps::async_check_schedule>::value);
+}
+
 // WARNING: the following test relies on a real timing of the code,
 // and thus:
 // (a) Long (about 15 sec)
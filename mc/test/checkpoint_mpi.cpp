@@ -0,0 +1,285 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/* Test of the checkpoints of the MPI adapter. Run with several ranks, e.g. ALPS_TEST_MPI_NPROC=3 */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include <alps/mc/mcbase.hpp>
+#include <alps/mc/api.hpp>
+#include <alps/mc/mpiadapter.hpp>
+#include <alps/mc/stop_callback.hpp>
+#include <alps/utilities/temporary_filename.hpp>
+
+#include "gtest/gtest.h"
+
+class counting_sim : public alps::mcbase {
+    public:
+        counting_sim(parameters_type const & params, std::size_t seed_offset = 0)
+            : alps::mcbase(params, seed_offset)
+            , total_count(params["COUNT"])
+            , count(0)
+        {
+            measurements << alps::accumulators::NoBinningAccumulator<double>("Value");
+        }
+
+        void update() { ++count; }
+
+        void measure() { measurements["Value"] << random(); }
+
+        double fraction_completed() const { return count / double(total_count); }
+
+        void save(alps::hdf5::archive & ar) const {
+            alps::mcbase::save(ar);
+            ar["count"] << count;
+        }
+
+        void load(alps::hdf5::archive & ar) {
+            alps::mcbase::load(ar);
+            ar["count"] >> count;
+        }
+
+        int sweeps() const { return count; }
+
+        double next_random() { return random(); }
+
+    private:
+        int total_count;
+        int count;
+};
+
+typedef alps::mcmpiadapter<counting_sim> sim_type;
+
+class CheckpointTest : public ::testing::Test {
+  public:
+    alps::mpi::communicator comm;
+    alps::params params;
+    std::string basename;
+
+    CheckpointTest() {
+        params["COUNT"] = 100;
+        sim_type::define_parameters(params);
+        if (comm.rank() == 0) basename = alps::temporary_filename("checkpoint_mpi.");
+        alps::mpi::broadcast_packed(comm, basename, 0);
+    }
+
+    ~CheckpointTest() {
+        comm.barrier();
+        if (comm.rank() == 0) {
+            std::remove((basename + ".h5").c_str());
+            for (int g = 0; g < 10; ++g)
+                for (int k = 0; k < comm.size() + 1; ++k) {
+                    std::string gen = basename + ".g" + std::to_string(g);
+                    std::remove((gen + ".clone" + std::to_string(k) + ".h5").c_str());
+                    std::remove((basename + ".clone" + std::to_string(k) + ".h5").c_str());
+                }
+        }
+    }
+
+    /// Measures `n` times
+    static void sweep(sim_type & sim, int n) {
+        for (int i = 0; i < n; ++i) {
+            sim.update();
+            sim.measure();
+        }
+    }
+
+    /// Number of measurements summed over the ranks of `c`, at rank 0
+    static long total_count(sim_type & sim, alps::mpi::communicator const & c) {
+        if (c.rank() == 0) return alps::collect_results(sim)["Value"].count();
+        alps::collect_results(sim);
+        return 0;
+    }
+};
+
+TEST_F(CheckpointTest, NoCheckpoint) {
+    sim_type sim(params, comm);
+    EXPECT_FALSE(sim.restore(basename));
+    EXPECT_THROW(sim.checkpoint(), std::logic_error);
+}
+
+TEST_F(CheckpointTest, SameRanks) {
+    long saved;
+    double next;
+    {
+        sim_type sim(params, comm);
+        sim.enable_checkpoints(basename, 0);
+        sweep(sim, 10 + comm.rank());
+        sim.checkpoint();
+        sweep(sim, 5);
+        // the second checkpoint replaces the first one
+        sim.checkpoint();
+        saved = total_count(sim, comm);
+        next = sim.next_random();
+    }
+    if (comm.rank() == 0) {
+        EXPECT_FALSE(std::ifstream((basename + ".g1.clone0.h5").c_str()).good());
+        EXPECT_TRUE(std::ifstream((basename + ".g2.clone0.h5").c_str()).good());
+    }
+    sim_type restored(params, comm);
+    ASSERT_TRUE(restored.restore(basename));
+    EXPECT_EQ(15 + comm.rank(), restored.sweeps());
+    // the random numbers continue
+    EXPECT_EQ(next, restored.next_random());
+    long count = total_count(restored, comm);
+    if (comm.rank() == 0) {
+        EXPECT_EQ(saved, count);
+    }
+}
+
+TEST_F(CheckpointTest, FewerRanks) {
+    long saved;
+    {
+        sim_type sim(params, comm);
+        sim.enable_checkpoints(basename, 0);
+        sweep(sim, 10 + comm.rank());
+        sim.checkpoint();
+        saved = total_count(sim, comm);
+    }
+    // the clones of the missing ranks are merged into the others
+    int nsub = comm.size() > 1 ? comm.size() - 1 : 1;
+    MPI_Comm sub;
+    MPI_Comm_split(comm, comm.rank() < nsub ? 0 : MPI_UNDEFINED, comm.rank(), &sub);
+    if (sub != MPI_COMM_NULL) {
+        alps::mpi::communicator subcomm(sub, alps::mpi::take_ownership);
+        sim_type restored(params, subcomm);
+        ASSERT_TRUE(restored.restore(basename));
+        long count = total_count(restored, subcomm);
+        if (comm.rank() == 0) {
+            EXPECT_EQ(saved, count);
+        }
+    }
+}
+
+TEST_F(CheckpointTest, MoreRanks) {
+    long saved = 0;
+    MPI_Comm sub;
+    MPI_Comm_split(comm, comm.rank() == 0 ? 0 : MPI_UNDEFINED, comm.rank(), &sub);
+    if (sub != MPI_COMM_NULL) {
+        alps::mpi::communicator subcomm(sub, alps::mpi::take_ownership);
+        sim_type sim(params, subcomm);
+        sim.enable_checkpoints(basename, 0);
+        sweep(sim, 20);
+        sim.checkpoint();
+        saved = total_count(sim, subcomm);
+    }
+    comm.barrier();
+    // the other ranks start from the configuration of clone 0, without its measurements
+    sim_type restored(params, comm);
+    ASSERT_TRUE(restored.restore(basename));
+    EXPECT_EQ(20, restored.sweeps());
+    sweep(restored, 1);
+    long count = total_count(restored, comm);
+    if (comm.rank() == 0) {
+        EXPECT_EQ(saved + comm.size(), count);
+    }
+}
+
+TEST_F(CheckpointTest, PerRank) {
+    long saved;
+    {
+        sim_type sim(params, comm);
+        sim.enable_checkpoints(basename, 0, alps::per_rank_checkpoint);
+        sweep(sim, 7 * (comm.rank() + 1));
+        sim.checkpoint();
+        saved = total_count(sim, comm);
+    }
+    sim_type restored(params, comm);
+    ASSERT_TRUE(restored.restore(basename));
+    EXPECT_EQ(7 * (comm.rank() + 1), restored.sweeps());
+    long count = total_count(restored, comm);
+    if (comm.rank() == 0) {
+        EXPECT_EQ(saved, count);
+    }
+}
+
+TEST_F(CheckpointTest, PerRankFewerRanks) {
+    long saved;
+    {
+        sim_type sim(params, comm);
+        sim.enable_checkpoints(basename, 0, alps::per_rank_checkpoint);
+        sweep(sim, 7 * (comm.rank() + 1));
+        sim.checkpoint();
+        saved = total_count(sim, comm);
+    }
+    int nsub = comm.size() > 1 ? comm.size() - 1 : 1;
+    MPI_Comm sub;
+    MPI_Comm_split(comm, comm.rank() < nsub ? 0 : MPI_UNDEFINED, comm.rank(), &sub);
+    if (sub != MPI_COMM_NULL) {
+        alps::mpi::communicator subcomm(sub, alps::mpi::take_ownership);
+        {
+            sim_type restored(params, subcomm);
+            ASSERT_TRUE(restored.restore(basename));
+            restored.enable_checkpoints(basename, 0, alps::per_rank_checkpoint);
+            restored.checkpoint();
+        }
+        // the merged clones are not counted again
+        sim_type again(params, subcomm);
+        ASSERT_TRUE(again.restore(basename));
+        long count = total_count(again, subcomm);
+        if (comm.rank() == 0) {
+            EXPECT_EQ(saved, count);
+            EXPECT_FALSE(std::ifstream((basename + ".clone" + std::to_string(nsub) + ".h5").c_str()).good());
+        }
+    }
+}
+
+TEST_F(CheckpointTest, IndexFailure) {
+    // a non-empty directory in place of the temporary index cannot be replaced
+    const std::string blocker = basename + ".h5.tmp";
+    if (comm.rank() == 0) {
+        ASSERT_EQ(0, system(("mkdir -p " + blocker + " && touch " + blocker + "/x").c_str()));
+    }
+    comm.barrier();
+    sim_type sim(params, comm);
+    sim.enable_checkpoints(basename, 0);
+    sweep(sim, 3);
+    // all ranks throw instead of waiting for the index
+    EXPECT_THROW(sim.checkpoint(), std::runtime_error);
+    comm.barrier();
+    if (comm.rank() == 0) {
+        EXPECT_FALSE(std::ifstream((basename + ".g1.clone0.h5").c_str()).good());
+        EXPECT_EQ(0, system(("rm -rf " + blocker).c_str()));
+    }
+}
+
+TEST_F(CheckpointTest, MissingClone) {
+    {
+        sim_type sim(params, comm);
+        sim.enable_checkpoints(basename, 0);
+        sweep(sim, 3);
+        sim.checkpoint();
+    }
+    comm.barrier();
+    if (comm.rank() == 0) {
+        const std::string last = basename + ".g1.clone" + std::to_string(comm.size() - 1) + ".h5";
+        EXPECT_EQ(0, std::remove(last.c_str()));
+    }
+    comm.barrier();
+    // all ranks throw, not only the one whose clone is missing
+    sim_type restored(params, comm);
+    EXPECT_THROW(restored.restore(basename), std::runtime_error);
+}
+
+TEST_F(CheckpointTest, AtEndOfRun) {
+    {
+        sim_type sim(params, comm, alps::check_schedule(0, 0));
+        sim.enable_checkpoints(basename, 3600);
+        sim.run(alps::stop_callback(comm, 0));
+    }
+    sim_type restored(params, comm);
+    ASSERT_TRUE(restored.restore(basename));
+    EXPECT_GT(restored.sweeps(), 0);
+}
+
+int main(int argc, char** argv)
+{
+   alps::mpi::environment env(argc, argv, false);
+   ::testing::InitGoogleTest(&argc, argv);
+   return RUN_ALL_TESTS();
+}
@@ -60,6 +60,46 @@ TEST(CustomScheduler,Params) {
     EXPECT_FALSE(p.defined("Tmax"));
 }
 
+TEST(CustomScheduler,Async) {
+    typedef alps::mcmpiadapter<my_sim_type,alps::async_check_schedule> sim_type;
+    alps::mpi::communicator comm;
+    alps::params p;
+    sim_type::define_parameters(p);
+
+    sim_type sim(p, comm, alps::async_check_schedule(0, 0));
+    EXPECT_TRUE(sim.run(stop_callback));
+
+    // the ranks stop when the first one is done, and may sweep a little longer while the check completes
+    EXPECT_EQ(sim_type::MAXCOUNT+0, alps::mpi::all_reduce(comm, std::min(sim.count(), +sim_type::MAXCOUNT), alps::mpi::maximum<int>()));
+    EXPECT_GE(sim.fraction_completed(), 1.);
+}
+
+static bool stop_last_rank() {
+    alps::mpi::communicator comm;
+    return comm.rank() == comm.size()-1;
+}
+
+TEST(CustomScheduler,AsyncStop) {
+    typedef alps::mcmpiadapter<my_sim_type,alps::async_check_schedule> sim_type;
+    alps::mpi::communicator comm;
+    alps::params p;
+    sim_type::define_parameters(p);
+
+    // the stop flag of one rank stops all of them, and all of them report it
+    sim_type sim(p, comm, alps::async_check_schedule(0, 0));
+    EXPECT_FALSE(sim.run(stop_last_rank));
+}
+
+TEST(CustomScheduler,BlockingStop) {
+    typedef alps::mcmpiadapter<my_sim_type,my_schecker_type> sim_type;
+    alps::mpi::communicator comm;
+    alps::params p;
+    sim_type::define_parameters(p);
+
+    sim_type sim(p, comm, my_schecker_type());
+    EXPECT_FALSE(sim.run(stop_last_rank));
+}
+
 int main(int argc, char**argv)
 {
    alps::mpi::environment env(argc, argv, false);
@@ -90,6 +90,12 @@ namespace alps {
 #ifdef ALPS_HAVE_MPI
             /// Broadcast the dictionary
             void broadcast(const alps::mpi::communicator& comm, int root);
+
+            /// Packs the dictionary for an MPI transfer
+            void pack(alps::mpi::packer& p) const;
+
+            /// Unpacks the dictionary
+            void unpack(alps::mpi::unpacker& u);
 #endif
         };
 
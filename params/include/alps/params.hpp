@@ -15,6 +15,7 @@
 #ifdef ALPS_HAVE_MPI
 #include <alps/utilities/mpi.hpp>
 #include <alps/utilities/mpi_pair.hpp>
+#include <alps/utilities/mpi_pack.hpp>
 #endif
 
 #include <map>
@@ -65,6 +66,12 @@ namespace alps {
                            descr_==rhs.descr_ &&
                            defnumber_==rhs.defnumber_;
                 }
+#ifdef ALPS_HAVE_MPI
+                /// Pack for an MPI transfer
+                void pack(alps::mpi::packer& p) const { p << typestr_ << descr_ << defnumber_; }
+                /// Unpack
+                void unpack(alps::mpi::unpacker& u) { u >> typestr_ >> descr_ >> defnumber_; }
+#endif
             };
         } // detail::
 
@@ -313,6 +320,12 @@ namespace alps {
             // FIXME: should it be virtual?
             void broadcast(const alps::mpi::communicator& comm, int root);
 
+            /// Packs the parameters for an MPI transfer
+            void pack(alps::mpi::packer& p) const;
+
+            /// Unpacks the parameters
+            void unpack(alps::mpi::unpacker& u);
+
             /// Collective (broadcasting) constructor from command line and parameter files.
             /** Reads and parses the command line on the root process,
                 broadcasts to other processes. Tries to see if the
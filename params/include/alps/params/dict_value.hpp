@@ -50,6 +50,7 @@
 
 #ifdef ALPS_HAVE_MPI
 #include <alps/utilities/mpi.hpp>
+#include <alps/utilities/mpi_pack.hpp>
 #endif
 
 namespace alps {
@@ -153,6 +154,12 @@ namespace alps {
 
 #ifdef ALPS_HAVE_MPI
             void broadcast(const alps::mpi::communicator& comm, int root);
+
+            /// Packs the name and the value for an MPI transfer
+            void pack(alps::mpi::packer& p) const;
+
+            /// Unpacks the name and the value
+            void unpack(alps::mpi::unpacker& u);
 #endif
         };
 
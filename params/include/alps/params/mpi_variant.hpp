@@ -16,9 +16,12 @@
 
 #include <alps/utilities/mpi_vector.hpp>
 #include <alps/utilities/mpi_pair.hpp>
+#include <alps/utilities/mpi_pack.hpp>
 
 #include <alps/params/serialize_variant.hpp>
 
+#include <boost/mpl/size.hpp>
+
 #include <cassert>
 
 namespace alps {
@@ -27,6 +30,12 @@ namespace alps {
         inline void broadcast(const alps::mpi::communicator&, alps::params_ns::detail::None&, int) {
             //std::cout << "DEBUG: Broadcasting None is no-op" << std::endl;
         }
+
+        /// Packing None is no-op
+        inline void pack(packer&, const alps::params_ns::detail::None&) {}
+
+        /// Unpacking None is no-op
+        inline void unpack(unpacker&, alps::params_ns::detail::None&) {}
         
         namespace detail {
             /// Consumer class to send-broadcast an object via MPI
@@ -74,8 +83,66 @@ namespace alps {
             typedef alps::detail::variant_serializer<alps::params_ns::detail::dict_all_types,
                                                      broadcast_sender, broadcast_receiver> var_serializer;
             typedef var_serializer::variant_type variant_type;
-            
+
+            /// Consumer class to pack an object
+            struct pack_sender {
+                packer& packer_;
+
+                explicit pack_sender(packer& p) : packer_(p) {}
+
+                template <typename T>
+                void operator()(const T& val) {
+                    pack(packer_, val);
+                }
+            };
+
+            /// Producer class to unpack an object
+            struct pack_receiver {
+                int target_which;
+                int which_count;
+                unpacker& unpacker_;
+
+                pack_receiver(int which, unpacker& u) : target_which(which), which_count(0), unpacker_(u) {}
+
+                template <typename T>
+                boost::optional<T> operator()(const T*)
+                {
+                    boost::optional<T> ret;
+                    if (target_which==which_count) {
+                        T val;
+                        unpack(unpacker_, val);
+                        ret=val;
+                    }
+                    ++which_count;
+                    return ret;
+                }
+            };
+
         } // detail::
+
+        /// Packs a boost::variant over MPL type sequence MPLSEQ: the index of the bound type, then the value
+        template <typename MPLSEQ>
+        inline void pack_variant(packer& p, const typename boost::make_variant_over<MPLSEQ>::type& var)
+        {
+            typedef alps::detail::variant_serializer<MPLSEQ, detail::pack_sender, detail::pack_receiver> serializer;
+            p << int(var.which());
+            detail::pack_sender consumer(p);
+            serializer::consume(consumer, var);
+        }
+
+        /// Unpacks a boost::variant over MPL type sequence MPLSEQ
+        template <typename MPLSEQ>
+        inline void unpack_variant(unpacker& u, typename boost::make_variant_over<MPLSEQ>::type& var)
+        {
+            typedef alps::detail::variant_serializer<MPLSEQ, detail::pack_sender, detail::pack_receiver> serializer;
+            int which=0;
+            u >> which;
+            if (which<0 || which>=int(boost::mpl::size<MPLSEQ>::value)) {
+                throw std::runtime_error("Invalid variant type index in mpi::unpack_variant()");
+            }
+            detail::pack_receiver producer(which, u);
+            var=serializer::produce(producer);
+        }
         
         /// MPI_BCast of an boost::variant over MPL type sequence MPLSEQ
         template <typename MPLSEQ>
@@ -199,9 +199,19 @@ namespace alps {
 #ifdef ALPS_HAVE_MPI
         void dict_value::broadcast(const alps::mpi::communicator& comm, int root)
         {
-            using alps::mpi::broadcast;
-            broadcast(comm, name_, root);
-            broadcast<detail::dict_all_types>(comm, val_, root);
+            alps::mpi::broadcast_packed(comm, *this, root);
+        }
+
+        void dict_value::pack(alps::mpi::packer& p) const
+        {
+            p << name_;
+            alps::mpi::pack_variant<detail::dict_all_types>(p, val_);
+        }
+
+        void dict_value::unpack(alps::mpi::unpacker& u)
+        {
+            u >> name_;
+            alps::mpi::unpack_variant<detail::dict_all_types>(u, val_);
         }
 #endif
 
@@ -12,7 +12,7 @@
 #include <alps/hdf5/map.hpp>
 
 #ifdef ALPS_HAVE_MPI
-#include <alps/utilities/mpi_map.hpp>
+#include <alps/utilities/mpi_pack.hpp>
 #endif
 
 namespace alps {
@@ -90,10 +90,16 @@ namespace alps {
         }
 
 #ifdef ALPS_HAVE_MPI
-        // Defined here to avoid including <mpi_map.hpp> inside user header
-        void dictionary::broadcast(const alps::mpi::communicator& comm, int root) { 
-            using alps::mpi::broadcast;
-            broadcast(comm, map_, root);
+        void dictionary::broadcast(const alps::mpi::communicator& comm, int root) {
+            alps::mpi::broadcast_packed(comm, *this, root);
+        }
+
+        void dictionary::pack(alps::mpi::packer& p) const {
+            p << map_;
+        }
+
+        void dictionary::unpack(alps::mpi::unpacker& u) {
+            u >> map_;
         }
 #endif
 
@@ -513,12 +513,17 @@ namespace alps {
 
 #ifdef ALPS_HAVE_MPI
         void params::broadcast(const alps::mpi::communicator& comm, int rank) {
-            this->dictionary::broadcast(comm, rank);
-            using alps::mpi::broadcast;
-            broadcast(comm, raw_kv_content_, rank);
-            broadcast(comm, td_map_, rank);
-            broadcast(comm, err_status_, rank);
-            broadcast(comm, origins_.data(), rank);
+            alps::mpi::broadcast_packed(comm, *this, rank);
+        }
+
+        void params::pack(alps::mpi::packer& p) const {
+            this->dictionary::pack(p);
+            p << raw_kv_content_ << td_map_ << err_status_ << origins_.data();
+        }
+
+        void params::unpack(alps::mpi::unpacker& u) {
+            this->dictionary::unpack(u);
+            u >> raw_kv_content_ >> td_map_ >> err_status_ >> origins_.data();
             origins_.check();
         }
 #endif
@@ -10,5 +10,6 @@
 #include <alps/numeric/tensors/tensor_base.hpp>
 #include <alps/numeric/tensors/data_storage.hpp>
 #include <alps/numeric/tensors/data_view.hpp>
+#include <alps/numeric/tensors/static_tensor.hpp>
 
 #endif //ALPSCORE_TENSORS_HPP
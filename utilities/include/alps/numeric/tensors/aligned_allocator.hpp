@@ -0,0 +1,235 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#ifndef ALPSCORE_ALIGNED_ALLOCATOR_HPP
+#define ALPSCORE_ALIGNED_ALLOCATOR_HPP
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <new>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace alps {
+  namespace numerics {
+    namespace detail {
+
+      /// Alignment of the data of every block, enough for aligned AVX-512 loads and for a cache line
+      static const size_t block_alignment = 64;
+      /// Size of the huge pages requested for large blocks
+      static const size_t huge_page_size = size_t(2) << 20;
+
+      /// Bookkeeping stored in front of the data of every block
+      struct block_header {
+        /// usable bytes
+        size_t bytes;
+        /// bytes mapped with mmap, 0 for blocks from the heap
+        size_t mapped;
+      };
+      static_assert(sizeof(block_header) <= block_alignment, "The block header should fit into the alignment");
+
+      inline size_t &huge_page_threshold_bytes() {
+        static size_t threshold = std::numeric_limits<size_t>::max();
+        return threshold;
+      }
+
+      inline block_header &header_of(void *p) {
+        return *reinterpret_cast<block_header *>(static_cast<char *>(p) - block_alignment);
+      }
+
+#ifdef __linux__
+      /// Anonymous mapping of `length` bytes aligned to the huge page size and advised to use huge pages, or 0
+      inline void *map_huge_pages(size_t length) {
+        void *raw = mmap(0, length + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) return 0;
+        uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (begin + huge_page_size - 1) & ~uintptr_t(huge_page_size - 1);
+        if (aligned > begin) munmap(raw, aligned - begin);
+        if (begin + huge_page_size > aligned) munmap(reinterpret_cast<void *>(aligned + length), begin + huge_page_size - aligned);
+#ifdef MADV_HUGEPAGE
+        madvise(reinterpret_cast<void *>(aligned), length, MADV_HUGEPAGE);
+#endif
+        return reinterpret_cast<void *>(aligned);
+      }
+#endif
+
+      /// New block of `bytes` bytes aligned to `block_alignment`
+      inline void *allocate_block(size_t bytes) {
+        if (bytes > std::numeric_limits<size_t>::max() - huge_page_size - block_alignment) throw std::bad_alloc();
+        void *base = 0;
+        size_t mapped = 0;
+#ifdef __linux__
+        if (bytes >= huge_page_threshold_bytes()) {
+          mapped = (bytes + block_alignment + huge_page_size - 1) / huge_page_size * huge_page_size;
+          base = map_huge_pages(mapped);
+          if (!base) mapped = 0;
+        }
+#endif
+        if (!base && posix_memalign(&base, block_alignment, bytes + block_alignment) != 0) throw std::bad_alloc();
+        void *data = static_cast<char *>(base) + block_alignment;
+        header_of(data).bytes = bytes;
+        header_of(data).mapped = mapped;
+        return data;
+      }
+
+      /// Returns a block from `allocate_block` to the system
+      inline void release_block(void *data) {
+        void *base = static_cast<char *>(data) - block_alignment;
+#ifdef __linux__
+        if (header_of(data).mapped) {
+          munmap(base, header_of(data).mapped);
+          return;
+        }
+#endif
+        std::free(base);
+      }
+    }
+
+    /**
+     * Blocks larger than `bytes` are mapped separately and backed by transparent huge pages where the
+     * system supports it (Linux). The default is to never use huge pages.
+     */
+    inline void set_huge_page_threshold(size_t bytes) { detail::huge_page_threshold_bytes() = bytes; }
+    /// Current size above which blocks are backed by huge pages
+    inline size_t huge_page_threshold() { return detail::huge_page_threshold_bytes(); }
+
+    /**
+     * @brief Scoped pool for the blocks of `aligned_allocator`
+     *
+     * While a `memory_arena` exists, blocks freed by `aligned_allocator` in the same thread are kept in the arena
+     * instead of being returned to the system, and new blocks of the same size are taken from it. Temporaries
+     * created in every iteration of a loop (tensors in Green's function arithmetic, work arrays of the transforms)
+     * then reuse the same memory. All kept blocks are released together when the arena is destroyed.
+     * Blocks still in use at that point stay valid and are freed normally later.
+     *
+     * Arenas nest; the innermost one of the current thread is used.
+     */
+    class memory_arena {
+    public:
+      memory_arena() : previous_(current()) { current() = this; }
+      memory_arena(const memory_arena &) = delete;
+      memory_arena &operator=(const memory_arena &) = delete;
+      ~memory_arena() {
+        release();
+        current() = previous_;
+      }
+
+      /// Block of `bytes` bytes, reused from the arena if possible
+      void *allocate(size_t bytes) {
+        std::multimap<size_t, void *>::iterator it = free_.find(bytes);
+        if (it == free_.end()) return detail::allocate_block(bytes);
+        void *data = it->second;
+        free_.erase(it);
+        cached_ -= bytes;
+        return data;
+      }
+
+      /// Keeps the block for later use
+      void deallocate(void *data) {
+        size_t bytes = detail::header_of(data).bytes;
+        free_.insert(std::make_pair(bytes, data));
+        cached_ += bytes;
+      }
+
+      /// Returns all kept blocks to the system
+      void release() {
+        for (std::multimap<size_t, void *>::iterator it = free_.begin(); it != free_.end(); ++it) detail::release_block(it->second);
+        free_.clear();
+        cached_ = 0;
+      }
+
+      /// Bytes kept for reuse
+      size_t cached_bytes() const { return cached_; }
+
+      /// Innermost arena of the calling thread, or 0
+      static memory_arena *&current() {
+        static thread_local memory_arena *arena = 0;
+        return arena;
+      }
+
+    private:
+      memory_arena *previous_;
+      std::multimap<size_t, void *> free_;
+      size_t cached_ = 0;
+    };
+
+    /**
+     * @brief Allocator with 64-byte aligned blocks
+     *
+     * Large blocks are backed by huge pages (see `set_huge_page_threshold`), and blocks are recycled through
+     * the `memory_arena` of the calling thread if there is one.
+     */
+    template<typename T>
+    struct aligned_allocator {
+      typedef T value_type;
+
+      aligned_allocator() noexcept {}
+      template<typename U>
+      aligned_allocator(const aligned_allocator<U> &) noexcept {}
+
+      T *allocate(size_t n) {
+        if (n == 0) return 0;
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) throw std::bad_alloc();
+        memory_arena *arena = memory_arena::current();
+        return static_cast<T *>(arena ? arena->allocate(n * sizeof(T)) : detail::allocate_block(n * sizeof(T)));
+      }
+
+      void deallocate(T *p, size_t) {
+        if (!p) return;
+        memory_arena *arena = memory_arena::current();
+        if (arena) arena->deallocate(p);
+        else detail::release_block(p);
+      }
+
+      /// Elements created without a value are value-initialized, i.e. numbers are zero
+      template<typename U, typename...Args>
+      void construct(U *p, Args &&...args) { ::new(static_cast<void *>(p)) U(std::forward<Args>(args)...); }
+    };
+
+    /**
+     * @brief aligned_allocator that leaves numbers created without a value uninitialized
+     *
+     * Elements created without a value are default-initialized, so that the owner can initialize them in parallel
+     * and the pages are placed near the threads using them.
+     */
+    template<typename T>
+    struct default_init_allocator : aligned_allocator<T> {
+      default_init_allocator() noexcept {}
+      template<typename U>
+      default_init_allocator(const default_init_allocator<U> &) noexcept {}
+
+      template<typename U>
+      void construct(U *p) { ::new(static_cast<void *>(p)) U; }
+      template<typename U>
+      void construct(std::complex<U> *) {}
+      template<typename U, typename...Args>
+      void construct(U *p, Args &&...args) { ::new(static_cast<void *>(p)) U(std::forward<Args>(args)...); }
+    };
+
+    template<typename T, typename U>
+    bool operator==(const aligned_allocator<T> &, const aligned_allocator<U> &) { return true; }
+    template<typename T, typename U>
+    bool operator!=(const aligned_allocator<T> &, const aligned_allocator<U> &) { return false; }
+
+    /// Vector with 64-byte aligned data
+    template<typename T>
+    using aligned_vector = std::vector<T, aligned_allocator<T> >;
+
+    /// Vector with 64-byte aligned data, whose numbers are left uninitialized by the constructor and resize()
+    template<typename T>
+    using default_init_vector = std::vector<T, default_init_allocator<T> >;
+  }
+}
+
+#endif //ALPSCORE_ALIGNED_ALLOCATOR_HPP
@@ -9,6 +9,9 @@
 
 #include <vector>
 
+#include <alps/numeric/tensors/aligned_allocator.hpp>
+#include <alps/numeric/tensors/parallel_policy.hpp>
+
 namespace alps {
   namespace numerics {
     namespace detail {
@@ -21,9 +24,9 @@ namespace alps {
        * @brief Internal data storage class for tensors
        *
        * @tparam T  the scalar type
-       * @tparam Cont  abstraction of the data storage (default vector)
+       * @tparam Cont  abstraction of the data storage (default vector with 64-byte aligned data, initialized in parallel)
        */
-      template<typename T, typename Cont = std::vector<typename std::remove_const<T>::type> >
+      template<typename T, typename Cont = default_init_vector<typename std::remove_const<T>::type> >
       class data_storage {
       private:
         /// internal data storage
@@ -33,15 +36,17 @@ namespace alps {
         /// create data_dtorage from other storage object by copying data into vector
         template<typename T2, typename C2>
         data_storage(const data_storage<T2, C2> & storage) : data_(storage.size()) {
-          std::copy(storage.data(), storage.data() + storage.size(), data());
+          parallel_copy(storage.data(), storage.size(), data());
         };
         template<typename T2, typename C2>
         data_storage(data_storage<T2, C2> && storage) : data_(storage.size()) {
-          std::copy(storage.data(), storage.data() + storage.size(), data());
+          parallel_copy(storage.data(), storage.size(), data());
         };
 
         /// Copy constructor
-        data_storage(const data_storage<T, Cont>& rhs) : data_(rhs.data_) {};
+        data_storage(const data_storage<T, Cont>& rhs) : data_(rhs.size()) {
+          parallel_copy(rhs.data(), rhs.size(), data());
+        };
         /// Move Constructor
         data_storage(data_storage<T, Cont>&& rhs) : data_(rhs.data_) {};
         /// Copy assignment
@@ -49,7 +54,7 @@ namespace alps {
           if(size() != rhs.size()) {
             resize(rhs.size());
           }
-          std::copy(rhs.data(), rhs.data() + rhs.size(), data());
+          parallel_copy(rhs.data(), rhs.size(), data());
           return *this;
         };
         /// Move assignment
@@ -57,7 +62,7 @@ namespace alps {
           if(size() != rhs.size()) {
             resize(rhs.size());
           }
-          std::copy(rhs.data(), rhs.data() + rhs.size(), data());
+          parallel_copy(rhs.data(), rhs.size(), data());
           return *this;
         };
 
@@ -73,27 +78,27 @@ namespace alps {
           if(size() != rhs.size()) {
             resize(rhs.size());
           }
-          std::copy(rhs.data(), rhs.data() + rhs.size(), data());
+          parallel_copy(rhs.data(), rhs.size(), data());
           return *this;
         };
         /// Create data_dtorage from the view object by copying data into underlying container
         template<typename T2>
         data_storage(const data_view<T2> & view)  : data_(view.size()) {
           static_assert(std::is_convertible<T2, T>::value, "View type can not be converted into storage");
-          std::copy(view.data(), view.data() + view.size(), data());
+          parallel_copy(view.data(), view.size(), data());
         }
         /// Move-Create DataStorage from the view object by copying data into underlying container
         template<typename T2>
         data_storage(data_view<T2> && view) noexcept  : data_(view.size()){
-          std::copy(view.data(), view.data() + view.size(), data());
+          parallel_copy(view.data(), view.size(), data());
         };
         /// Create data storage from raw buffer by data copying
         data_storage(const T *data, size_t size) : data_(size) {
-          std::copy(data, data + size, this->data());
+          parallel_copy(data, size, this->data());
         }
         /// Create empty storage of size %size%
         explicit data_storage(size_t size) : data_(size) {
-          std::fill(data(), data()+size, T(0));
+          parallel_fill(data(), size, T(0));
         }
 
         /// @return reference to the data at point i
@@ -115,7 +120,9 @@ namespace alps {
         T* data() {return data_.data();}
         /// Data-storage resize
         void resize(size_t new_size) {
+          size_t old_size = size();
           data_.resize(new_size);
+          if (new_size > old_size) parallel_fill(data() + old_size, new_size - old_size, T(0));
         }
 
         /**
@@ -139,7 +146,7 @@ namespace alps {
       };
     }
     template<typename T>
-    using simple_storage = detail::data_storage<T, std::vector<T> >;
+    using simple_storage = detail::data_storage<T>;
   }
 }
 
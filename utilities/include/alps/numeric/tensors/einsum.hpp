@@ -0,0 +1,381 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#ifndef ALPSCORE_EINSUM_HPP
+#define ALPSCORE_EINSUM_HPP
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <alps/utilities/lru_cache.hpp>
+#include <alps/numeric/tensors/strided_view.hpp>
+#include <alps/numeric/tensors/tensor_base.hpp>
+
+/**
+ * Tensor contractions written with index labels, e.g. `einsum("wac,cd,wdb->wab", S, G, V, G)` computes
+ * S(w,a,b) = \sum_{cd} G(w,a,c) V(c,d) G(w,d,b).
+ *
+ * Labels are single characters. A label that appears in several operands and in the output is a batch index,
+ * labels missing from the output are summed over. Each pairwise contraction is done by permuting the operands
+ * into (batch, free, contracted) and (batch, contracted, free) order and one matrix product per batch index,
+ * using Eigen (which calls an external BLAS if Eigen is configured with EIGEN_USE_BLAS).
+ * For more than two operands the order of the pairwise contractions with the lowest operation count is chosen.
+ * The order depends only on the labels and the shapes; it is computed once and cached (the least recently used
+ * orders are dropped once the cache holds 64 of them).
+ */
+namespace alps {
+  namespace numerics {
+    namespace detail {
+
+      /// Operand of a contraction: data in row-major order and a label for each dimension
+      template<typename T>
+      struct einsum_operand {
+        std::string labels;
+        std::vector<size_t> shape;
+        /// data, either owned or referring to the input tensor
+        const T *data;
+        std::shared_ptr<std::vector<T> > storage;
+
+        size_t size() const {
+          size_t s = 1;
+          for (size_t i = 0; i < shape.size(); ++i) s *= shape[i];
+          return s;
+        }
+        size_t extent(char label) const { return shape[labels.find(label)]; }
+        T *allocate(size_t size) {
+          storage = std::make_shared<std::vector<T> >(size);
+          data = storage->data();
+          return storage->data();
+        }
+      };
+
+      /// Input labels of each operand and the output labels
+      struct einsum_spec {
+        std::vector<std::string> inputs;
+        std::string output;
+      };
+
+      inline einsum_spec parse_einsum(const std::string &spec) {
+        std::string s;
+        for (size_t i = 0; i < spec.size(); ++i) {
+          if (spec[i] != ' ') s += spec[i];
+        }
+        size_t arrow = s.find("->");
+        if (arrow == std::string::npos) throw std::invalid_argument("Contraction '" + spec + "' has no '->'");
+        einsum_spec result;
+        result.output = s.substr(arrow + 2);
+        std::string inputs = s.substr(0, arrow);
+        size_t start = 0;
+        for (;;) {
+          size_t comma = inputs.find(',', start);
+          result.inputs.push_back(inputs.substr(start, comma - start));
+          if (comma == std::string::npos) break;
+          start = comma + 1;
+        }
+        std::vector<std::string> all(result.inputs);
+        all.push_back(result.output);
+        for (size_t i = 0; i < all.size(); ++i) {
+          std::string sorted = all[i];
+          std::sort(sorted.begin(), sorted.end());
+          if (std::unique(sorted.begin(), sorted.end()) != sorted.end())
+            throw std::invalid_argument("Contraction '" + spec + "' repeats a label within one tensor");
+        }
+        for (size_t i = 0; i < result.output.size(); ++i) {
+          bool found = false;
+          for (size_t j = 0; j < result.inputs.size(); ++j) found |= result.inputs[j].find(result.output[i]) != std::string::npos;
+          if (!found) throw std::invalid_argument("Contraction '" + spec + "' has an output label missing from the inputs");
+        }
+        return result;
+      }
+
+      inline bool has_label(const std::string &labels, char c) { return labels.find(c) != std::string::npos; }
+
+      /// Operand with the dimensions reordered as `labels`; refers to the same data if the order does not change
+      template<typename T>
+      einsum_operand<T> einsum_permute(const einsum_operand<T> &op, const std::string &labels) {
+        if (labels == op.labels) return op;
+        einsum_operand<T> result;
+        result.labels = labels;
+        std::vector<size_t> src_strides(op.shape.size());
+        size_t s = 1;
+        for (size_t i = op.shape.size(); i-- > 0; ) {
+          src_strides[i] = s;
+          s *= op.shape[i];
+        }
+        std::vector<copy_dim> layout(labels.size());
+        result.shape.resize(labels.size());
+        for (size_t i = 0; i < labels.size(); ++i) {
+          size_t axis = op.labels.find(labels[i]);
+          result.shape[i] = op.shape[axis];
+          layout[i].extent = op.shape[axis];
+          layout[i].src_stride = src_strides[axis];
+        }
+        s = 1;
+        for (size_t i = labels.size(); i-- > 0; ) {
+          layout[i].dst_stride = s;
+          s *= result.shape[i];
+        }
+        T *dst = result.allocate(result.size());
+        strided_copy(layout, op.data, dst);
+        return result;
+      }
+
+      /// Sums over the labels of the operand that are not in `keep`
+      template<typename T>
+      einsum_operand<T> einsum_reduce(const einsum_operand<T> &op, const std::string &keep) {
+        std::string kept, summed;
+        for (size_t i = 0; i < op.labels.size(); ++i) (has_label(keep, op.labels[i]) ? kept : summed) += op.labels[i];
+        if (summed.empty()) return op;
+        einsum_operand<T> ordered = einsum_permute(op, kept + summed);
+        einsum_operand<T> result;
+        result.labels = kept;
+        result.shape.assign(ordered.shape.begin(), ordered.shape.begin() + kept.size());
+        size_t n = result.size(), m = ordered.size() / std::max(n, size_t(1));
+        T *dst = result.allocate(n);
+        Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, 1> >(dst, n) =
+            Eigen::Map<const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> >(ordered.data, n, m).rowwise().sum();
+        return result;
+      }
+
+      /**
+       * Contracts two operands; labels in `keep` (output and remaining operands) are not summed over.
+       * The result has the labels (batch, free labels of a, free labels of b).
+       */
+      template<typename T>
+      einsum_operand<T> einsum_pair(const einsum_operand<T> &a0, const einsum_operand<T> &b0, const std::string &keep) {
+        std::string keep_a = keep + b0.labels, keep_b = keep + a0.labels;
+        einsum_operand<T> a = einsum_reduce(a0, keep_a), b = einsum_reduce(b0, keep_b);
+        std::string batch, free_a, free_b, contracted;
+        for (size_t i = 0; i < a.labels.size(); ++i) {
+          char c = a.labels[i];
+          if (has_label(b.labels, c)) (has_label(keep, c) ? batch : contracted) += c;
+          else free_a += c;
+        }
+        for (size_t i = 0; i < b.labels.size(); ++i) {
+          if (!has_label(a.labels, b.labels[i])) free_b += b.labels[i];
+        }
+        for (size_t i = 0; i < contracted.size(); ++i) {
+          if (a.extent(contracted[i]) != b.extent(contracted[i]))
+            throw std::invalid_argument(std::string("Contraction over label '") + contracted[i] + "' of different extents");
+        }
+        for (size_t i = 0; i < batch.size(); ++i) {
+          if (a.extent(batch[i]) != b.extent(batch[i]))
+            throw std::invalid_argument(std::string("Contraction with label '") + batch[i] + "' of different extents");
+        }
+        einsum_operand<T> pa = einsum_permute(a, batch + free_a + contracted);
+        einsum_operand<T> pb = einsum_permute(b, batch + contracted + free_b);
+        size_t nbatch = 1, m = 1, n = 1, k = 1;
+        einsum_operand<T> result;
+        result.labels = batch + free_a + free_b;
+        for (size_t i = 0; i < batch.size(); ++i) {
+          nbatch *= a.extent(batch[i]);
+          result.shape.push_back(a.extent(batch[i]));
+        }
+        for (size_t i = 0; i < free_a.size(); ++i) {
+          m *= a.extent(free_a[i]);
+          result.shape.push_back(a.extent(free_a[i]));
+        }
+        for (size_t i = 0; i < free_b.size(); ++i) {
+          n *= b.extent(free_b[i]);
+          result.shape.push_back(b.extent(free_b[i]));
+        }
+        for (size_t i = 0; i < contracted.size(); ++i) k *= a.extent(contracted[i]);
+        typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> matrix_type;
+        T *c = result.allocate(nbatch * m * n);
+        for (size_t i = 0; i < nbatch; ++i) {
+          Eigen::Map<matrix_type>(c + i * m * n, m, n).noalias() =
+              Eigen::Map<const matrix_type>(pa.data + i * m * k, m, k) * Eigen::Map<const matrix_type>(pb.data + i * k * n, k, n);
+        }
+        return result;
+      }
+
+      /// Order of the pairwise contractions: step i contracts two entries of the operand list and appends the result
+      typedef std::vector<std::pair<size_t, size_t> > einsum_plan;
+
+      /**
+       * Contraction order with the lowest operation count, by dynamic programming over subsets of the operands.
+       * The cost of contracting two intermediates is the product of the extents of all their labels.
+       */
+      inline einsum_plan plan_einsum(const std::vector<std::string> &labels, const std::string &output,
+                                     const std::map<char, size_t> &extents) {
+        size_t n = labels.size();
+        if (n > 16) throw std::invalid_argument("Contraction of more than 16 tensors");
+        size_t full = (size_t(1) << n) - 1;
+        // labels of the intermediate result for each subset
+        std::vector<std::string> subset_labels(full + 1);
+        for (size_t s = 1; s <= full; ++s) {
+          std::string inside, outside = output;
+          for (size_t i = 0; i < n; ++i) ((s >> i) & 1 ? inside : outside) += labels[i];
+          for (size_t i = 0; i < inside.size(); ++i) {
+            if (has_label(outside, inside[i]) && !has_label(subset_labels[s], inside[i])) subset_labels[s] += inside[i];
+          }
+        }
+        std::vector<double> cost(full + 1, std::numeric_limits<double>::infinity());
+        std::vector<size_t> split(full + 1, 0);
+        for (size_t s = 1; s <= full; ++s) {
+          if ((s & (s - 1)) == 0) {
+            cost[s] = 0;
+            continue;
+          }
+          for (size_t s1 = (s - 1) & s; s1 > 0; s1 = (s1 - 1) & s) {
+            size_t s2 = s ^ s1;
+            if (s1 < s2) continue;
+            std::string all = subset_labels[s1] + subset_labels[s2];
+            std::sort(all.begin(), all.end());
+            all.erase(std::unique(all.begin(), all.end()), all.end());
+            double flops = 1;
+            for (size_t i = 0; i < all.size(); ++i) flops *= double(extents.find(all[i])->second);
+            double c = cost[s1] + cost[s2] + flops;
+            if (c < cost[s]) {
+              cost[s] = c;
+              split[s] = s1;
+            }
+          }
+        }
+        einsum_plan plan;
+        struct builder {
+          const std::vector<size_t> &split;
+          size_t n;
+          einsum_plan &plan;
+          size_t build(size_t s) {
+            if ((s & (s - 1)) == 0) {
+              size_t i = 0;
+              while (!((s >> i) & 1)) ++i;
+              return i;
+            }
+            size_t a = build(split[s]), b = build(s ^ split[s]);
+            plan.push_back(std::make_pair(a, b));
+            return n + plan.size() - 1;
+          }
+        } b = {split, n, plan};
+        b.build(full);
+        return plan;
+      }
+
+      /**
+       * Contraction orders for given labels and shapes.
+       *
+       * At most `capacity` orders are kept; when a new one is added, the least recently used one is dropped.
+       */
+      class einsum_plan_cache {
+      public:
+        explicit einsum_plan_cache(size_t capacity = 64) : cache_(capacity) {}
+
+        einsum_plan get(const einsum_spec &spec, const std::vector<std::vector<size_t> > &shapes) {
+          key_type key(spec.inputs, shapes);
+          key.first.push_back(spec.output);
+          return cache_.get(key, [&]() {
+            std::map<char, size_t> extents;
+            for (size_t i = 0; i < shapes.size(); ++i)
+              for (size_t j = 0; j < shapes[i].size(); ++j) extents[spec.inputs[i][j]] = shapes[i][j];
+            return plan_einsum(spec.inputs, spec.output, extents);
+          });
+        }
+
+        /// Number of cached orders
+        size_t size() const { return cache_.size(); }
+
+      private:
+        typedef std::pair<std::vector<std::string>, std::vector<std::vector<size_t> > > key_type;
+        alps::lru_cache<key_type, einsum_plan> cache_;
+      };
+
+      /// Cache of the contraction orders used by einsum()
+      inline einsum_plan_cache &global_einsum_plan_cache() {
+        static einsum_plan_cache cache;
+        return cache;
+      }
+
+      /// Contraction order for the given labels and shapes, computed once while it is used
+      inline einsum_plan cached_einsum_plan(const einsum_spec &spec, const std::vector<std::vector<size_t> > &shapes) {
+        return global_einsum_plan_cache().get(spec, shapes);
+      }
+
+      /// Operand referring to the data of the tensor, or a converted copy if the value types differ
+      template<typename T, typename S, size_t D, typename C>
+      einsum_operand<T> make_einsum_operand(const tensor_base<S, D, C> &t) {
+        einsum_operand<T> op;
+        op.shape.assign(t.shape().begin(), t.shape().end());
+        if (std::is_same<typename std::remove_const<S>::type, T>::value) {
+          op.data = reinterpret_cast<const T *>(t.data());
+        } else {
+          T *data = op.allocate(t.size());
+          std::copy(t.data(), t.data() + t.size(), data);
+        }
+        return op;
+      }
+    }
+
+    /**
+     * Evaluates the contraction `spec` (e.g. "wac,cd,wdb->wab") of the tensors `operands` into `out`.
+     * `out` is reshaped if needed; operands of other value types are converted to the value type of `out`.
+     */
+    template<typename T, size_t D, typename C, typename ...Tensors>
+    void einsum(const std::string &spec, detail::tensor_base<T, D, C> &out, const Tensors &...operands) {
+      typedef typename std::remove_const<T>::type value_type;
+      detail::einsum_spec parsed = detail::parse_einsum(spec);
+      std::vector<detail::einsum_operand<value_type> > ops = {detail::make_einsum_operand<value_type>(operands)...};
+      if (parsed.inputs.size() != ops.size())
+        throw std::invalid_argument("Contraction '" + spec + "' does not match the number of tensors");
+      if (parsed.output.size() != D)
+        throw std::invalid_argument("Contraction '" + spec + "' does not match the dimension of the result");
+      std::vector<std::vector<size_t> > shapes;
+      std::map<char, size_t> extents;
+      for (size_t i = 0; i < ops.size(); ++i) {
+        ops[i].labels = parsed.inputs[i];
+        if (ops[i].labels.size() != ops[i].shape.size())
+          throw std::invalid_argument("Contraction '" + spec + "' does not match the dimension of a tensor");
+        shapes.push_back(ops[i].shape);
+        for (size_t j = 0; j < ops[i].shape.size(); ++j) {
+          char c = ops[i].labels[j];
+          if (extents.count(c) && extents[c] != ops[i].shape[j])
+            throw std::invalid_argument(std::string("Contraction with label '") + c + "' of different extents");
+          extents[c] = ops[i].shape[j];
+        }
+      }
+      detail::einsum_plan plan = detail::cached_einsum_plan(parsed, shapes);
+      std::vector<bool> used(ops.size() + plan.size(), false);
+      for (size_t step = 0; step < plan.size(); ++step) {
+        size_t a = plan[step].first, b = plan[step].second;
+        used[a] = used[b] = true;
+        std::string keep = parsed.output;
+        for (size_t i = 0; i < ops.size(); ++i) {
+          if (!used[i]) keep += ops[i].labels;
+        }
+        ops.push_back(detail::einsum_pair(ops[a], ops[b], keep));
+        // release the intermediates
+        ops[a].storage.reset();
+        ops[b].storage.reset();
+      }
+      detail::einsum_operand<value_type> result = detail::einsum_permute(detail::einsum_reduce(ops.back(), parsed.output), parsed.output);
+      std::array<size_t, D> shape;
+      for (size_t i = 0; i < D; ++i) shape[i] = extents[parsed.output[i]];
+      if (out.shape() != shape) out.reshape(shape);
+      std::copy(result.data, result.data + result.size(), out.data());
+    }
+
+    /// Evaluates the contraction `spec` into a new tensor of dimension D, e.g. `einsum<2>("ij,jk->ik", A, B)`
+    template<size_t D, typename T, size_t D1, typename C1, typename ...Tensors>
+    tensor<typename std::remove_const<T>::type, D> einsum(const std::string &spec, const detail::tensor_base<T, D1, C1> &first,
+                                                         const Tensors &...operands) {
+      tensor<typename std::remove_const<T>::type, D> out;
+      einsum(spec, out, first, operands...);
+      return out;
+    }
+  }
+}
+
+#endif //ALPSCORE_EINSUM_HPP
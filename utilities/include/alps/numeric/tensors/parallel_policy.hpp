@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#ifndef ALPSCORE_PARALLEL_POLICY_HPP
+#define ALPSCORE_PARALLEL_POLICY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <alps/utilities/thread_pool.hpp>
+
+namespace alps {
+  namespace numerics {
+    namespace detail {
+      /// Size of the memory pages the ranges of the threads are aligned to
+      static const size_t parallel_page_size = 4096;
+
+      inline size_t gcd(size_t a, size_t b) { return b == 0 ? a : gcd(b, a % b); }
+
+      /// Number of elements of `element_size` bytes before the first page boundary in `data`, 0 if none falls between elements
+      inline size_t elements_to_page(const void *data, size_t element_size) {
+        size_t skew = (parallel_page_size - reinterpret_cast<uintptr_t>(data) % parallel_page_size) % parallel_page_size;
+        return skew % element_size == 0 ? skew / element_size : 0;
+      }
+    }
+
+    /**
+     * @brief How the elementwise operations and reductions of tensors are executed
+     *
+     * The default policy is serial. A parallel policy runs operations on tensors with at least `min_size`
+     * elements on the threads of a `thread_pool`. The elements are split statically: thread t always gets
+     * the t-th of equal ranges, and the range boundaries fall on the memory pages of the data. The tensor storage is
+     * initialized under the same policy, so with the first-touch page placement of the operating system
+     * every thread works on pages of its own NUMA node. For the best locality the threads should be pinned
+     * to cores (e.g. OMP_PROC_BIND-like settings of the batch system or `taskset`).
+     *
+     * The policy is selected for all threads by `parallel_policy::global()`, or for the calling thread
+     * and a scope by `scoped_parallel_policy`.
+     */
+    class parallel_policy {
+    public:
+      /// Tensors smaller than this are processed serially by default
+      static const size_t default_min_size = size_t(1) << 15;
+
+      /// Serial execution
+      parallel_policy() : pool_(0), min_size_(0) {}
+      /// Execution on the threads of `pool` for tensors of at least `min_size` elements
+      explicit parallel_policy(thread_pool &pool, size_t min_size = default_min_size) : pool_(&pool), min_size_(min_size) {}
+
+      thread_pool *pool() const { return pool_; }
+      size_t min_size() const { return min_size_; }
+
+      /// Number of ranges an operation on `n` elements is split into
+      size_t nranges(size_t n) const {
+        return pool_ && n >= min_size_ ? pool_->size() : 1;
+      }
+
+      /**
+       * Calls `f(begin, end)` on disjoint ranges covering [0, n), for elements of `element_size` bytes.
+       * Except for the first and the last one, the ranges start and end on the page boundaries of `data`
+       * (of the element 0 if `data` is not given).
+       */
+      template<typename F>
+      void for_each_range(size_t n, size_t element_size, F f, const void *data = nullptr) const {
+        size_t nr = nranges(n);
+        if (nr <= 1) {
+          if (n > 0) f(size_t(0), n);
+          return;
+        }
+        size_t chunk = detail::parallel_page_size / detail::gcd(detail::parallel_page_size, element_size);
+        size_t first = data ? detail::elements_to_page(data, element_size) : 0;
+        pool_->parallel_for(nr, [&](size_t rbegin, size_t rend) {
+          for (size_t r = rbegin; r < rend; ++r) {
+            size_t begin = bound(n, r, nr, chunk, first), end = bound(n, r + 1, nr, chunk, first);
+            if (begin < end) f(begin, end);
+          }
+        });
+      }
+
+      /**
+       * Reduction over [0, n): `partial(begin, end)` reduces a range, and the partial results are combined
+       * in the order of the ranges with `combine(a, b)`. The ranges are those of `for_each_range`.
+       */
+      template<typename R, typename P, typename C>
+      R reduce(size_t n, size_t element_size, R init, P partial, C combine, const void *data = nullptr) const {
+        size_t nr = nranges(n);
+        if (nr <= 1) return n > 0 ? combine(init, partial(size_t(0), n)) : init;
+        std::vector<R> results(nr, init);
+        std::vector<char> done(nr, 0);
+        size_t chunk = detail::parallel_page_size / detail::gcd(detail::parallel_page_size, element_size);
+        size_t first = data ? detail::elements_to_page(data, element_size) : 0;
+        pool_->parallel_for(nr, [&](size_t rbegin, size_t rend) {
+          for (size_t r = rbegin; r < rend; ++r) {
+            size_t begin = bound(n, r, nr, chunk, first), end = bound(n, r + 1, nr, chunk, first);
+            if (begin < end) {
+              results[r] = partial(begin, end);
+              done[r] = 1;
+            }
+          }
+        });
+        R result = init;
+        for (size_t r = 0; r < nr; ++r) {
+          if (done[r]) result = combine(result, results[r]);
+        }
+        return result;
+      }
+
+      /// Policy used for all threads without a scoped policy; serial unless changed
+      static parallel_policy &global() {
+        static parallel_policy policy;
+        return policy;
+      }
+
+      /// Policy of the calling thread
+      static const parallel_policy &current() {
+        const parallel_policy *scoped = scoped_policy();
+        return scoped ? *scoped : global();
+      }
+
+    private:
+      friend class scoped_parallel_policy;
+
+      thread_pool *pool_;
+      size_t min_size_;
+
+      /// start of range r of nr, rounded down to first + a multiple of chunk
+      static size_t bound(size_t n, size_t r, size_t nr, size_t chunk, size_t first) {
+        if (r >= nr) return n;
+        size_t b = n / nr * r + n % nr * r / nr;
+        if (b < first) return 0;
+        return std::min(n, b - (b - first) % chunk);
+      }
+
+      static const parallel_policy *&scoped_policy() {
+        static thread_local const parallel_policy *policy = 0;
+        return policy;
+      }
+    };
+
+    /**
+     * @brief Policy of the calling thread for the lifetime of the object
+     *
+     * e.g. `{ scoped_parallel_policy p(parallel_policy(alps::thread_pool::global())); G += G2; }`
+     */
+    class scoped_parallel_policy {
+    public:
+      explicit scoped_parallel_policy(const parallel_policy &policy) :
+        policy_(policy), previous_(parallel_policy::scoped_policy()) {
+        parallel_policy::scoped_policy() = &policy_;
+      }
+      scoped_parallel_policy(const scoped_parallel_policy &) = delete;
+      scoped_parallel_policy &operator=(const scoped_parallel_policy &) = delete;
+      ~scoped_parallel_policy() { parallel_policy::scoped_policy() = previous_; }
+
+    private:
+      parallel_policy policy_;
+      const parallel_policy *previous_;
+    };
+
+    /// Copies `n` elements under the policy of the calling thread
+    template<typename S, typename T>
+    void parallel_copy(const S *src, size_t n, T *dst) {
+      parallel_policy::current().for_each_range(n, sizeof(T), [&](size_t begin, size_t end) {
+        std::copy(src + begin, src + end, dst + begin);
+      }, dst);
+    }
+
+    /// Sets `n` elements to `value` under the policy of the calling thread
+    template<typename T, typename S>
+    void parallel_fill(T *dst, size_t n, const S &value) {
+      parallel_policy::current().for_each_range(n, sizeof(T), [&](size_t begin, size_t end) {
+        std::fill(dst + begin, dst + end, T(value));
+      }, dst);
+    }
+  }
+}
+
+#endif //ALPSCORE_PARALLEL_POLICY_HPP
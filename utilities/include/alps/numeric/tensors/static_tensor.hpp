@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#ifndef ALPSCORE_STATIC_TENSOR_HPP
+#define ALPSCORE_STATIC_TENSOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <type_traits>
+
+#include <Eigen/Core>
+#include <Eigen/Dense>
+
+#include <alps/numeric/tensors/tensor_base.hpp>
+
+namespace alps {
+  namespace numerics {
+    namespace detail {
+
+      /// Number of elements of a tensor with extents N...
+      template<size_t...N>
+      struct static_size;
+      template<>
+      struct static_size<> {
+        static constexpr size_t value = 1;
+      };
+      template<size_t N0, size_t...N>
+      struct static_size<N0, N...> {
+        static constexpr size_t value = N0 * static_size<N...>::value;
+      };
+
+      /// Extent of dimension I of a tensor with extents N...
+      template<size_t I, size_t...N>
+      struct static_extent;
+      template<size_t N0, size_t...N>
+      struct static_extent<0, N0, N...> {
+        static constexpr size_t value = N0;
+      };
+      template<size_t I, size_t N0, size_t...N>
+      struct static_extent<I, N0, N...> {
+        static constexpr size_t value = static_extent<I - 1, N...>::value;
+      };
+
+      /// Row-major offset of an element of a tensor with extents N..., evaluated as ((i0 * N1 + i1) * N2 + i2)...
+      template<size_t...N>
+      struct static_index;
+      template<>
+      struct static_index<> {
+        static constexpr size_t offset(size_t acc) { return acc; }
+      };
+      template<size_t N0, size_t...N>
+      struct static_index<N0, N...> {
+        template<typename...Indices>
+        static constexpr size_t offset(size_t acc, size_t i0, Indices...indices) {
+          return static_index<N...>::offset(acc * N0 + i0, indices...);
+        }
+      };
+
+      /// Eigen matrix type for a static tensor of dimension 2; Eigen has no row-major column vectors
+      template<typename T, size_t N0, size_t N1>
+      using static_matrix = Eigen::Matrix < T, int(N0), int(N1), (N1 == 1 && N0 != 1) ? Eigen::ColMajor : Eigen::RowMajor >;
+    }
+
+    /**
+     * @brief Tensor with extents fixed at compile time and the elements stored inline
+     *
+     * Meant for small blocks (e.g. 2x2 to 8x8 orbital matrices) that are created and combined in inner loops:
+     * there is no heap allocation, and the offsets and loop bounds are compile-time constants, so the compiler
+     * unrolls and vectorizes the element loops. The interface follows `tensor`; `view()` gives a `tensor_view`
+     * of the same data for use with code written for general tensors.
+     *
+     * @tparam T - stored data type
+     * @tparam N - extent of each dimension
+     */
+    template<typename T, size_t...N>
+    class static_tensor {
+      static_assert(sizeof...(N) > 0, "Tensor should have at least one dimension");
+      static_assert(detail::static_size<N...>::value > 0, "Tensor extents should be positive");
+    public:
+      typedef T prec;
+      typedef T value_type;
+      static constexpr size_t Dim = sizeof...(N);
+      static constexpr size_t Size = detail::static_size<N...>::value;
+      /// extents of the first and the last dimension, the shape of `matrix()`
+      static constexpr size_t rows = detail::static_extent<0, N...>::value;
+      static constexpr size_t cols = detail::static_extent<Dim - 1, N...>::value;
+      typedef detail::static_matrix<T, rows, cols> matrix_type;
+
+      /// Tensor with all elements set to 0
+      static_tensor() { set_zero(); }
+
+      /// Copy of a general tensor of the same shape
+      template<typename T2, typename C>
+      explicit static_tensor(const detail::tensor_base<T2, Dim, C> &rhs) {
+        if (rhs.shape() != shape()) throw std::invalid_argument("Tensor has a different shape.");
+        std::copy(rhs.data(), rhs.data() + Size, data_);
+      }
+
+      /// sizes for each dimension
+      static std::array<size_t, Dim> shape() { return {{N...}}; }
+      /// dimension of the tensor
+      static constexpr size_t dimension() { return Dim; }
+      /// number of elements
+      static constexpr size_t size() { return Size; }
+
+      /// pointer to the data
+      T *data() { return data_; }
+      const T *data() const { return data_; }
+
+      /// index in the data for the specified indices
+      template<typename...Indices>
+      static constexpr size_t index(Indices...indices) {
+        static_assert(sizeof...(Indices) == Dim, "Wrong number of indices");
+        return detail::static_index<N...>::offset(0, size_t(indices)...);
+      }
+
+      /// element at the (indices...) point
+      template<typename...Indices>
+      T &operator()(Indices...indices) { return data_[index(indices...)]; }
+      template<typename...Indices>
+      const T &operator()(Indices...indices) const { return data_[index(indices...)]; }
+
+      /// view of the data as a general tensor
+      tensor_view<T, Dim> view() { return tensor_view<T, Dim>(data_, shape()); }
+      tensor_view<const T, Dim> view() const { return tensor_view<const T, Dim>(data_, shape()); }
+
+      /// Set data to 0
+      void set_zero() { set_number(T(0)); }
+
+      /// Assign all the values in the tensor to the specific scalar
+      template<typename S>
+      void set_number(S value) {
+        for (size_t i = 0; i < Size; ++i) data_[i] = T(value);
+      }
+
+      template<typename T2>
+      bool operator==(const static_tensor<T2, N...> &rhs) const {
+        return std::equal(data_, data_ + Size, rhs.data());
+      }
+      template<typename T2>
+      bool operator!=(const static_tensor<T2, N...> &rhs) const { return !(*this == rhs); }
+
+      /*
+       * Basic arithmetic operations
+       */
+      template<typename T2>
+      static_tensor &operator+=(const static_tensor<T2, N...> &rhs) {
+        const T2 *r = rhs.data();
+        for (size_t i = 0; i < Size; ++i) data_[i] += r[i];
+        return *this;
+      }
+      template<typename T2>
+      static_tensor &operator-=(const static_tensor<T2, N...> &rhs) {
+        const T2 *r = rhs.data();
+        for (size_t i = 0; i < Size; ++i) data_[i] -= r[i];
+        return *this;
+      }
+      template<typename S>
+      typename std::enable_if<std::is_convertible<S, T>::value, static_tensor &>::type operator*=(S scalar) {
+        T s = T(scalar);
+        for (size_t i = 0; i < Size; ++i) data_[i] *= s;
+        return *this;
+      }
+      template<typename S>
+      typename std::enable_if<std::is_convertible<S, T>::value, static_tensor &>::type operator/=(S scalar) {
+        return *this *= T(1.0) / T(scalar);
+      }
+
+      static_tensor operator+(const static_tensor &rhs) const {
+        static_tensor x(*this);
+        return x += rhs;
+      }
+      static_tensor operator-(const static_tensor &rhs) const {
+        static_tensor x(*this);
+        return x -= rhs;
+      }
+      static_tensor operator-() const {
+        static_tensor x;
+        for (size_t i = 0; i < Size; ++i) x.data_[i] = -data_[i];
+        return x;
+      }
+      template<typename S>
+      typename std::enable_if<std::is_convertible<S, T>::value, static_tensor>::type operator*(S scalar) const {
+        static_tensor x(*this);
+        return x *= scalar;
+      }
+      template<typename S>
+      typename std::enable_if<std::is_convertible<S, T>::value, static_tensor>::type operator/(S scalar) const {
+        static_tensor x(*this);
+        return x /= scalar;
+      }
+
+      /**
+       * @return Eigen matrix representation for 2D Tensor
+       */
+      Eigen::Map<matrix_type> matrix() {
+        static_assert(Dim == 2, "Can not return Eigen matrix view for not 2D tensor.");
+        return Eigen::Map<matrix_type>(data_);
+      }
+      Eigen::Map<const matrix_type> matrix() const {
+        static_assert(Dim == 2, "Can not return Eigen matrix view for not 2D tensor.");
+        return Eigen::Map<const matrix_type>(data_);
+      }
+
+      /**
+       * Compute a dot product of two 2D tensors
+       */
+      template<size_t K>
+      static_tensor<T, rows, K> dot(const static_tensor<T, cols, K> &y) const {
+        static_assert(Dim == 2, "Can not do multiplication for not 2D tensor.");
+        static_tensor<T, rows, K> x;
+        x.matrix().noalias() = matrix() * y.matrix();
+        return x;
+      }
+
+      /**
+       * For 2D square Tensor compute inverse Tensor.
+       * @return inversed Tensor
+       */
+      static_tensor inverse() const {
+        static_assert(Dim == 2 && rows == cols, "Can not do inversion of the non-square matrix.");
+        static_tensor x;
+        x.matrix() = matrix().inverse();
+        return x;
+      }
+
+    private:
+      T data_[Size];
+    };
+  }
+}
+
+#endif //ALPSCORE_STATIC_TENSOR_HPP
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#ifndef ALPSCORE_STRIDED_VIEW_HPP
+#define ALPSCORE_STRIDED_VIEW_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace alps {
+  namespace numerics {
+    namespace detail {
+
+      /// One dimension of a strided copy: extent, source stride and destination stride
+      struct copy_dim {
+        size_t extent;
+        size_t src_stride;
+        size_t dst_stride;
+      };
+
+      /**
+       * Calls `f(src_offset, dst_offset)` for every point of the dimensions `dims` (odometer order, last dimension fastest)
+       */
+      template<typename F>
+      void for_each_offset(const std::vector<copy_dim> &dims, F f) {
+        size_t total = 1;
+        for (size_t i = 0; i < dims.size(); ++i) total *= dims[i].extent;
+        std::vector<size_t> idx(dims.size(), 0);
+        size_t src = 0, dst = 0;
+        for (size_t n = 0; n < total; ++n) {
+          f(src, dst);
+          for (size_t i = dims.size(); i-- > 0; ) {
+            src += dims[i].src_stride;
+            dst += dims[i].dst_stride;
+            if (++idx[i] < dims[i].extent) break;
+            src -= dims[i].extent * dims[i].src_stride;
+            dst -= dims[i].extent * dims[i].dst_stride;
+            idx[i] = 0;
+          }
+        }
+      }
+
+      /**
+       * Copy between two strided layouts of the same shape.
+       *
+       * Dimensions of extent 1 are dropped and neighbouring dimensions that are contiguous in both layouts are merged.
+       * If the innermost dimension has unit stride on both sides the data is copied in contiguous runs.
+       * If the destination is contiguous in a dimension in which the source is not, but the source is contiguous in
+       * another dimension, the two dimensions are transposed in square tiles that stay in the L1 cache, with unit-stride
+       * inner loops. Otherwise the elements are copied one by one.
+       */
+      template<typename S, typename T>
+      void strided_copy(const std::vector<copy_dim> &layout, const S *src, T *dst) {
+        static const size_t tile = 64 / sizeof(T) > 8 ? 64 / sizeof(T) : 8;
+        std::vector<copy_dim> dims;
+        for (size_t i = 0; i < layout.size(); ++i) {
+          const copy_dim &d = layout[i];
+          if (d.extent == 0) return;
+          if (d.extent == 1) continue;
+          if (!dims.empty() && dims.back().src_stride == d.src_stride * d.extent &&
+              dims.back().dst_stride == d.dst_stride * d.extent) {
+            dims.back().extent *= d.extent;
+            dims.back().src_stride = d.src_stride;
+            dims.back().dst_stride = d.dst_stride;
+          } else {
+            dims.push_back(d);
+          }
+        }
+        if (dims.empty()) {
+          *dst = *src;
+          return;
+        }
+        copy_dim inner = dims.back();
+        if (inner.src_stride == 1 && inner.dst_stride == 1) {
+          dims.pop_back();
+          for_each_offset(dims, [&](size_t s, size_t d) {
+            std::copy(src + s, src + s + inner.extent, dst + d);
+          });
+          return;
+        }
+        // source dimension with unit stride, to be transposed with the innermost one
+        size_t p = dims.size();
+        for (size_t i = 0; i + 1 < dims.size(); ++i) {
+          if (dims[i].src_stride == 1) p = i;
+        }
+        if (inner.dst_stride == 1 && p < dims.size()) {
+          copy_dim outer = dims[p];
+          dims.erase(dims.begin() + p);
+          dims.pop_back();
+          for_each_offset(dims, [&](size_t s, size_t d) {
+            for (size_t ib = 0; ib < outer.extent; ib += tile) {
+              size_t ie = std::min(ib + tile, outer.extent);
+              for (size_t jb = 0; jb < inner.extent; jb += tile) {
+                size_t je = std::min(jb + tile, inner.extent);
+                for (size_t j = jb; j < je; ++j) {
+                  const S *from = src + s + j * inner.src_stride;
+                  T *to = dst + d + j;
+                  for (size_t i = ib; i < ie; ++i) to[i * outer.dst_stride] = from[i];
+                }
+              }
+            }
+          });
+          return;
+        }
+        dims.pop_back();
+        for_each_offset(dims, [&](size_t s, size_t d) {
+          for (size_t j = 0; j < inner.extent; ++j) dst[d + j * inner.dst_stride] = src[s + j * inner.src_stride];
+        });
+      }
+
+      /// Copy between two strided layouts of the same shape, see above
+      template<typename S, typename T, size_t D>
+      void strided_copy(const std::array<size_t, D> &shape, const std::array<size_t, D> &src_strides, const S *src,
+                        const std::array<size_t, D> &dst_strides, T *dst) {
+        std::vector<copy_dim> layout(D);
+        for (size_t i = 0; i < D; ++i) {
+          copy_dim d = {shape[i], src_strides[i], dst_strides[i]};
+          layout[i] = d;
+        }
+        strided_copy(layout, src, dst);
+      }
+
+      /// Row-major strides for the given shape
+      template<size_t D>
+      std::array<size_t, D> row_major_strides(const std::array<size_t, D> &shape) {
+        std::array<size_t, D> strides;
+        size_t s = 1;
+        for (size_t i = D; i-- > 0; ) {
+          strides[i] = s;
+          s *= shape[i];
+        }
+        return strides;
+      }
+
+      /**
+       * @brief View of a tensor with arbitrary stride in each dimension
+       *
+       * The view refers to the data of an existing tensor and is obtained by permuting the axes or by fixing
+       * the index of an arbitrary dimension. It does not own the data; assigning it to a tensor copies the
+       * elements into row-major order with `strided_copy`.
+       *
+       * @tparam T   - stored data type, const for read-only views
+       * @tparam Dim - dimension of the view
+       */
+      template<typename T, size_t Dim>
+      class strided_tensor_view {
+      public:
+        typedef T prec;
+        typedef typename std::remove_const<T>::type value_type;
+
+        strided_tensor_view(T *data, const std::array<size_t, Dim> &shape, const std::array<size_t, Dim> &strides) :
+          data_(data), shape_(shape), strides_(strides) {}
+
+        /// non-const view to a const view
+        template<typename T2, typename = typename std::enable_if<std::is_same<const T2, T>::value>::type>
+        strided_tensor_view(const strided_tensor_view<T2, Dim> &rhs) :
+          data_(rhs.data()), shape_(rhs.shape()), strides_(rhs.strides()) {}
+
+        /// sizes for each dimension
+        const std::array<size_t, Dim> &shape() const { return shape_; }
+        /// distance in elements between neighbouring points in each dimension
+        const std::array<size_t, Dim> &strides() const { return strides_; }
+        /// pointer to the first element
+        T *data() const { return data_; }
+        /// number of elements
+        size_t size() const {
+          size_t s = 1;
+          for (size_t i = 0; i < Dim; ++i) s *= shape_[i];
+          return s;
+        }
+        /// true if the elements are stored in row-major order without gaps
+        bool is_contiguous() const {
+          return strides_ == row_major_strides(shape_);
+        }
+
+        /// element at the given indices
+        template<typename ...Indices>
+        T &operator()(size_t i1, Indices...indices) const {
+          static_assert(sizeof...(Indices) + 1 == Dim, "Wrong number of indices");
+          std::array<size_t, Dim> idx = {{i1, size_t(indices)...}};
+          size_t offset = 0;
+          for (size_t i = 0; i < Dim; ++i) offset += idx[i] * strides_[i];
+          return data_[offset];
+        }
+
+        /**
+         * View with permuted axes: dimension i of the result is dimension Axes[i] of this view,
+         * e.g. `permute<1,0,2,3>()` exchanges the first two dimensions.
+         */
+        template<size_t...Axes>
+        strided_tensor_view<T, Dim> permute() const {
+          static_assert(sizeof...(Axes) == Dim, "Permutation should list every axis once");
+          std::array<size_t, Dim> axes = {{Axes...}};
+          return permute(axes);
+        }
+
+        /// View with permuted axes, axes given at run time
+        strided_tensor_view<T, Dim> permute(const std::array<size_t, Dim> &axes) const {
+          std::array<bool, Dim> seen;
+          seen.fill(false);
+          std::array<size_t, Dim> shape, strides;
+          for (size_t i = 0; i < Dim; ++i) {
+            if (axes[i] >= Dim || seen[axes[i]]) throw std::invalid_argument("Permutation should list every axis once");
+            seen[axes[i]] = true;
+            shape[i] = shape_[axes[i]];
+            strides[i] = strides_[axes[i]];
+          }
+          return strided_tensor_view<T, Dim>(data_, shape, strides);
+        }
+
+        /// View of dimension Dim-1 with the index of dimension Axis fixed to `index`
+        template<size_t Axis>
+        strided_tensor_view<T, Dim - 1> slice(size_t index) const {
+          static_assert(Axis < Dim && Dim > 1, "Wrong axis");
+          std::array<size_t, Dim - 1> shape, strides;
+          for (size_t i = 0, j = 0; i < Dim; ++i) {
+            if (i == Axis) continue;
+            shape[j] = shape_[i];
+            strides[j] = strides_[i];
+            ++j;
+          }
+          return strided_tensor_view<T, Dim - 1>(data_ + index * strides_[Axis], shape, strides);
+        }
+
+        /// Copy the elements in row-major order into `out`
+        template<typename T2>
+        void copy_to(T2 *out) const {
+          strided_copy(shape_, strides_, data_, row_major_strides(shape_), out);
+        }
+
+        /// Copy the elements of the row-major array `in` into the viewed data
+        template<typename T2>
+        void copy_from(const T2 *in) const {
+          strided_copy(shape_, row_major_strides(shape_), in, strides_, data_);
+        }
+
+      private:
+        T *data_;
+        std::array<size_t, Dim> shape_;
+        std::array<size_t, Dim> strides_;
+      };
+    }
+
+    /// View of a tensor with arbitrary strides
+    template<typename T, size_t D>
+    using strided_view = detail::strided_tensor_view<T, D>;
+  }
+}
+
+#endif //ALPSCORE_STRIDED_VIEW_HPP
@@ -9,6 +9,7 @@
 
 
 #include <array>
+#include <functional>
 #include <iostream>
 #include <numeric>
 #include <type_traits>
@@ -20,6 +21,9 @@
 #include <alps/type_traits/index_sequence.hpp>
 #include <alps/type_traits/are_all_integrals.hpp>
 #include <alps/numeric/tensors/data_view.hpp>
+#include <alps/numeric/tensors/strided_view.hpp>
+#include <alps/numeric/tensors/parallel_policy.hpp>
+#include <alps/numeric/tensors/tensor_expression.hpp>
 
 
 namespace alps {
@@ -36,6 +40,24 @@ namespace alps {
             std::is_same < St, data_view < T > > ::value;
       };
 
+      /**
+       * Alignment of the data of a storage that Eigen may assume
+       *
+       * @tparam St - storage type
+       */
+      template<typename St>
+      struct storage_alignment {
+        static constexpr int value = Eigen::Unaligned;
+      };
+      template<typename T>
+      struct storage_alignment<data_storage < T, aligned_vector < typename std::remove_const<T>::type > > > {
+        static constexpr int value = Eigen::Aligned64;
+      };
+      template<typename T>
+      struct storage_alignment<data_storage < T, default_init_vector < typename std::remove_const<T>::type > > > {
+        static constexpr int value = Eigen::Aligned64;
+      };
+
       /**
        * Check that all values in pack are true
        *
@@ -105,6 +127,9 @@ namespace alps {
         /// generic tensor type
         template<typename St>
         using   genericTensor = tensor_base < T, Dim, St >;
+        /// map of the whole storage as a row vector, aligned if the storage is
+        template<typename X>
+        using   storageMap = Eigen::Map < X, storage_alignment < Container >::value >;
 
       private:
         // fields definitions
@@ -207,6 +232,21 @@ namespace alps {
         template<typename T2, typename St, typename = std::enable_if<std::is_same<Container, storageType>::value, void >>
         tensor_base(tensor_base<T2, Dim, St> &&rhs) noexcept: storage_(rhs.storage()), shape_(rhs.shape()), acc_sizes_(rhs.acc_sizes()) {}
 
+        /// evaluate tensor expression into new tensor
+        template<typename E, typename X = Container, typename = typename std::enable_if<std::is_same<X, storageType>::value>::type>
+        tensor_base(const tensor_expression<E> &expr) : storage_(expr.derived().size()), shape_(expr.derived().shape()) {
+          static_assert(E::dimension == Dim, "Tensor expression has different dimension.");
+          fill_acc_sizes();
+          assign(expr.derived());
+        }
+
+        /// copy the elements of a strided view into new tensor
+        template<typename T2, typename X = Container, typename = typename std::enable_if<std::is_same<X, storageType>::value>::type>
+        tensor_base(const strided_tensor_view<T2, Dim> &view) : storage_(view.size()), shape_(view.shape()) {
+          fill_acc_sizes();
+          view.copy_to(storage_.data());
+        }
+
         /// Different type assignment
         template<typename T2, typename St>
         tensor_base < T, Dim, Container > &operator=(const tensor_base < T2, Dim, St> &rhs){
@@ -218,6 +258,31 @@ namespace alps {
         tensor_base < T, Dim, Container > &operator=(const tensor_base < T, Dim, Container > &rhs) = default;
         /// Move assignment
         tensor_base < T, Dim, Container > &operator=(tensor_base < T, Dim, Container > &&rhs) = default;
+        /// Evaluate tensor expression in a single loop over the elements
+        template<typename E>
+        tType &operator=(const tensor_expression<E> &expr) {
+          static_assert(E::dimension == Dim, "Tensor expression has different dimension.");
+          if (shape_ != expr.derived().shape()) {
+            reshape(expr.derived().shape());
+          }
+          assign(expr.derived());
+          return *this;
+        }
+        /// Copy the elements of a strided view, e.g. `Y = X.permute<1,0,2>();`
+        template<typename T2>
+        tType &operator=(const strided_tensor_view<T2, Dim> &view) {
+          const T *begin = storage_.data(), *end = storage_.data() + storage_.size();
+          if (std::less_equal<const void *>()(begin, view.data()) && std::less<const void *>()(view.data(), end)) {
+            // the view refers to our own data
+            tensor<typename std::remove_const<T>::type, Dim> copy(view);
+            return *this = copy.strided();
+          }
+          if (shape_ != view.shape()) {
+            reshape(view.shape());
+          }
+          view.copy_to(storage_.data());
+          return *this;
+        }
         /// compare tensors
         template<typename T2, typename St>
         bool operator==(const tensor_base<T2, Dim, St>& rhs) const {
@@ -308,8 +373,11 @@ namespace alps {
         template<typename S>
         typename std::enable_if < !std::is_same < S, tensorType >::value, tType & >::type operator*=(S scalar) {
           static_assert(std::is_convertible<S, T>::value, "Can't perform inplace multiplication: S can be casted into T");
-          Eigen::Map < Eigen::Matrix < T, 1, Eigen::Dynamic > > M(&storage_.data(0), storage_.size());
-          M *= T(scalar);
+          T s = T(scalar);
+          for_each_block([&](size_t begin, size_t end) {
+            storageMap < Eigen::Matrix < T, 1, Eigen::Dynamic > > M(storage_.data() + begin, end - begin);
+            M *= s;
+          });
           return *this;
         };
 
@@ -318,9 +386,11 @@ namespace alps {
          */
         template<typename S>
         typename std::enable_if < std::is_same < S, tensorType >::value, tensorType & >::type operator*=(const S& rhs) {
-          Eigen::Map < Eigen::Array < T, 1, Eigen::Dynamic > > M1(&storage_.data(0), storage_.size());
-          Eigen::Map < const Eigen::Array < T, 1, Eigen::Dynamic > > M2(&rhs.storage().data(0), rhs.storage().size());
-          M1*=M2;
+          for_each_block([&](size_t begin, size_t end) {
+            storageMap < Eigen::Array < T, 1, Eigen::Dynamic > > M1(storage_.data() + begin, end - begin);
+            Eigen::Map < const Eigen::Array < T, 1, Eigen::Dynamic > > M2(rhs.storage().data() + begin, end - begin);
+            M1 *= M2;
+          });
           return *this;
         };
 
@@ -340,8 +410,11 @@ namespace alps {
         template<typename S>
         typename std::enable_if < !std::is_same < S, tensorType >::value, tType & >::type operator/=(S scalar) {
           static_assert(std::is_convertible<S, T>::value, "Can not perform inplace division: S can be casted into T");
-          Eigen::Map < Eigen::Matrix < T, 1, Eigen::Dynamic > > M(&storage_.data(0), storage_.size());
-          M *= T(1.0)/T(scalar);
+          T s = T(1.0)/T(scalar);
+          for_each_block([&](size_t begin, size_t end) {
+            storageMap < Eigen::Matrix < T, 1, Eigen::Dynamic > > M(storage_.data() + begin, end - begin);
+            M *= s;
+          });
           return *this;
         };
 
@@ -368,7 +441,7 @@ namespace alps {
         template<typename num_type>
         void set_number(num_type value) {
           static_assert(std::is_convertible<num_type, T>::value, "Can not assign value to the tensor. Value can not be cast into the tensor value type.");
-          std::fill_n(data(), size(), T(value));
+          parallel_fill(data(), size(), T(value));
         }
 
         /**
@@ -385,6 +458,29 @@ namespace alps {
           return storage_.size();
         }
 
+        /**
+         * @return sum of all elements
+         */
+        typename std::remove_const<T>::type sum() const {
+          typedef typename std::remove_const<T>::type value_type;
+          const T *data = storage_.data();
+          return parallel_policy::current().reduce(storage_.size(), sizeof(T), value_type(0), [&](size_t begin, size_t end) {
+            return ConstMatrixMap < value_type, 1, Eigen::Dynamic >(data + begin, end - begin).sum();
+          }, std::plus<value_type>(), data);
+        }
+
+        /**
+         * @return largest absolute value of the elements, 0 for an empty tensor
+         */
+        typename Eigen::NumTraits<typename std::remove_const<T>::type>::Real max_abs() const {
+          typedef typename std::remove_const<T>::type value_type;
+          typedef typename Eigen::NumTraits<value_type>::Real real_type;
+          const T *data = storage_.data();
+          return parallel_policy::current().reduce(storage_.size(), sizeof(T), real_type(0), [&](size_t begin, size_t end) {
+            return ConstMatrixMap < value_type, 1, Eigen::Dynamic >(data + begin, end - begin).cwiseAbs().maxCoeff();
+          }, [](real_type a, real_type b) { return std::max(a, b); }, data);
+        }
+
         /**
          * For 2D square Tensor compute inverse Tensor.
          * @return inversed Tensor
@@ -431,9 +527,11 @@ namespace alps {
         typename std::enable_if <
           std::is_same < S, T >::value || std::is_same < T, std::complex < double>>::value
           || std::is_same < T, std::complex < float>>::value, tType & >::type operator+=(const tensor_base < S, Dim, Ct > &y) {
-          MatrixMap < T, 1, Eigen::Dynamic > M1(&storage_.data(0), storage_.size());
-          ConstMatrixMap < S, 1, Eigen::Dynamic > M2(&y.storage().data(0), y.storage().size());
-          M1.noalias() += M2;
+          for_each_block([&](size_t begin, size_t end) {
+            storageMap < Eigen::Matrix < T, 1, Eigen::Dynamic > > M1(storage_.data() + begin, end - begin);
+            ConstMatrixMap < S, 1, Eigen::Dynamic > M2(y.storage().data() + begin, end - begin);
+            M1.noalias() += M2;
+          });
           return (*this);
         };
 
@@ -443,12 +541,46 @@ namespace alps {
         template<typename S>
         typename std::enable_if < std::is_same < S, tensorType >::value ||
             std::is_same < S, tensorViewType >::value, tType & >::type operator-=(const S &y) {
-          MatrixMap < T, 1, Eigen::Dynamic > M1(&storage_.data(0), storage_.size());
-          ConstMatrixMap < T, 1, Eigen::Dynamic> M2(&y.storage().data(0), y.storage().size());
-          M1.noalias() -= M2;
+          for_each_block([&](size_t begin, size_t end) {
+            storageMap < Eigen::Matrix < T, 1, Eigen::Dynamic > > M1(storage_.data() + begin, end - begin);
+            ConstMatrixMap < T, 1, Eigen::Dynamic> M2(y.storage().data() + begin, end - begin);
+            M1.noalias() -= M2;
+          });
           return (*this);
         };
 
+        /**
+         * Inplace addition of tensor expression
+         */
+        template<typename E>
+        tType &operator+=(const tensor_expression<E> &expr) {
+          check_expression_shape(expr.derived());
+          const E &e = expr.derived();
+          T *data = storage_.data();
+          for_each_block([&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+              data[i] += e[i];
+            }
+          });
+          return *this;
+        }
+
+        /**
+         * Inplace subtraction of tensor expression
+         */
+        template<typename E>
+        tType &operator-=(const tensor_expression<E> &expr) {
+          check_expression_shape(expr.derived());
+          const E &e = expr.derived();
+          T *data = storage_.data();
+          for_each_block([&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+              data[i] -= e[i];
+            }
+          });
+          return *this;
+        }
+
         /**
          * Compute a dot product of two 2D tensors
          */
@@ -476,6 +608,28 @@ namespace alps {
         /// sizes for each dimension
         const std::array < size_t, Dim > &shape() const { return shape_; };
 
+        /// strided view of the whole tensor
+        strided_tensor_view < T, Dim > strided() {
+          return strided_tensor_view < T, Dim >(storage_.data(), shape_, acc_sizes_);
+        }
+        /// read-only strided view of the whole tensor
+        strided_tensor_view < const T, Dim > strided() const {
+          return strided_tensor_view < const T, Dim >(storage_.data(), shape_, acc_sizes_);
+        }
+
+        /**
+         * View with permuted axes; dimension i of the view is dimension Axes[i] of the tensor.
+         * Assigning the view to a tensor materializes the permutation with a cache-blocked copy.
+         */
+        template<size_t...Axes>
+        strided_tensor_view < T, Dim > permute() {
+          return strided().template permute<Axes...>();
+        }
+        template<size_t...Axes>
+        strided_tensor_view < const T, Dim > permute() const {
+          return strided().template permute<Axes...>();
+        }
+
         /// reshape with index list
         template<typename ...Inds>
         typename std::enable_if<are_all_integrals<Inds...>::value>::type reshape(Inds...inds) {
@@ -529,6 +683,29 @@ namespace alps {
         }
 
       private:
+        /// write values of the expression into the data buffer
+        template<typename E>
+        void assign(const E &e) {
+          T *data = storage_.data();
+          for_each_block([&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+              data[i] = e[i];
+            }
+          });
+        }
+        /// call f(begin, end) on ranges of the data under the parallel policy of the calling thread
+        template<typename F>
+        void for_each_block(F f) const {
+          parallel_policy::current().for_each_range(storage_.size(), sizeof(T), f, storage_.data());
+        }
+        /// check that expression and tensor have the same shape
+        template<typename E>
+        void check_expression_shape(const E &e) const {
+          static_assert(E::dimension == Dim, "Tensor expression has different dimension.");
+          if (shape_ != e.shape()) {
+            throw std::invalid_argument("Tensor expression has different shape.");
+          }
+        }
         /**
          * Internal implementation of indexing
          */
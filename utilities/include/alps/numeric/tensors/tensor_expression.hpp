@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#ifndef ALPSCORE_TENSOR_EXPRESSION_HPP
+#define ALPSCORE_TENSOR_EXPRESSION_HPP
+
+#include <array>
+#include <complex>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace alps {
+  namespace numerics {
+    namespace detail {
+      template<typename T, size_t D, typename C>
+      class tensor_base;
+
+      /**
+       * @brief Base class of the lazily evaluated element-wise tensor expressions
+       *
+       * An expression is a tree of operations on tensors that is evaluated only when it is assigned to a tensor.
+       * The whole tree is then computed in a single loop over the elements, without temporary tensors.
+       * Every expression type `E` provides
+       *   - `value_type` and the static `dimension`,
+       *   - `shape()` - sizes for each dimension,
+       *   - `size()` - total number of elements,
+       *   - `operator[](i)` - value of the i-th element in the row-major order.
+       *
+       * Operands are held by reference, so expressions should not outlive the tensors they are built from.
+       *
+       * @tparam E - type of the derived expression
+       */
+      template<typename E>
+      struct tensor_expression {
+        const E &derived() const { return static_cast<const E &>(*this); }
+      };
+
+      /// Check if the type can be used as a scalar factor in the tensor expression
+      template<typename S>
+      struct is_expression_scalar : std::is_arithmetic<S> {};
+      template<typename S>
+      struct is_expression_scalar<std::complex<S> > : std::true_type {};
+
+      /// Type of the scalar factor: integers are converted into the expression value type
+      template<typename S, typename V>
+      struct expression_scalar {
+        typedef typename std::conditional<std::is_integral<S>::value, V, S>::type type;
+      };
+
+      /**
+       * Leaf of the expression tree, refers to the data of the existing tensor
+       */
+      template<typename T, size_t Dim, typename Container>
+      class tensor_leaf : public tensor_expression<tensor_leaf<T, Dim, Container> > {
+        const tensor_base<T, Dim, Container> &tensor_;
+      public:
+        typedef typename std::remove_const<T>::type value_type;
+        static constexpr size_t dimension = Dim;
+
+        explicit tensor_leaf(const tensor_base<T, Dim, Container> &tensor) : tensor_(tensor) {}
+
+        const std::array<size_t, dimension> &shape() const { return tensor_.shape(); }
+        size_t size() const { return tensor_.size(); }
+        value_type operator[](size_t i) const { return tensor_.data()[i]; }
+      };
+
+      /**
+       * Element-wise sum or difference of two expressions of the same shape
+       *
+       * @tparam L   - left-hand side expression
+       * @tparam R   - right-hand side expression
+       * @tparam Neg - true for the difference
+       */
+      template<typename L, typename R, bool Neg>
+      class tensor_sum : public tensor_expression<tensor_sum<L, R, Neg> > {
+        L lhs_;
+        R rhs_;
+      public:
+        typedef decltype(typename L::value_type{} + typename R::value_type{}) value_type;
+        static constexpr size_t dimension = L::dimension;
+
+        tensor_sum(const L &lhs, const R &rhs) : lhs_(lhs), rhs_(rhs) {
+          static_assert(L::dimension == R::dimension, "Tensor expressions should have the same dimension.");
+          if (lhs_.shape() != rhs_.shape()) {
+            throw std::invalid_argument("Tensor expressions have different shapes.");
+          }
+        }
+
+        const std::array<size_t, dimension> &shape() const { return lhs_.shape(); }
+        size_t size() const { return lhs_.size(); }
+        value_type operator[](size_t i) const {
+          return Neg ? value_type(lhs_[i]) - value_type(rhs_[i]) : value_type(lhs_[i]) + value_type(rhs_[i]);
+        }
+      };
+
+      /**
+       * Expression multiplied by a scalar
+       *
+       * @tparam E - expression to scale
+       * @tparam S - type of the scalar factor
+       */
+      template<typename E, typename S>
+      class tensor_scaled : public tensor_expression<tensor_scaled<E, S> > {
+        E expr_;
+        S factor_;
+      public:
+        typedef decltype(typename E::value_type{} * S{}) value_type;
+        static constexpr size_t dimension = E::dimension;
+
+        tensor_scaled(const E &expr, S factor) : expr_(expr), factor_(factor) {}
+
+        const std::array<size_t, dimension> &shape() const { return expr_.shape(); }
+        size_t size() const { return expr_.size(); }
+        value_type operator[](size_t i) const { return expr_[i] * factor_; }
+      };
+
+      /*
+       * Expression arithmetic
+       */
+      template<typename L, typename R>
+      tensor_sum<L, R, false> operator+(const tensor_expression<L> &lhs, const tensor_expression<R> &rhs) {
+        return tensor_sum<L, R, false>(lhs.derived(), rhs.derived());
+      }
+
+      template<typename L, typename R>
+      tensor_sum<L, R, true> operator-(const tensor_expression<L> &lhs, const tensor_expression<R> &rhs) {
+        return tensor_sum<L, R, true>(lhs.derived(), rhs.derived());
+      }
+
+      template<typename E, typename S>
+      typename std::enable_if<is_expression_scalar<S>::value,
+        tensor_scaled<E, typename expression_scalar<S, typename E::value_type>::type> >::type
+      operator*(const tensor_expression<E> &expr, S factor) {
+        typedef typename expression_scalar<S, typename E::value_type>::type scalar_type;
+        return tensor_scaled<E, scalar_type>(expr.derived(), scalar_type(factor));
+      }
+
+      template<typename E, typename S>
+      typename std::enable_if<is_expression_scalar<S>::value,
+        tensor_scaled<E, typename expression_scalar<S, typename E::value_type>::type> >::type
+      operator*(S factor, const tensor_expression<E> &expr) {
+        return expr * factor;
+      }
+
+      template<typename E, typename S>
+      typename std::enable_if<is_expression_scalar<S>::value,
+        tensor_scaled<E, typename expression_scalar<S, typename E::value_type>::type> >::type
+      operator/(const tensor_expression<E> &expr, S factor) {
+        typedef typename expression_scalar<S, typename E::value_type>::type scalar_type;
+        return tensor_scaled<E, scalar_type>(expr.derived(), scalar_type(1.0) / scalar_type(factor));
+      }
+
+      template<typename E>
+      tensor_scaled<E, typename E::value_type> operator-(const tensor_expression<E> &expr) {
+        return tensor_scaled<E, typename E::value_type>(expr.derived(), typename E::value_type(-1.0));
+      }
+    }
+
+    /**
+     * Start a lazily evaluated expression from a tensor, e.g. `Y = lazy(X) + 2.0 * lazy(Z);`
+     * evaluates the right-hand side in a single loop directly into Y.
+     */
+    template<typename T, size_t Dim, typename Container>
+    detail::tensor_leaf<T, Dim, Container> lazy(const detail::tensor_base<T, Dim, Container> &tensor) {
+      return detail::tensor_leaf<T, Dim, Container>(tensor);
+    }
+  }
+}
+
+#endif //ALPSCORE_TENSOR_EXPRESSION_HPP
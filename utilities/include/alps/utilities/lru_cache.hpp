@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#ifndef ALPS_UTILITY_LRU_CACHE_HPP
+#define ALPS_UTILITY_LRU_CACHE_HPP
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <utility>
+
+namespace alps {
+
+/**
+ * @brief Thread-safe cache of values computed from a key, holding at most `capacity` of them
+ *
+ * `get(key, make)` returns the cached value for `key`, or stores and returns `make()` if there is none.
+ * When a new value would exceed the capacity, the least recently used one is dropped.
+ */
+template<typename KEY, typename VALUE, typename COMPARE = std::less<KEY> >
+class lru_cache {
+  public:
+    explicit lru_cache(std::size_t capacity) : capacity_(capacity) {}
+
+    template<typename MAKE>
+    VALUE get(const KEY &key, MAKE make) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        typename map_type::iterator it = cache_.find(key);
+        if (it != cache_.end()) {
+            order_.splice(order_.begin(), order_, it->second.second);
+            return it->second.first;
+        }
+        VALUE value = make();
+        if (capacity_ == 0) return value;
+        while (cache_.size() >= capacity_) drop_least_recent();
+        it = cache_.insert(std::make_pair(key, std::make_pair(value, typename order_type::iterator()))).first;
+        order_.push_front(&it->first);
+        it->second.second = order_.begin();
+        return value;
+    }
+
+    /// Changes the maximal number of values, dropping the least recently used ones
+    void set_capacity(std::size_t capacity) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        capacity_ = capacity;
+        while (cache_.size() > capacity_) drop_least_recent();
+    }
+
+    /// Number of cached values
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cache_.size();
+    }
+
+  private:
+    typedef std::list<const KEY *> order_type;
+    typedef std::map<KEY, std::pair<VALUE, typename order_type::iterator>, COMPARE> map_type;
+
+    void drop_least_recent() {
+        typename map_type::iterator it = cache_.find(*order_.back());
+        order_.pop_back();
+        cache_.erase(it);
+    }
+
+    mutable std::mutex mutex_;
+    std::size_t capacity_;
+    map_type cache_;
+    /// keys of cache_, most recently used first
+    order_type order_;
+};
+
+} // end namespace alps
+
+#endif // ALPS_UTILITY_LRU_CACHE_HPP
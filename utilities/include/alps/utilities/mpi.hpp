@@ -24,11 +24,14 @@
 #include <exception> /* for std::uncaught_exception() */
 #include <functional> /* for std::plus */
 #include <algorithm> /* for std::max */
+#include <limits> /* for int range of the message sizes */
 
 #include <memory> /* for proper copy/assign of managed communicators */
 
 #include <stdexcept>
+#include <type_traits>
 #include <typeinfo>
+#include <utility>
 
 
 namespace alps {
@@ -265,17 +268,119 @@ namespace alps {
         };
 
 
+        namespace detail {
+            /// Bytes per message in the segmented collectives
+            inline std::size_t& segment_bytes() {
+                static std::size_t bytes=std::size_t(1)<<24;
+                return bytes;
+            }
+
+            /// Number of elements of `type_size` bytes per message: fits into one segment and into `int`
+            inline std::size_t segment_count(std::size_t type_size) {
+                std::size_t n=std::max(segment_bytes()/type_size, std::size_t(1));
+                return std::min(n, std::size_t(std::numeric_limits<int>::max()));
+            }
+
+            /// Number of segments in flight in a pipelined collective
+            static const std::size_t pipeline_depth=4;
+
+            /// Starts `MPI_Ibcast()` if `req` is given, otherwise does `MPI_Bcast()`
+            inline void bcast_segment(void* buf, int n, MPI_Datatype type, int root, MPI_Comm comm, MPI_Request* req) {
+#if MPI_VERSION >= 3
+                if (req) {
+                    MPI_Ibcast(buf, n, type, root, comm, req);
+                    return;
+                }
+#endif
+                MPI_Bcast(buf, n, type, root, comm);
+            }
+
+            /// Starts `MPI_Ireduce()` if `req` is given, otherwise does `MPI_Reduce()`
+            inline void reduce_segment(const void* in, void* out, int n, MPI_Datatype type, MPI_Op op, int root,
+                                       MPI_Comm comm, MPI_Request* req) {
+#if MPI_VERSION >= 3
+                if (req) {
+                    MPI_Ireduce(const_cast<void*>(in), out, n, type, op, root, comm, req);
+                    return;
+                }
+#endif
+                MPI_Reduce(const_cast<void*>(in), out, n, type, op, root, comm);
+            }
+
+            /// Starts `MPI_Iallreduce()` if `req` is given, otherwise does `MPI_Allreduce()`
+            inline void allreduce_segment(const void* in, void* out, int n, MPI_Datatype type, MPI_Op op,
+                                          MPI_Comm comm, MPI_Request* req) {
+#if MPI_VERSION >= 3
+                if (req) {
+                    MPI_Iallreduce(const_cast<void*>(in), out, n, type, op, comm, req);
+                    return;
+                }
+#endif
+                MPI_Allreduce(const_cast<void*>(in), out, n, type, op, comm);
+            }
+
+            /**
+               Calls `start(offset, n, req)` for consecutive segments of `count` elements of `type_size` bytes.
+               A single segment is done by a blocking call (`req` is null); otherwise, with MPI-3, up to
+               `pipeline_depth` non-blocking segments are in flight, so that the transfer of one segment
+               overlaps with the reduction or copy of the others.
+            */
+            template <typename F>
+            void pipelined(std::size_t count, std::size_t type_size, F start) {
+                std::size_t seg=segment_count(type_size);
+                if (count<=seg) {
+                    if (count>0) start(std::size_t(0), int(count), (MPI_Request*)0);
+                    return;
+                }
+#if MPI_VERSION >= 3
+                std::vector<MPI_Request> reqs(pipeline_depth, MPI_REQUEST_NULL);
+                std::size_t iseg=0;
+                for (std::size_t offset=0; offset<count; offset+=seg, ++iseg) {
+                    MPI_Request& req=reqs[iseg%pipeline_depth];
+                    MPI_Wait(&req, MPI_STATUS_IGNORE);
+                    start(offset, int(std::min(seg, count-offset)), &req);
+                }
+                MPI_Waitall(int(reqs.size()), &reqs.front(), MPI_STATUSES_IGNORE);
+#else
+                for (std::size_t offset=0; offset<count; offset+=seg) {
+                    start(offset, int(std::min(seg, count-offset)), (MPI_Request*)0);
+                }
+#endif
+            }
+
+            /// Broadcast of `count` elements of MPI type `type` of `type_size` bytes, in segments
+            inline void broadcast(const communicator& comm, void* vals, std::size_t count,
+                                  MPI_Datatype type, std::size_t type_size, int root) {
+                char* buf=static_cast<char*>(vals);
+                pipelined(count, type_size, [&](std::size_t offset, int n, MPI_Request* req) {
+                    bcast_segment(buf+offset*type_size, n, type, root, comm, req);
+                });
+            }
+        } // detail::
+
+        /// Sets the size in bytes of the messages large collectives are split into; must be the same on all ranks
+        inline void set_segment_size(std::size_t bytes) {
+            if (bytes==0) throw std::invalid_argument("Zero segment size in mpi::set_segment_size()");
+            detail::segment_bytes()=bytes;
+        }
+
+        /// Returns the size in bytes of the messages large collectives are split into
+        inline std::size_t segment_size() {
+            return detail::segment_bytes();
+        }
+
         /// Broadcasts array `vals` of a primitive type `T`, length `count` on communicator `comm` with root `root`
+        /** Arrays larger than `segment_size()` bytes are sent in pipelined segments, so `count` may exceed the `int` range. */
         template <typename T>
         void broadcast(const communicator& comm, T* vals, std::size_t count, int root) {
-            MPI_Bcast(vals, count, detail::mpi_type<T>(), root, comm);
+            detail::broadcast(comm, vals, count, detail::mpi_type<T>(), sizeof(T), root);
         }
 
 #ifndef ALPS_MPI_HAS_MPI_CXX_BOOL
         /// MPI_BCast of an array: overload for bool
         inline void broadcast(const communicator& comm, bool* vals, std::size_t count, int root) {
             // sizeof() returns size in chars (FIXME? should it be bytes?)
-            MPI_Bcast(vals, count*sizeof(bool), MPI_CHAR, root, comm);
+            detail::broadcast(comm, vals, count*sizeof(bool), MPI_CHAR, 1, root);
         }
 #endif /* ALPS_MPI_HAS_MPI_BOOL */
 
@@ -285,7 +390,7 @@ namespace alps {
         template <typename T>
         inline void broadcast(const communicator& comm, std::complex<T>* vals, std::size_t count, int root) {
             // sizeof() returns size in chars (FIXME? should it be bytes?)
-            MPI_Bcast(vals, count*sizeof(std::complex<T>), MPI_CHAR, root, comm);
+            detail::broadcast(comm, vals, count*sizeof(std::complex<T>), MPI_CHAR, 1, root);
         }
 #endif
 
@@ -362,9 +467,11 @@ namespace alps {
         };
 
         /// Performs `MPI_Allreduce` for array of a primitive type, T[n]
-        template <typename T, typename OP>
-        void all_reduce(const alps::mpi::communicator& comm, const T* val, int n,
-                        T* out_val, const OP& /*op*/)
+        /** Arrays larger than `segment_size()` bytes are reduced in pipelined segments, so `n` may exceed the `int` range. */
+        template <typename T, typename N, typename OP>
+        typename std::enable_if<std::is_integral<N>::value>::type
+        all_reduce(const alps::mpi::communicator& comm, const T* val, N n,
+                   T* out_val, const OP& /*op*/)
         {
             if (n<=0) {
                 throw std::invalid_argument("Non-positive array size in mpi::all_reduce()");
@@ -373,8 +480,44 @@ namespace alps {
             if (val==out_val) {
                 throw std::invalid_argument("Implicit in-place mpi::all_reduce() is not implemented");
             }
-            MPI_Allreduce(const_cast<T*>(val), out_val, n, detail::mpi_type<T>(),
-                          is_mpi_op<OP,T>::op(), comm);
+            MPI_Datatype type=detail::mpi_type<T>();
+            MPI_Op mpi_op=is_mpi_op<OP,T>::op();
+            detail::pipelined(std::size_t(n), sizeof(T), [&](std::size_t offset, int count, MPI_Request* req) {
+                detail::allreduce_segment(val+offset, out_val+offset, count, type, mpi_op, comm, req);
+            });
+        }
+
+        /// Performs `MPI_Reduce` for array of a primitive type, T[n], to rank `root`
+        /**
+           The result is stored in `out_val` at the root; `out_val` is not used by the other ranks and may be null.
+           At the root, `val==out_val` reduces in place. Arrays larger than `segment_size()` bytes are reduced in
+           pipelined segments.
+        */
+        template <typename T, typename OP>
+        void reduce(const alps::mpi::communicator& comm, const T* val, std::size_t n,
+                    T* out_val, const OP& /*op*/, int root)
+        {
+            if (n==0) {
+                throw std::invalid_argument("Zero array size in mpi::reduce()");
+            }
+            bool is_root=(comm.rank()==root);
+            bool in_place=is_root && val==out_val;
+            MPI_Datatype type=detail::mpi_type<T>();
+            MPI_Op mpi_op=is_mpi_op<OP,T>::op();
+            detail::pipelined(n, sizeof(T), [&](std::size_t offset, int count, MPI_Request* req) {
+                detail::reduce_segment(in_place ? MPI_IN_PLACE : val+offset, is_root ? out_val+offset : 0,
+                                       count, type, mpi_op, root, comm, req);
+            });
+        }
+
+        /// Performs `MPI_Reduce` for array of a primitive type, T[n], on a non-root rank
+        template <typename T, typename OP>
+        void reduce(const alps::mpi::communicator& comm, const T* val, std::size_t n, const OP& op, int root)
+        {
+            if (comm.rank()==root) {
+                throw std::invalid_argument("mpi::reduce() without the output array is called on the root");
+            }
+            reduce(comm, val, n, static_cast<T*>(0), op, root);
         }
 
         /// Performs `MPI_Allreduce` for a primitive type T
@@ -394,6 +537,104 @@ namespace alps {
             return out_val;
         }
 
+#if MPI_VERSION >= 3
+        /// Handle of a non-blocking collective operation
+        /**
+           The buffers of the operation must stay valid and unchanged until it is complete. The operation is
+           complete after `wait()` or after `test()` returns `true`; the destructor waits for an incomplete operation.
+        */
+        class request {
+            std::vector<MPI_Request> reqs_;
+
+            public:
+            request() {}
+            explicit request(const std::vector<MPI_Request>& reqs) : reqs_(reqs) {}
+            request(const request&) = delete;
+            request& operator=(const request&) = delete;
+            request(request&& rhs) : reqs_(std::move(rhs.reqs_)) { rhs.reqs_.clear(); }
+            request& operator=(request&& rhs) {
+                if (this!=&rhs) {
+                    wait();
+                    reqs_.swap(rhs.reqs_);
+                }
+                return *this;
+            }
+            ~request() {
+                if (!reqs_.empty() && !environment::finalized()) wait();
+            }
+
+            /// Blocks until the operation is complete
+            void wait() {
+                if (reqs_.empty()) return;
+                MPI_Waitall(int(reqs_.size()), &reqs_.front(), MPI_STATUSES_IGNORE);
+                reqs_.clear();
+            }
+
+            /// Returns `true` if the operation is complete, without blocking
+            bool test() {
+                if (reqs_.empty()) return true;
+                int flag=0;
+                MPI_Testall(int(reqs_.size()), &reqs_.front(), &flag, MPI_STATUSES_IGNORE);
+                if (flag) reqs_.clear();
+                return flag;
+            }
+
+            /// Returns `true` until the operation is known to be complete
+            bool active() const { return !reqs_.empty(); }
+        };
+
+        namespace detail {
+            /// Starts `start(offset, n, req)` for all segments of `count` elements at once
+            template <typename F>
+            request start_segments(std::size_t count, std::size_t type_size, F start) {
+                std::size_t seg=segment_count(type_size);
+                std::vector<MPI_Request> reqs;
+                reqs.reserve((count+seg-1)/seg);
+                for (std::size_t offset=0; offset<count; offset+=seg) {
+                    reqs.push_back(MPI_REQUEST_NULL);
+                    start(offset, int(std::min(seg, count-offset)), &reqs.back());
+                }
+                return request(reqs);
+            }
+        } // detail::
+
+        /// Starts a broadcast of array `vals` of a primitive type `T`, length `count`, from rank `root`
+        template <typename T>
+        request ibroadcast(const communicator& comm, T* vals, std::size_t count, int root) {
+            MPI_Datatype type=detail::mpi_type<T>();
+            return detail::start_segments(count, sizeof(T), [&](std::size_t offset, int n, MPI_Request* req) {
+                detail::bcast_segment(vals+offset, n, type, root, comm, req);
+            });
+        }
+
+        /// Starts a reduction of array `val` of a primitive type `T`, length `n`, to `out_val` at rank `root`
+        /** `out_val` is not used by the other ranks; at the root, `val==out_val` reduces in place. */
+        template <typename T, typename OP>
+        request ireduce(const communicator& comm, const T* val, std::size_t n, T* out_val, const OP& /*op*/, int root) {
+            bool is_root=(comm.rank()==root);
+            bool in_place=is_root && val==out_val;
+            MPI_Datatype type=detail::mpi_type<T>();
+            MPI_Op mpi_op=is_mpi_op<OP,T>::op();
+            return detail::start_segments(n, sizeof(T), [&](std::size_t offset, int count, MPI_Request* req) {
+                detail::reduce_segment(in_place ? MPI_IN_PLACE : val+offset, is_root ? out_val+offset : 0,
+                                       count, type, mpi_op, root, comm, req);
+            });
+        }
+
+        /// Starts an all-reduction of array `val` of a primitive type `T`, length `n`, to `out_val` on all ranks
+        /** `val==out_val` reduces in place. */
+        template <typename T, typename OP>
+        request iall_reduce(const communicator& comm, const T* val, std::size_t n, T* out_val, const OP& /*op*/) {
+            bool in_place=(val==out_val);
+            MPI_Datatype type=detail::mpi_type<T>();
+            MPI_Op mpi_op=is_mpi_op<OP,T>::op();
+            return detail::start_segments(n, sizeof(T), [&](std::size_t offset, int count, MPI_Request* req) {
+                detail::allreduce_segment(in_place ? MPI_IN_PLACE : val+offset, out_val+offset,
+                                          count, type, mpi_op, comm, req);
+            });
+        }
+#endif /* MPI_VERSION >= 3 */
+
     } // mpi::
 } // alps::
 
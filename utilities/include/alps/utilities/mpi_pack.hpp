@@ -0,0 +1,483 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file mpi_pack.hpp
+
+    @brief Packing of objects into contiguous buffers, to move them over MPI in one message
+
+    An object is packed by `pack(packer&, const T&)` and restored by `unpack(unpacker&, T&)`.
+    These are defined for arithmetic and enum types, `std::complex`, `std::string`, `std::vector`,
+    `std::map`, `std::pair` and `boost::optional`; a class takes part by defining the members
+    `void pack(alps::mpi::packer&) const` and `void unpack(alps::mpi::unpacker&)`.
+
+    A packer without a buffer only counts the bytes, so packing is done in two passes:
+    the size pass, then the copy into a buffer of exactly that size. No MPI derived datatypes
+    are involved; all ranks are assumed to have the same data representation.
+*/
+
+#ifndef ALPS_UTILITIES_MPI_PACK_HPP_INCLUDED_5b2f0c3e8d7a4e6f9c1d2b3a4f5e6d7c
+#define ALPS_UTILITIES_MPI_PACK_HPP_INCLUDED_5b2f0c3e8d7a4e6f9c1d2b3a4f5e6d7c
+
+#include <alps/utilities/mpi.hpp>
+#include <alps/utilities/mpi_shared.hpp>
+
+#include <complex>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+namespace alps {
+    namespace mpi {
+
+        /// Writes packed objects into a buffer; without a buffer, only counts the bytes
+        class packer {
+            char* buf_;
+            std::size_t capacity_;
+            std::size_t size_;
+
+            public:
+            /// Packer for the size pass
+            packer() : buf_(0), capacity_(0), size_(0) {}
+
+            /// Packer writing into `capacity` bytes at `buf`
+            packer(char* buf, std::size_t capacity) : buf_(buf), capacity_(capacity), size_(0) {}
+
+            /// Packs `n` objects of a bitwise-copyable type at `data`
+            template <typename T>
+            void write(const T* data, std::size_t n) {
+                std::size_t bytes=n*sizeof(T);
+                if (buf_) {
+                    if (capacity_-size_<bytes) throw std::logic_error("Buffer overflow in mpi::packer");
+                    if (bytes) std::memcpy(buf_+size_, data, bytes);
+                }
+                size_+=bytes;
+            }
+
+            /// Bytes packed (or counted) so far
+            std::size_t size() const { return size_; }
+
+            /// `true` for the size pass
+            bool sizing() const { return !buf_; }
+
+            template <typename T>
+            packer& operator<<(const T& val);
+        };
+
+        /// Reads packed objects from a buffer
+        class unpacker {
+            const char* buf_;
+            std::size_t size_;
+            std::size_t pos_;
+
+            public:
+            unpacker(const char* buf, std::size_t size) : buf_(buf), size_(size), pos_(0) {}
+
+            /// Unpacks `n` objects of a bitwise-copyable type to `data`
+            template <typename T>
+            void read(T* data, std::size_t n) {
+                std::size_t bytes=n*sizeof(T);
+                if (n>remaining()/sizeof(T)) throw std::runtime_error("Buffer overrun in mpi::unpacker");
+                if (bytes) std::memcpy(data, buf_+pos_, bytes);
+                pos_+=bytes;
+            }
+
+            /// Reads a count of elements that follow, each at least `min_bytes` long
+            std::size_t read_count(std::size_t min_bytes) {
+                std::size_t n=0;
+                read(&n, 1);
+                if (min_bytes && n>remaining()/min_bytes) throw std::runtime_error("Buffer overrun in mpi::unpacker");
+                return n;
+            }
+
+            /// Bytes not yet unpacked
+            std::size_t remaining() const { return size_-pos_; }
+
+            template <typename T>
+            unpacker& operator>>(T& val);
+        };
+
+        namespace detail {
+            /// Types that are packed as their bytes
+            template <typename T>
+            struct is_bitwise_packable
+                : public std::integral_constant<bool, std::is_arithmetic<T>::value || std::is_enum<T>::value> {};
+
+            template <typename T>
+            struct is_bitwise_packable< std::complex<T> > : public is_bitwise_packable<T> {};
+        }
+
+        /*
+         * Declarations of all overloads first, so that they are found for nested containers
+         */
+        template <typename T>
+        typename std::enable_if<detail::is_bitwise_packable<T>::value>::type pack(packer& p, const T& val);
+        template <typename T>
+        typename std::enable_if<detail::is_bitwise_packable<T>::value>::type unpack(unpacker& u, T& val);
+
+        template <typename T>
+        auto pack(packer& p, const T& val) -> decltype(val.pack(p));
+        template <typename T>
+        auto unpack(unpacker& u, T& val) -> decltype(val.unpack(u));
+
+        inline void pack(packer& p, const std::string& val);
+        inline void unpack(unpacker& u, std::string& val);
+
+        template <typename T, typename A>
+        void pack(packer& p, const std::vector<T,A>& vec);
+        template <typename T, typename A>
+        void unpack(unpacker& u, std::vector<T,A>& vec);
+
+        template <typename A>
+        void pack(packer& p, const std::vector<bool,A>& vec);
+        template <typename A>
+        void unpack(unpacker& u, std::vector<bool,A>& vec);
+
+        template <typename K, typename V>
+        void pack(packer& p, const std::pair<K,V>& val);
+        template <typename K, typename V>
+        void unpack(unpacker& u, std::pair<K,V>& val);
+
+        template <typename K, typename V, typename C, typename A>
+        void pack(packer& p, const std::map<K,V,C,A>& val);
+        template <typename K, typename V, typename C, typename A>
+        void unpack(unpacker& u, std::map<K,V,C,A>& val);
+
+        template <typename T>
+        void pack(packer& p, const boost::optional<T>& val);
+        template <typename T>
+        void unpack(unpacker& u, boost::optional<T>& val);
+
+        /*
+         * Definitions
+         */
+        template <typename T>
+        typename std::enable_if<detail::is_bitwise_packable<T>::value>::type pack(packer& p, const T& val) {
+            p.write(&val, 1);
+        }
+        template <typename T>
+        typename std::enable_if<detail::is_bitwise_packable<T>::value>::type unpack(unpacker& u, T& val) {
+            u.read(&val, 1);
+        }
+
+        /// Classes with `pack()` and `unpack()` members
+        template <typename T>
+        auto pack(packer& p, const T& val) -> decltype(val.pack(p)) {
+            return val.pack(p);
+        }
+        template <typename T>
+        auto unpack(unpacker& u, T& val) -> decltype(val.unpack(u)) {
+            return val.unpack(u);
+        }
+
+        inline void pack(packer& p, const std::string& val) {
+            pack(p, std::size_t(val.size()));
+            p.write(val.data(), val.size());
+        }
+        inline void unpack(unpacker& u, std::string& val) {
+            std::size_t n=u.read_count(sizeof(char));
+            val.resize(n);
+            if (n) u.read(&val[0], n);
+        }
+
+        namespace detail {
+            template <typename T>
+            void pack_elements(packer& p, const T* data, std::size_t n, std::true_type) {
+                p.write(data, n);
+            }
+            template <typename T>
+            void pack_elements(packer& p, const T* data, std::size_t n, std::false_type) {
+                for (std::size_t i=0; i<n; ++i) pack(p, data[i]);
+            }
+            template <typename T>
+            void unpack_elements(unpacker& u, T* data, std::size_t n, std::true_type) {
+                u.read(data, n);
+            }
+            template <typename T>
+            void unpack_elements(unpacker& u, T* data, std::size_t n, std::false_type) {
+                for (std::size_t i=0; i<n; ++i) unpack(u, data[i]);
+            }
+        }
+
+        template <typename T, typename A>
+        void pack(packer& p, const std::vector<T,A>& vec) {
+            pack(p, std::size_t(vec.size()));
+            detail::pack_elements(p, vec.data(), vec.size(), detail::is_bitwise_packable<T>());
+        }
+        template <typename T, typename A>
+        void unpack(unpacker& u, std::vector<T,A>& vec) {
+            std::size_t n=u.read_count(detail::is_bitwise_packable<T>::value ? sizeof(T) : 0);
+            vec.resize(n);
+            detail::unpack_elements(u, vec.data(), n, detail::is_bitwise_packable<T>());
+        }
+
+        template <typename A>
+        void pack(packer& p, const std::vector<bool,A>& vec) {
+            pack(p, std::size_t(vec.size()));
+            for (std::size_t i=0; i<vec.size(); ++i) pack(p, char(vec[i]));
+        }
+        template <typename A>
+        void unpack(unpacker& u, std::vector<bool,A>& vec) {
+            std::size_t n=u.read_count(sizeof(char));
+            vec.resize(n);
+            for (std::size_t i=0; i<n; ++i) {
+                char c;
+                unpack(u, c);
+                vec[i]=c;
+            }
+        }
+
+        template <typename K, typename V>
+        void pack(packer& p, const std::pair<K,V>& val) {
+            pack(p, val.first);
+            pack(p, val.second);
+        }
+        template <typename K, typename V>
+        void unpack(unpacker& u, std::pair<K,V>& val) {
+            unpack(u, val.first);
+            unpack(u, val.second);
+        }
+
+        template <typename K, typename V, typename C, typename A>
+        void pack(packer& p, const std::map<K,V,C,A>& val) {
+            pack(p, std::size_t(val.size()));
+            for (typename std::map<K,V,C,A>::const_iterator it=val.begin(); it!=val.end(); ++it) {
+                pack(p, it->first);
+                pack(p, it->second);
+            }
+        }
+        template <typename K, typename V, typename C, typename A>
+        void unpack(unpacker& u, std::map<K,V,C,A>& val) {
+            std::size_t n=u.read_count(0);
+            std::map<K,V,C,A> new_map;
+            while (n--) {
+                std::pair<K,V> elem; // FIXME! this requires default ctor
+                unpack(u, elem);
+                new_map.insert(new_map.end(), elem);
+            }
+            using std::swap;
+            swap(val, new_map);
+        }
+
+        template <typename T>
+        void pack(packer& p, const boost::optional<T>& val) {
+            pack(p, bool(val));
+            if (val) pack(p, *val);
+        }
+        template <typename T>
+        void unpack(unpacker& u, boost::optional<T>& val) {
+            bool is_valid=false;
+            unpack(u, is_valid);
+            if (!is_valid) {
+                val=boost::none;
+                return;
+            }
+            if (!val) val=T();
+            unpack(u, *val);
+        }
+
+        template <typename T>
+        packer& packer::operator<<(const T& val) {
+            pack(*this, val);
+            return *this;
+        }
+
+        template <typename T>
+        unpacker& unpacker::operator>>(T& val) {
+            unpack(*this, val);
+            return *this;
+        }
+
+        /// Packs `obj` into a new buffer of exactly the packed size
+        template <typename T>
+        std::vector<char> pack_to_buffer(const T& obj) {
+            packer sizer;
+            pack(sizer, obj);
+            std::vector<char> buf(sizer.size());
+            packer writer(buf.data(), buf.size());
+            pack(writer, obj);
+            return buf;
+        }
+
+        /// Unpacks `obj` from the buffer made by `pack_to_buffer()`
+        template <typename T>
+        void unpack_from_buffer(const std::vector<char>& buf, T& obj) {
+            unpacker u(buf.data(), buf.size());
+            unpack(u, obj);
+            if (u.remaining()) throw std::runtime_error("Unused packed data in mpi::unpack_from_buffer()");
+        }
+
+        namespace detail {
+            /// Size of the first message of a packed broadcast; smaller objects need no other message
+            static const std::size_t eager_pack_bytes=4096;
+        }
+
+        /// Broadcasts object `obj` from rank `root` as one packed buffer
+        /**
+           The first message has a fixed size and carries the size of the packed object, so objects up to
+           about `detail::eager_pack_bytes` are sent in one message and larger ones in two. The object on
+           the other ranks is replaced by the unpacked copy. With MPI-3, objects above
+           `node_collective_threshold()` are sent only to the node leaders and unpacked from shared memory.
+        */
+        template <typename T>
+        void broadcast_packed(const communicator& comm, T& obj, int root) {
+            const std::size_t header=sizeof(std::size_t);
+            const std::size_t eager=detail::eager_pack_bytes;
+            const bool is_root=(comm.rank()==root);
+            std::vector<char> buf;
+            std::size_t payload=0;
+            if (is_root) {
+                packer sizer;
+                pack(sizer, obj);
+                payload=sizer.size();
+                buf.resize(std::max(header+payload, eager));
+                std::memcpy(buf.data(), &payload, header);
+                packer writer(buf.data()+header, payload);
+                pack(writer, obj);
+            } else {
+                buf.resize(eager);
+            }
+            broadcast(comm, buf.data(), eager, root);
+            std::memcpy(&payload, buf.data(), header);
+#if MPI_VERSION >= 3
+            // large objects are received once per node, and unpacked from shared memory
+            if (header+payload>eager && header+payload>=node_collective_threshold()) {
+                std::shared_ptr<const node_topology> topo=node_topology::of(comm);
+                if (!topo->trivial()) {
+                    shared_array<char> shared=broadcast_shared(*topo, buf.data(), header+payload, root);
+                    if (!is_root) {
+                        unpacker u(shared.data()+header, payload);
+                        unpack(u, obj);
+                        if (u.remaining()) throw std::runtime_error("Unused packed data in mpi::broadcast_packed()");
+                    }
+                    return;
+                }
+            }
+#endif
+            if (header+payload>eager) {
+                buf.resize(header+payload);
+                broadcast(comm, buf.data()+eager, header+payload-eager, root);
+            }
+            if (!is_root) {
+                unpacker u(buf.data()+header, payload);
+                unpack(u, obj);
+                if (u.remaining()) throw std::runtime_error("Unused packed data in mpi::broadcast_packed()");
+            }
+        }
+
+        /// Sum-reduction of many arrays to one rank, with one message per scalar type
+        /**
+           `add()` copies the input arrays into a buffer per scalar type; `commit()` reduces each buffer
+           in one (segmented) `reduce()` and stores the results on the root. With MPI-3, buffers above
+           `node_collective_threshold()` are reduced by `node_reduce()`. All ranks must add the same
+           sequence of arrays. The output arrays must stay valid until `commit()`; they are not used on
+           the other ranks.
+        */
+        class packed_reduction {
+            typedef void (*reduce_fn)(const communicator&, std::vector<char>&, int);
+
+            struct target {
+                std::size_t offset;
+                std::function<void(const char*)> store;
+            };
+
+            struct lane {
+                reduce_fn reduce;
+                std::vector<char> data;
+                std::vector<target> targets;
+            };
+
+            communicator comm_;
+            int root_;
+            bool is_root_;
+            std::vector<lane> lanes_;
+
+            template <typename T>
+            static void reduce_lane(const communicator& comm, std::vector<char>& data, int root) {
+                T* values=reinterpret_cast<T*>(data.data());
+                std::size_t n=data.size()/sizeof(T);
+#if MPI_VERSION >= 3
+                // large buffers are summed within each node in shared memory first
+                if (data.size()>=node_collective_threshold()) {
+                    std::shared_ptr<const node_topology> topo=node_topology::of(comm);
+                    if (!topo->trivial()) {
+                        node_reduce(*topo, values, values, n, std::plus<T>(), root);
+                        return;
+                    }
+                }
+#endif
+                if (comm.rank()==root) {
+                    reduce(comm, values, n, values, std::plus<T>(), root);
+                } else {
+                    reduce(comm, values, n, std::plus<T>(), root);
+                }
+            }
+
+            lane& lane_for(reduce_fn fn) {
+                for (std::size_t i=0; i<lanes_.size(); ++i) {
+                    if (lanes_[i].reduce==fn) return lanes_[i];
+                }
+                lanes_.push_back(lane());
+                lanes_.back().reduce=fn;
+                return lanes_.back();
+            }
+
+            public:
+            packed_reduction(const communicator& comm, int root)
+                : comm_(comm), root_(root), is_root_(comm.rank()==root) {}
+
+            const communicator& comm() const { return comm_; }
+            int root() const { return root_; }
+
+            /// Adds `n` values at `in`; at the root, `store(reduced)` is called with the sums on `commit()`
+            template <typename T, typename F>
+            void add(const T* in, std::size_t n, F store) {
+                if (n==0) return;
+                lane& l=lane_for(&reduce_lane<T>);
+                std::size_t offset=l.data.size();
+                l.data.resize(offset+n*sizeof(T));
+                std::memcpy(l.data.data()+offset, in, n*sizeof(T));
+                if (is_root_) {
+                    target t;
+                    t.offset=offset;
+                    t.store=[store](const char* reduced) { store(reinterpret_cast<const T*>(reduced)); };
+                    l.targets.push_back(t);
+                }
+            }
+
+            /// Adds `n` values at `in`; at the root, the sums are stored to `out` on `commit()`
+            template <typename T>
+            void add(const T* in, T* out, std::size_t n) {
+                add(in, n, [out, n](const T* reduced) { std::copy(reduced, reduced+n, out); });
+            }
+
+            /// Does the reductions and stores the results on the root
+            void commit() {
+                std::vector<lane> lanes;
+                lanes.swap(lanes_);
+                for (std::size_t i=0; i<lanes.size(); ++i) {
+                    lane& l=lanes[i];
+                    l.reduce(comm_, l.data, root_);
+                    for (std::size_t j=0; j<l.targets.size(); ++j) {
+                        l.targets[j].store(l.data.data()+l.targets[j].offset);
+                    }
+                }
+            }
+
+            /// `true` if there are arrays not yet reduced
+            bool pending() const { return !lanes_.empty(); }
+        };
+
+    } // mpi::
+} // alps::
+
+#endif /* ALPS_UTILITIES_MPI_PACK_HPP_INCLUDED_5b2f0c3e8d7a4e6f9c1d2b3a4f5e6d7c */
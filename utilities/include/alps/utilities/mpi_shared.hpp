@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+/** @file mpi_shared.hpp
+
+    @brief Node-level collectives through MPI-3 shared-memory windows
+
+    The ranks of a communicator are grouped by node (`MPI_Comm_split_type()`); rank 0 of each
+    node is its leader. Read-only data broadcast by `broadcast_shared()` is kept once per node
+    in a shared-memory window, and `node_reduce()` sums within each node in shared memory
+    before reducing between the node leaders.
+
+    Everything here requires MPI-3.
+*/
+
+#ifndef ALPS_UTILITIES_MPI_SHARED_HPP_INCLUDED_8e3a1c5d2b7f4a9e6d0c1b2a3f4e5d6c
+#define ALPS_UTILITIES_MPI_SHARED_HPP_INCLUDED_8e3a1c5d2b7f4a9e6d0c1b2a3f4e5d6c
+
+#include <alps/utilities/mpi.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#if MPI_VERSION >= 3
+
+namespace alps {
+    namespace mpi {
+
+        namespace detail {
+            /// Arrays of at least this many bytes use the node-level collectives
+            inline std::size_t& node_collective_bytes() {
+                static std::size_t bytes=std::size_t(1)<<16;
+                return bytes;
+            }
+        }
+
+        /// Sets the size from which packed broadcasts and merges go through shared memory
+        inline void set_node_collective_threshold(std::size_t bytes) {
+            detail::node_collective_bytes()=bytes;
+        }
+
+        /// Returns the size from which packed broadcasts and merges go through shared memory
+        inline std::size_t node_collective_threshold() {
+            return detail::node_collective_bytes();
+        }
+
+        /// Grouping of the ranks of a communicator by shared-memory node
+        class node_topology {
+            communicator comm_;
+            communicator node_;
+            communicator leaders_;
+            std::vector<int> leader_of_;
+            int nodes_;
+
+            static int delete_attr(MPI_Comm, int, void* attr, void*) {
+                delete static_cast<std::shared_ptr<const node_topology>*>(attr);
+                return MPI_SUCCESS;
+            }
+
+            public:
+            /// Splits `comm` by node; collective on `comm`
+            /** Only attaches to `comm`: the topology is cached on it, so an owning copy would keep it alive */
+            explicit node_topology(const communicator& comm) : comm_(comm, comm_attach), nodes_(0) {
+                MPI_Comm node;
+                MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, comm.rank(), MPI_INFO_NULL, &node);
+                node_=communicator(node, take_ownership);
+
+                MPI_Comm leaders;
+                MPI_Comm_split(comm, is_leader() ? 0 : MPI_UNDEFINED, comm.rank(), &leaders);
+                if (leaders==MPI_COMM_NULL) {
+                    leaders_=communicator(MPI_COMM_NULL, comm_attach);
+                } else {
+                    leaders_=communicator(leaders, take_ownership);
+                }
+
+                // the leader's rank is shared with its node, then gathered from everybody
+                int my_leader=is_leader() ? leaders_.rank() : 0;
+                broadcast(node_, my_leader, 0);
+                leader_of_.resize(comm.size());
+                MPI_Allgather(&my_leader, 1, MPI_INT, &leader_of_[0], 1, MPI_INT, comm);
+                nodes_=*std::max_element(leader_of_.begin(), leader_of_.end())+1;
+            }
+
+            /// Topology of `comm`, cached on the communicator after the first call; collective on `comm`
+            static std::shared_ptr<const node_topology> of(const communicator& comm) {
+                static int keyval=MPI_KEYVAL_INVALID;
+                if (keyval==MPI_KEYVAL_INVALID) {
+                    MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, &delete_attr, &keyval, 0);
+                }
+                void* attr=0;
+                int found=0;
+                MPI_Comm_get_attr(comm, keyval, &attr, &found);
+                if (found) return *static_cast<std::shared_ptr<const node_topology>*>(attr);
+
+                std::shared_ptr<const node_topology>* cached=
+                    new std::shared_ptr<const node_topology>(new node_topology(comm));
+                MPI_Comm_set_attr(comm, keyval, cached);
+                return *cached;
+            }
+
+            /// The communicator that was split
+            const communicator& comm() const { return comm_; }
+            /// Ranks on this node
+            const communicator& node() const { return node_; }
+            /// Node leaders; `MPI_COMM_NULL` on the other ranks
+            const communicator& leaders() const { return leaders_; }
+
+            /// `true` on rank 0 of the node
+            bool is_leader() const { return node_.rank()==0; }
+            /// Number of nodes
+            int nodes() const { return nodes_; }
+            /// `true` if no two ranks share a node, so shared memory buys nothing
+            bool trivial() const { return nodes_==comm_.size(); }
+            /// Rank in `leaders()` of the leader of the node of `rank` in `comm()`
+            int leader_of(int rank) const { return leader_of_.at(rank); }
+        };
+
+        /// Array in an MPI-3 shared-memory window, visible to all ranks of a node
+        /**
+           Each rank contributes a segment; the segments are contiguous, in node rank order,
+           and `data()` points to the first one on every rank. The array is freed when the
+           last copy of the object is destroyed.
+        */
+        template <typename T>
+        class shared_array {
+            struct window {
+                MPI_Win win;
+                communicator node;
+
+                window(const communicator& n, std::size_t local_count, void** base) : node(n) {
+                    MPI_Win_allocate_shared(local_count*sizeof(T), sizeof(T), MPI_INFO_NULL, node, base, &win);
+                    MPI_Win_lock_all(MPI_MODE_NOCHECK, win);
+                }
+
+                ~window() {
+                    int finalized;
+                    MPI_Finalized(&finalized);
+                    if (!finalized) {
+                        MPI_Win_unlock_all(win);
+                        MPI_Win_free(&win);
+                    }
+                }
+            };
+
+            std::shared_ptr<window> win_;
+            T* data_;
+            std::size_t size_;
+
+            public:
+            /// Empty array
+            shared_array() : data_(0), size_(0) {}
+
+            /// Allocates `local_count` elements on this rank of `node`; collective on `node`
+            shared_array(const communicator& node, std::size_t local_count) : data_(0), size_(0) {
+                void* base=0;
+                win_=std::make_shared<window>(node, local_count, &base);
+
+                // zero-size segments may have no address, so start from the first non-empty one
+                for (int r=0; r<node.size(); ++r) {
+                    MPI_Aint bytes=0;
+                    int disp_unit=0;
+                    void* segment=0;
+                    MPI_Win_shared_query(win_->win, r, &bytes, &disp_unit, &segment);
+                    if (bytes==0) continue;
+                    if (!data_) data_=static_cast<T*>(segment);
+                    size_+=bytes/sizeof(T);
+                }
+            }
+
+            /// Makes the writes of all ranks of the node visible to each other; collective on the node
+            void sync() const {
+                if (!win_) return;
+                MPI_Win_sync(win_->win);
+                win_->node.barrier();
+                MPI_Win_sync(win_->win);
+            }
+
+            T* data() { return data_; }
+            const T* data() const { return data_; }
+            std::size_t size() const { return size_; }
+            bool empty() const { return size_==0; }
+
+            T& operator[](std::size_t i) { return data_[i]; }
+            const T& operator[](std::size_t i) const { return data_[i]; }
+
+            T* begin() { return data_; }
+            T* end() { return data_+size_; }
+            const T* begin() const { return data_; }
+            const T* end() const { return data_+size_; }
+        };
+
+        /// Broadcasts `n` values at `root` into one shared array per node
+        /**
+           Only the node leaders take part in the broadcast between nodes; the other ranks
+           read the data from the shared array of their node. `n` must be the same on all ranks.
+        */
+        template <typename T>
+        shared_array<T> broadcast_shared(const node_topology& topo, const T* values, std::size_t n, int root) {
+            const communicator& comm=topo.comm();
+            shared_array<T> shared(topo.node(), topo.is_leader() ? n : 0);
+            if (comm.rank()==root && n!=0) {
+                std::copy(values, values+n, shared.data());
+            }
+            shared.sync();
+            if (topo.is_leader() && topo.nodes()>1 && n!=0) {
+                broadcast(topo.leaders(), shared.data(), n, topo.leader_of(root));
+            }
+            shared.sync();
+            return shared;
+        }
+
+        /// Broadcasts `n` values at `root` into one shared array per node of `comm`
+        template <typename T>
+        shared_array<T> broadcast_shared(const communicator& comm, const T* values, std::size_t n, int root) {
+            return broadcast_shared(*node_topology::of(comm), values, n, root);
+        }
+
+        /// Reduction of `n` values from all ranks to `root`, first within each node, then between the nodes
+        /**
+           Each rank copies its values into a shared array of its node; the ranks of the node
+           then reduce disjoint ranges of the array, and the node leaders reduce the node results
+           to the leader of the node of `root`. `out` is only used at `root` and may be the same as `in`.
+        */
+        template <typename T, typename Op>
+        void node_reduce(const node_topology& topo, const T* in, T* out, std::size_t n, Op op, int root) {
+            if (n==0) throw std::invalid_argument("Zero count in mpi::node_reduce()");
+            const communicator& comm=topo.comm();
+            const communicator& node=topo.node();
+            const int nrank=node.rank();
+            const int nsize=node.size();
+
+            shared_array<T> scratch(node, n);
+            T* mine=scratch.data()+nrank*n;
+            std::copy(in, in+n, mine);
+            scratch.sync();
+
+            // the node ranks reduce disjoint ranges into the first segment
+            T* result=scratch.data();
+            const std::size_t begin=n*nrank/nsize;
+            const std::size_t end=n*(nrank+1)/nsize;
+            for (int r=1; r<nsize; ++r) {
+                const T* other=scratch.data()+r*n;
+                for (std::size_t i=begin; i<end; ++i) result[i]=op(result[i], other[i]);
+            }
+            scratch.sync();
+
+            if (topo.is_leader() && topo.nodes()>1) {
+                const communicator& leaders=topo.leaders();
+                const int leader_root=topo.leader_of(root);
+                if (leaders.rank()==leader_root) {
+                    reduce(leaders, result, n, result, op, leader_root);
+                } else {
+                    reduce(leaders, result, n, op, leader_root);
+                }
+            }
+            scratch.sync();
+
+            if (comm.rank()==root) std::copy(result, result+n, out);
+            // nobody frees the window before the root has read it
+            scratch.sync();
+        }
+
+        /// Reduction of `n` values to `root` through shared memory within the nodes of `comm`
+        template <typename T, typename Op>
+        void node_reduce(const communicator& comm, const T* in, T* out, std::size_t n, Op op, int root) {
+            node_reduce(*node_topology::of(comm), in, out, n, op, root);
+        }
+
+    } // mpi::
+} // alps::
+
+#endif /* MPI_VERSION >= 3 */
+
+#endif /* ALPS_UTILITIES_MPI_SHARED_HPP_INCLUDED_8e3a1c5d2b7f4a9e6d0c1b2a3f4e5d6c */
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#ifndef ALPS_UTILITY_THREAD_POOL_HPP
+#define ALPS_UTILITY_THREAD_POOL_HPP
+
+#include <alps/config.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+
+#ifndef ALPS_SINGLE_THREAD
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#endif
+
+namespace alps {
+
+/**
+ * @brief Fixed set of worker threads for fork-join loops over independent items
+ *
+ * `parallel_for(n, f)` splits [0, n) into one contiguous range per thread, calls `f(begin, end)` for each
+ * range (the calling thread takes the first one) and returns when all ranges are done. The first exception
+ * thrown by `f` is rethrown in the calling thread. Calls from inside a running loop, and calls while another
+ * thread uses the pool, run serially in the calling thread.
+ *
+ * If ALPSCore is built with `ALPS_SINGLE_THREAD`, no threads are started and all loops run serially.
+ */
+class thread_pool {
+  public:
+    /// Pool with `nthreads` threads including the calling one; 0 means one per hardware thread
+    explicit thread_pool(unsigned nthreads = 0) {
+#ifdef ALPS_SINGLE_THREAD
+      (void)nthreads;
+      size_ = 1;
+#else
+      if (nthreads == 0) nthreads = std::max(1u, std::thread::hardware_concurrency());
+      size_ = nthreads;
+      generation_ = 0;
+      remaining_ = 0;
+      stop_ = false;
+      for (unsigned id = 1; id < size_; ++id) {
+        workers_.push_back(std::thread(&thread_pool::work, this, id));
+      }
+#endif
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    ~thread_pool() {
+#ifndef ALPS_SINGLE_THREAD
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+      }
+      start_.notify_all();
+      for (size_t i = 0; i < workers_.size(); ++i) workers_[i].join();
+#endif
+    }
+
+    /// Number of threads, including the calling one
+    unsigned size() const { return size_; }
+
+    /// Calls `f(begin, end)` on disjoint ranges covering [0, n), in parallel
+    template<typename F>
+    void parallel_for(size_t n, F f) {
+#ifdef ALPS_SINGLE_THREAD
+      if (n > 0) f(size_t(0), n);
+#else
+      size_t nthreads = std::min(size_t(size_), n);
+      std::unique_lock<std::mutex> call(call_mutex_, std::try_to_lock);
+      if (nthreads <= 1 || in_worker() || !call.owns_lock()) {
+        if (n > 0) f(size_t(0), n);
+        return;
+      }
+      std::function<void(unsigned)> task = [&](unsigned id) {
+        if (id < nthreads) f(n*id/nthreads, n*(id+1)/nthreads);
+      };
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        error_ = std::exception_ptr();
+        remaining_ = workers_.size();
+        ++generation_;
+      }
+      start_.notify_all();
+      run(0);
+      std::unique_lock<std::mutex> lock(mutex_);
+      done_.wait(lock, [this]() { return remaining_ == 0; });
+      task_ = 0;
+      if (error_) std::rethrow_exception(error_);
+#endif
+    }
+
+    /// Process-wide pool with one thread per hardware thread
+    static thread_pool &global() {
+      static thread_pool instance;
+      return instance;
+    }
+
+  private:
+    unsigned size_;
+#ifndef ALPS_SINGLE_THREAD
+    std::vector<std::thread> workers_;
+    std::mutex call_mutex_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    const std::function<void(unsigned)> *task_ = 0;
+    std::exception_ptr error_;
+    size_t generation_;
+    size_t remaining_;
+    bool stop_;
+
+    static bool &in_worker() {
+      static thread_local bool flag = false;
+      return flag;
+    }
+
+    void run(unsigned id) {
+      in_worker() = true;
+      try {
+        (*task_)(id);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_) error_ = std::current_exception();
+      }
+      in_worker() = false;
+    }
+
+    void work(unsigned id) {
+      size_t seen = 0;
+      for (;;) {
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          start_.wait(lock, [&]() { return stop_ || generation_ != seen; });
+          if (stop_) return;
+          seen = generation_;
+        }
+        run(id);
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          --remaining_;
+        }
+        done_.notify_one();
+      }
+    }
+#endif
+};
+
+} // end namespace alps
+
+#endif // ALPS_UTILITY_THREAD_POOL_HPP
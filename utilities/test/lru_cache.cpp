@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include <string>
+
+#include "alps/utilities/lru_cache.hpp"
+
+#include "gtest/gtest.h"
+
+TEST(LruCache, DropsLeastRecentlyUsed) {
+    alps::lru_cache<std::string, int> cache(2);
+    int made = 0;
+    auto make = [&made]() { return ++made; };
+    EXPECT_EQ(1, cache.get("a", make));
+    EXPECT_EQ(2, cache.get("b", make));
+    EXPECT_EQ(1, cache.get("a", make));
+    // "b" is the least recently used one
+    EXPECT_EQ(3, cache.get("c", make));
+    EXPECT_EQ(2u, cache.size());
+    EXPECT_EQ(1, cache.get("a", make));
+    EXPECT_EQ(4, cache.get("b", make));
+    EXPECT_EQ(4, made);
+}
+
+TEST(LruCache, Capacity) {
+    alps::lru_cache<int, int> cache(3);
+    for (int i = 0; i < 3; ++i) cache.get(i, [i]() { return i; });
+    cache.set_capacity(1);
+    EXPECT_EQ(1u, cache.size());
+    // the most recent value is kept
+    EXPECT_EQ(2, cache.get(2, []() { return -1; }));
+    cache.set_capacity(0);
+    EXPECT_EQ(0u, cache.size());
+    EXPECT_EQ(5, cache.get(0, []() { return 5; }));
+    EXPECT_EQ(0u, cache.size());
+}
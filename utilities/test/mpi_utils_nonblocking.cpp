@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include <complex>
+#include <vector>
+
+#include <alps/utilities/mpi.hpp>
+
+#include <gtest/gtest.h>
+
+#include <alps/utilities/gtest_par_xml_output.hpp>
+
+/* Test segmented and non-blocking collectives */
+
+namespace am=alps::mpi;
+
+class MpiSegmentedTest : public ::testing::Test {
+  protected:
+    static const int ROOT_=0;
+    // not a multiple of the segment length
+    static const std::size_t N_=1003;
+
+    am::communicator comm_;
+    int rank_;
+    int nproc_;
+    bool is_root_;
+    std::size_t saved_segment_;
+
+    // element i of rank r
+    static double value(int r, std::size_t i) { return 0.5*i+r+1; }
+
+    double sum(std::size_t i) const {
+        double s=0;
+        for (int r=0; r<nproc_; ++r) s+=value(r,i);
+        return s;
+    }
+
+    std::vector<double> local_data() const {
+        std::vector<double> v(N_);
+        for (std::size_t i=0; i<N_; ++i) v[i]=value(rank_,i);
+        return v;
+    }
+
+  public:
+    MpiSegmentedTest() : comm_(), rank_(comm_.rank()), nproc_(comm_.size()), is_root_(rank_==ROOT_),
+                         saved_segment_(am::segment_size())
+    {
+        // 8 doubles per message
+        am::set_segment_size(64);
+    }
+
+    ~MpiSegmentedTest() { am::set_segment_size(saved_segment_); }
+};
+
+TEST_F(MpiSegmentedTest, SegmentSize) {
+    EXPECT_EQ(64u, am::segment_size());
+    EXPECT_THROW(am::set_segment_size(0), std::invalid_argument);
+    EXPECT_EQ(64u, am::segment_size());
+}
+
+TEST_F(MpiSegmentedTest, Broadcast) {
+    std::vector<double> v(N_, -1.0);
+    if (is_root_) v=local_data();
+    am::broadcast(comm_, &v.front(), v.size(), ROOT_);
+    for (std::size_t i=0; i<N_; ++i) ASSERT_EQ(value(ROOT_,i), v[i]) << "i=" << i;
+
+    std::vector<std::complex<double> > c(N_);
+    if (is_root_) for (std::size_t i=0; i<N_; ++i) c[i]=std::complex<double>(value(ROOT_,i), -double(i));
+    am::broadcast(comm_, &c.front(), c.size(), ROOT_);
+    for (std::size_t i=0; i<N_; ++i) ASSERT_EQ(std::complex<double>(value(ROOT_,i), -double(i)), c[i]) << "i=" << i;
+}
+
+TEST_F(MpiSegmentedTest, AllReduce) {
+    std::vector<double> in=local_data(), out(N_, 0.0);
+    am::all_reduce(comm_, &in.front(), in.size(), &out.front(), std::plus<double>());
+    for (std::size_t i=0; i<N_; ++i) ASSERT_EQ(sum(i), out[i]) << "i=" << i;
+}
+
+TEST_F(MpiSegmentedTest, Reduce) {
+    std::vector<double> in=local_data(), out(N_, 0.0);
+    if (is_root_) {
+        am::reduce(comm_, &in.front(), in.size(), &out.front(), std::plus<double>(), ROOT_);
+        for (std::size_t i=0; i<N_; ++i) ASSERT_EQ(sum(i), out[i]) << "i=" << i;
+        EXPECT_THROW(am::reduce(comm_, &in.front(), in.size(), std::plus<double>(), ROOT_), std::invalid_argument);
+    } else {
+        am::reduce(comm_, &in.front(), in.size(), std::plus<double>(), ROOT_);
+    }
+}
+
+TEST_F(MpiSegmentedTest, ReduceInPlace) {
+    std::vector<double> v=local_data();
+    am::reduce(comm_, &v.front(), v.size(), &v.front(), am::maximum<double>(), ROOT_);
+    for (std::size_t i=0; i<N_; ++i) {
+        ASSERT_EQ(is_root_ ? value(nproc_-1,i) : value(rank_,i), v[i]) << "i=" << i;
+    }
+}
+
+#if MPI_VERSION >= 3
+TEST_F(MpiSegmentedTest, NonBlocking) {
+    std::vector<double> b(N_, -1.0);
+    if (is_root_) b=local_data();
+    std::vector<double> in=local_data(), reduced(N_, 0.0), all(N_, 0.0);
+
+    // several operations in flight at once
+    am::request rb=am::ibroadcast(comm_, &b.front(), b.size(), ROOT_);
+    am::request rr=am::ireduce(comm_, &in.front(), in.size(), &reduced.front(), std::plus<double>(), ROOT_);
+    am::request ra=am::iall_reduce(comm_, &in.front(), in.size(), &all.front(), std::plus<double>());
+    EXPECT_TRUE(rb.active());
+    rb.wait();
+    EXPECT_FALSE(rb.active());
+    EXPECT_TRUE(rb.test());
+    while (!rr.test()) {}
+    ra.wait();
+
+    for (std::size_t i=0; i<N_; ++i) {
+        ASSERT_EQ(value(ROOT_,i), b[i]) << "i=" << i;
+        if (is_root_) {
+            ASSERT_EQ(sum(i), reduced[i]) << "i=" << i;
+        }
+        ASSERT_EQ(sum(i), all[i]) << "i=" << i;
+    }
+}
+
+TEST_F(MpiSegmentedTest, NonBlockingInPlace) {
+    std::vector<double> v=local_data();
+    {
+        // completed by the destructor
+        am::request r=am::iall_reduce(comm_, &v.front(), v.size(), &v.front(), std::plus<double>());
+    }
+    for (std::size_t i=0; i<N_; ++i) ASSERT_EQ(sum(i), v[i]) << "i=" << i;
+
+    am::request moved;
+    EXPECT_FALSE(moved.active());
+    moved=am::ibroadcast(comm_, &v.front(), v.size(), ROOT_);
+    moved.wait();
+    for (std::size_t i=0; i<N_; ++i) ASSERT_EQ(sum(i), v[i]) << "i=" << i;
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    alps::mpi::environment env(argc, argv); // initializes MPI environment
+    alps::gtest_par_xml_output tweak;
+    tweak(alps::mpi::communicator().rank(), argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include <complex>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <alps/utilities/mpi_pack.hpp>
+
+#include <gtest/gtest.h>
+
+#include <alps/utilities/gtest_par_xml_output.hpp>
+
+/* Test packing of objects and the packed collectives */
+
+namespace am=alps::mpi;
+
+namespace {
+    enum color { RED, GREEN, BLUE };
+
+    /// A class with pack() and unpack() members, holding a bit of everything
+    struct record {
+        int number;
+        color tint;
+        std::complex<double> value;
+        std::string name;
+        std::vector<double> data;
+        std::vector<bool> flags;
+        std::vector<std::string> words;
+        std::map<std::string, std::vector<int> > table;
+        boost::optional<std::pair<std::string,long> > extra;
+
+        record() : number(0), tint(RED), value(), name(), data(), flags(), words(), table(), extra() {}
+
+        explicit record(int seed) : number(seed), tint(BLUE), value(0.5*seed, -1.0), name("record"), extra(std::make_pair(std::string("seed"), long(seed))) {
+            for (int i=0; i<seed; ++i) {
+                data.push_back(0.25*i);
+                flags.push_back(i%3==0);
+                words.push_back(std::string(i%5, 'a'+i%26));
+                table[std::to_string(i%7)].push_back(i);
+            }
+        }
+
+        void pack(am::packer& p) const {
+            p << number << tint << value << name << data << flags << words << table << extra;
+        }
+
+        void unpack(am::unpacker& u) {
+            u >> number >> tint >> value >> name >> data >> flags >> words >> table >> extra;
+        }
+
+        bool operator==(const record& rhs) const {
+            return number==rhs.number && tint==rhs.tint && value==rhs.value && name==rhs.name &&
+                   data==rhs.data && flags==rhs.flags && words==rhs.words && table==rhs.table && extra==rhs.extra;
+        }
+    };
+}
+
+class MpiPackTest : public ::testing::Test {
+  protected:
+    static const int ROOT_=0;
+    am::communicator comm_;
+    int rank_;
+    int nproc_;
+    bool is_root_;
+
+  public:
+    MpiPackTest() : comm_(), rank_(comm_.rank()), nproc_(comm_.size()), is_root_(rank_==ROOT_) {}
+};
+
+TEST_F(MpiPackTest, RoundTrip) {
+    record r(50);
+    std::vector<char> buf=am::pack_to_buffer(r);
+    am::packer sizer;
+    sizer << r;
+    EXPECT_EQ(buf.size(), sizer.size());
+
+    record r2;
+    am::unpack_from_buffer(buf, r2);
+    EXPECT_TRUE(r==r2);
+
+    // empty optional and containers
+    record empty;
+    am::unpack_from_buffer(am::pack_to_buffer(empty), r2);
+    EXPECT_TRUE(empty==r2);
+}
+
+TEST_F(MpiPackTest, Corrupted) {
+    std::vector<char> buf=am::pack_to_buffer(record(10));
+    record r;
+    std::vector<char> truncated(buf.begin(), buf.end()-1);
+    EXPECT_THROW(am::unpack_from_buffer(truncated, r), std::runtime_error);
+    std::vector<char> longer(buf);
+    longer.push_back(0);
+    EXPECT_THROW(am::unpack_from_buffer(longer, r), std::runtime_error);
+
+    // a huge vector size must not be trusted
+    std::size_t huge=std::size_t(-1)/2;
+    std::vector<char> bad(sizeof(huge));
+    std::memcpy(bad.data(), &huge, sizeof(huge));
+    std::vector<double> v;
+    EXPECT_THROW(am::unpack_from_buffer(bad, v), std::runtime_error);
+
+    char small[4];
+    am::packer p(small, sizeof(small));
+    EXPECT_THROW(p << 1.0, std::logic_error);
+}
+
+TEST_F(MpiPackTest, Broadcast) {
+    // one message, and two messages
+    for (int seed : {3, 1000}) {
+        record r(is_root_ ? seed : 1);
+        am::broadcast_packed(comm_, r, ROOT_);
+        EXPECT_TRUE(r==record(seed)) << "seed=" << seed;
+    }
+}
+
+TEST_F(MpiPackTest, Reduction) {
+    const std::size_t n=1000;
+    std::vector<double> d(n), d_sum(n, 0.0);
+    std::vector<long> l(n);
+    for (std::size_t i=0; i<n; ++i) {
+        d[i]=0.5*i+rank_;
+        l[i]=long(i)*(rank_+1);
+    }
+    double x=rank_+1;
+    std::vector<double> d_in_place(d);
+    std::vector<long> l_sum;
+
+    am::packed_reduction reduction(comm_, ROOT_);
+    reduction.add(d.data(), d_sum.data(), n);
+    reduction.add(&x, &x, 1);
+    reduction.add(l.data(), n, [&](const long* sums) { l_sum.assign(sums, sums+n); });
+    reduction.add(d_in_place.data(), d_in_place.data(), n);
+    EXPECT_TRUE(reduction.pending());
+    reduction.commit();
+    EXPECT_FALSE(reduction.pending());
+
+    if (is_root_) {
+        ASSERT_EQ(n, l_sum.size());
+        EXPECT_EQ(0.5*nproc_*(nproc_+1), x);
+        for (std::size_t i=0; i<n; ++i) {
+            double expected=0.5*i*nproc_+0.5*nproc_*(nproc_-1);
+            ASSERT_EQ(expected, d_sum[i]) << "i=" << i;
+            ASSERT_EQ(expected, d_in_place[i]) << "i=" << i;
+            ASSERT_EQ(long(i)*nproc_*(nproc_+1)/2, l_sum[i]) << "i=" << i;
+        }
+    } else {
+        EXPECT_TRUE(l_sum.empty());
+        EXPECT_EQ(0.0, d_sum[0]);
+    }
+    // nothing to do
+    reduction.commit();
+}
+
+int main(int argc, char** argv)
+{
+    alps::mpi::environment env(argc, argv); // initializes MPI environment
+    alps::gtest_par_xml_output tweak;
+    tweak(alps::mpi::communicator().rank(), argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
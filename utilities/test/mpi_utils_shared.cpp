@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include <complex>
+#include <string>
+#include <vector>
+
+#include <alps/utilities/mpi_pack.hpp>
+#include <alps/utilities/mpi_shared.hpp>
+
+#include <gtest/gtest.h>
+
+#include <alps/utilities/gtest_par_xml_output.hpp>
+
+/* Test the node-level collectives through shared memory */
+
+namespace am=alps::mpi;
+
+class MpiSharedTest : public ::testing::Test {
+  protected:
+    am::communicator comm_;
+    int rank_;
+    int nproc_;
+
+  public:
+    MpiSharedTest() : comm_(), rank_(comm_.rank()), nproc_(comm_.size()) {}
+};
+
+TEST_F(MpiSharedTest, Topology) {
+    std::shared_ptr<const am::node_topology> topo=am::node_topology::of(comm_);
+    // cached on the communicator
+    EXPECT_EQ(topo, am::node_topology::of(comm_));
+
+    int nodes=topo->is_leader() ? 1 : 0;
+    nodes=am::all_reduce(comm_, nodes, std::plus<int>());
+    EXPECT_EQ(nodes, topo->nodes());
+    EXPECT_EQ(topo->trivial(), nodes==nproc_);
+    EXPECT_EQ(topo->is_leader(), MPI_Comm(topo->leaders())!=MPI_COMM_NULL);
+    if (topo->is_leader()) {
+        EXPECT_EQ(topo->leaders().rank(), topo->leader_of(rank_));
+    }
+}
+
+TEST_F(MpiSharedTest, SharedArray) {
+    const am::communicator& node=am::node_topology::of(comm_)->node();
+    const std::size_t n=10;
+    am::shared_array<long> shared(node, n);
+    ASSERT_EQ(n*node.size(), shared.size());
+    for (std::size_t i=0; i<n; ++i) shared[node.rank()*n+i]=node.rank();
+    shared.sync();
+    // every rank sees the segments of the others
+    for (std::size_t i=0; i<shared.size(); ++i) ASSERT_EQ(long(i/n), shared[i]) << "i=" << i;
+    shared.sync();
+}
+
+TEST_F(MpiSharedTest, Broadcast) {
+    const std::size_t n=1000;
+    for (int root=0; root<nproc_; ++root) {
+        std::vector<std::complex<double> > data;
+        if (rank_==root) {
+            for (std::size_t i=0; i<n; ++i) data.push_back(std::complex<double>(i, -root));
+        }
+        am::shared_array<std::complex<double> > shared=am::broadcast_shared(comm_, data.data(), n, root);
+        ASSERT_EQ(n, shared.size());
+        for (std::size_t i=0; i<n; ++i) ASSERT_EQ(std::complex<double>(i, -root), shared[i]) << "i=" << i;
+    }
+}
+
+TEST_F(MpiSharedTest, Reduce) {
+    for (std::size_t n : {std::size_t(1), std::size_t(2), std::size_t(1001)}) {
+        for (int root=0; root<nproc_; ++root) {
+            std::vector<double> in(n), out(n, -1.0);
+            for (std::size_t i=0; i<n; ++i) in[i]=i+rank_;
+            am::node_reduce(comm_, in.data(), out.data(), n, std::plus<double>(), root);
+            if (rank_==root) {
+                for (std::size_t i=0; i<n; ++i) {
+                    ASSERT_EQ(double(i)*nproc_+0.5*nproc_*(nproc_-1), out[i]) << "i=" << i << " n=" << n;
+                }
+            } else {
+                EXPECT_EQ(-1.0, out[0]);
+            }
+            // in place
+            am::node_reduce(comm_, in.data(), in.data(), n, std::plus<double>(), root);
+            if (rank_==root) {
+                EXPECT_EQ(0.5*nproc_*(nproc_-1), in[0]);
+            }
+        }
+    }
+    std::vector<double> empty;
+    EXPECT_THROW(am::node_reduce(comm_, empty.data(), empty.data(), 0, std::plus<double>(), 0), std::invalid_argument);
+}
+
+TEST_F(MpiSharedTest, PackedCollectives) {
+    std::size_t saved=am::node_collective_threshold();
+    am::set_node_collective_threshold(0);
+
+    std::vector<std::string> words;
+    if (rank_==0) words.assign(1000, std::string("shared"));
+    am::broadcast_packed(comm_, words, 0);
+    EXPECT_EQ(std::vector<std::string>(1000, std::string("shared")), words);
+
+    std::vector<long> values(100, rank_+1), sums(100, 0);
+    am::packed_reduction reduction(comm_, 0);
+    reduction.add(values.data(), sums.data(), values.size());
+    reduction.commit();
+    if (rank_==0) {
+        EXPECT_EQ(long(nproc_)*(nproc_+1)/2, sums[99]);
+    }
+
+    am::set_node_collective_threshold(saved);
+}
+
+TEST_F(MpiSharedTest, TopologyFreedWithCommunicator) {
+    std::size_t saved=am::node_collective_threshold();
+    am::set_node_collective_threshold(0);
+
+    std::weak_ptr<const am::node_topology> cached;
+    {
+        MPI_Comm raw;
+        MPI_Comm_split(comm_, 0, rank_, &raw);
+        am::communicator split(raw, am::take_ownership);
+        std::vector<std::string> words;
+        if (rank_==0) words.assign(1000, std::string("shared"));
+        am::broadcast_packed(split, words, 0);
+        EXPECT_EQ(std::vector<std::string>(1000, std::string("shared")), words);
+        cached=am::node_topology::of(split);
+    }
+    // freeing the communicator drops the cached topology and its subcommunicators
+    EXPECT_TRUE(cached.expired());
+
+    am::set_node_collective_threshold(saved);
+}
+
+int main(int argc, char** argv)
+{
+    alps::mpi::environment env(argc, argv); // initializes MPI environment
+    alps::gtest_par_xml_output tweak;
+    tweak(alps::mpi::communicator().rank(), argc, argv);
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "alps/numeric/tensors.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace alps::numerics;
+
+TEST(TensorParallel, RangesCoverData) {
+    alps::thread_pool pool(4);
+    parallel_policy policy(pool, 0);
+    for (size_t n : {size_t(0), size_t(1), size_t(511), size_t(512), size_t(5000), size_t(100003)}) {
+        std::vector<int> count(n, 0);
+        std::vector<std::pair<size_t, size_t> > ranges;
+        std::mutex mutex;
+        policy.for_each_range(n, sizeof(double), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) ++count[i];
+            std::lock_guard<std::mutex> lock(mutex);
+            ranges.push_back(std::make_pair(begin, end));
+        });
+        for (size_t i = 0; i < n; ++i) ASSERT_EQ(1, count[i]) << "n=" << n << " i=" << i;
+        // ranges start on page boundaries
+        for (size_t r = 0; r < ranges.size(); ++r) EXPECT_EQ(0u, ranges[r].first * sizeof(double) % 4096);
+    }
+}
+
+TEST(TensorParallel, RangesFollowDataPages) {
+    alps::thread_pool pool(4);
+    parallel_policy policy(pool, 0);
+    size_t n = 100000;
+    tensor<double, 1> X(n + 8);
+    for (size_t skew = 0; skew < 8; ++skew) {
+        const double *data = X.data() + skew;
+        std::vector<int> count(n, 0);
+        policy.for_each_range(n, sizeof(double), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) ++count[i];
+            // all ranges but the first start on a page of the data
+            if (begin > 0) {
+                EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(data + begin) % 4096);
+            }
+        }, data);
+        for (size_t i = 0; i < n; ++i) ASSERT_EQ(1, count[i]) << "skew=" << skew << " i=" << i;
+    }
+}
+
+TEST(TensorParallel, ElementwiseOperations) {
+    alps::thread_pool pool(3);
+    for (size_t n : {size_t(7), size_t(1000), size_t(20011)}) {
+        tensor<std::complex<double>, 2> X(n, 3), Y(n, 3);
+        for (size_t i = 0; i < X.size(); ++i) {
+            X.data()[i] = std::complex<double>(double(i), -0.5 * double(i));
+            Y.data()[i] = std::complex<double>(1.0, double(i % 17));
+        }
+        // reference results with the default, serial policy
+        tensor<std::complex<double>, 2> S = X;
+        S += Y;
+        S *= 2.0;
+        S -= Y;
+        S /= 3.0;
+        S = -S;
+        S *= Y;
+        S = S + Y * 2.0;
+        tensor<std::complex<double>, 2> P(n, 3);
+        {
+            scoped_parallel_policy scoped(parallel_policy(pool, 0));
+            ASSERT_EQ(&pool, parallel_policy::current().pool());
+            P = X;
+            P += Y;
+            P *= 2.0;
+            P -= Y;
+            P /= 3.0;
+            P = -P;
+            P *= Y;
+            P = P + Y * 2.0;
+            ASSERT_TRUE(P == S);
+            ASSERT_NEAR(0.0, std::abs(P.sum() - S.sum()), 1e-9 * std::abs(S.sum()));
+            ASSERT_DOUBLE_EQ(S.max_abs(), P.max_abs());
+            P.set_zero();
+            ASSERT_EQ(0.0, P.max_abs());
+        }
+        ASSERT_EQ(nullptr, parallel_policy::current().pool());
+    }
+}
+
+TEST(TensorParallel, Reductions) {
+    tensor<double, 1> X(12345);
+    for (size_t i = 0; i < X.size(); ++i) X(i) = (i % 2 ? -1.0 : 1.0) * double(i);
+    double max = 0.0, sum = 0.0;
+    for (size_t i = 0; i < X.size(); ++i) {
+        max = std::max(max, std::abs(X(i)));
+        sum += X(i);
+    }
+    alps::thread_pool pool(4);
+    scoped_parallel_policy scoped(parallel_policy(pool, 100));
+    ASSERT_EQ(max, X.max_abs());
+    ASSERT_EQ(sum, X.sum());
+    ASSERT_EQ(0.0, (tensor<double, 1>(size_t(0)).max_abs()));
+}
+
+// Results do not depend on the number of threads, with the storage initialized by the threads using it
+TEST(TensorParallel, ThreadCounts) {
+    size_t n = 100003;
+    tensor<double, 1> X(n);
+    for (size_t i = 0; i < n; ++i) X(i) = std::sin(double(i));
+    tensor<double, 1> Z = X * 3.0;
+    for (unsigned nthreads = 1; nthreads <= 8; nthreads *= 2) {
+        alps::thread_pool pool(nthreads);
+        scoped_parallel_policy scoped(parallel_policy(pool, 0));
+        tensor<double, 1> Y(n);
+        for (int r = 0; r < 3; ++r) Y += X;
+        ASSERT_TRUE(Y == Z) << nthreads << " threads";
+    }
+}
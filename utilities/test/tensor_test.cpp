@@ -6,8 +6,11 @@
 
 #include <gtest/gtest.h>
 #include <complex>
+#include <memory>
 
 #include "alps/numeric/tensors/tensor_base.hpp"
+#include "alps/numeric/tensors/einsum.hpp"
+#include "alps/numeric/tensors/static_tensor.hpp"
 
 using namespace alps::numerics::detail;
 using namespace alps::numerics;
@@ -331,6 +334,47 @@ TEST(TensorTest, BasicArithmeticsView) {
   }
 }
 
+TEST(TensorTest, LazyExpression) {
+  size_t N = 6;
+  tensor<double, 2> X({{N, N}});
+  tensor<double, 2> Z({{N, N}});
+  tensor<std::complex<double>, 2> C({{N, N}});
+  for (size_t i = 0; i < N; ++i) {
+    for (size_t j = 0; j < N; ++j) {
+      X(i, j) = i + 0.5 * j;
+      Z(i, j) = i * j;
+      C(i, j) = std::complex<double>(j, i);
+    }
+  }
+  tensor<double, 2> Y = lazy(X) + 2.0 * lazy(Z) - lazy(X) / 4;
+  tensor<std::complex<double>, 2> W({{N, N}});
+  W = -lazy(C) + lazy(X) * std::complex<double>(0.0, 1.0);
+  for (size_t i = 0; i < N; ++i) {
+    for (size_t j = 0; j < N; ++j) {
+      ASSERT_DOUBLE_EQ(X(i, j) + 2.0 * Z(i, j) - X(i, j) / 4, Y(i, j));
+      ASSERT_DOUBLE_EQ(-C(i, j).real(), W(i, j).real());
+      ASSERT_DOUBLE_EQ(X(i, j) - C(i, j).imag(), W(i, j).imag());
+    }
+  }
+  // the result may alias an operand
+  X = lazy(X) - lazy(Z);
+  Y -= lazy(Z) * 2;
+  for (size_t i = 0; i < N; ++i) {
+    for (size_t j = 0; j < N; ++j) {
+      ASSERT_DOUBLE_EQ(i + 0.5 * j - i * j, X(i, j));
+      ASSERT_DOUBLE_EQ(0.75 * (i + 0.5 * j), Y(i, j));
+    }
+  }
+  // views are written in place
+  tensor<double, 3> T({{2, N, N}});
+  tensor_view<double, 2> V = T(1);
+  V = lazy(Z) * 3;
+  ASSERT_DOUBLE_EQ(3.0 * Z(2, 3), T(1, 2, 3));
+  tensor<double, 2> S({{N, N + 1}});
+  EXPECT_THROW(lazy(X) + lazy(S), std::invalid_argument);
+  EXPECT_THROW(X += lazy(S), std::invalid_argument);
+}
+
 TEST(TensorTest, DoubleScaleByComplex) {
   size_t N = 10;
   Eigen::MatrixXd M1 = Eigen::MatrixXd::Random(N, N);
@@ -540,3 +584,242 @@ TEST(TensorTest, Negate) {
     }
   }
 }
+
+TEST(TensorTest, StridedViewPermute) {
+  size_t N0 = 3, N1 = 37, N2 = 19, N3 = 2;
+  tensor <double, 4> X(N0, N1, N2, N3);
+  for (size_t i = 0; i < X.size(); ++i) X.data()[i] = double(i);
+  // (i,j,k,l) -> (k,i,l,j): the innermost dimension has to be transposed
+  tensor <double, 4> Y = X.permute<2, 0, 3, 1>();
+  ASSERT_EQ(N2, Y.shape()[0]);
+  ASSERT_EQ(N0, Y.shape()[1]);
+  ASSERT_EQ(N3, Y.shape()[2]);
+  ASSERT_EQ(N1, Y.shape()[3]);
+  // (i,j,k,l) -> (j,i,k,l): contiguous inner blocks
+  tensor <double, 4> Z(1, 1, 1, 1);
+  Z = X.permute<1, 0, 2, 3>();
+  for (size_t i = 0; i < N0; ++i)
+    for (size_t j = 0; j < N1; ++j)
+      for (size_t k = 0; k < N2; ++k)
+        for (size_t l = 0; l < N3; ++l) {
+          ASSERT_EQ(X(i, j, k, l), Y(k, i, l, j));
+          ASSERT_EQ(X(i, j, k, l), Z(j, i, k, l));
+          ASSERT_EQ(X(i, j, k, l), (X.permute<3, 1, 0, 2>()(l, j, i, k)));
+        }
+  // the inverse permutation restores the tensor
+  tensor <double, 4> W = Y.permute<1, 3, 0, 2>();
+  ASSERT_EQ(X, W);
+  EXPECT_THROW(X.strided().permute({{0, 1, 1, 2}}), std::invalid_argument);
+}
+
+TEST(TensorTest, StridedViewTranspose) {
+  size_t N = 131, M = 70;
+  tensor <std::complex<double>, 2> X(N, M);
+  for (size_t i = 0; i < N; ++i)
+    for (size_t j = 0; j < M; ++j)
+      X(i, j) = std::complex<double>(i, j);
+  tensor <std::complex<double>, 2> T = X.permute<1, 0>();
+  ASSERT_TRUE(T.matrix() == X.matrix().transpose());
+  // in-place transpose of a square tensor
+  tensor <double, 2> S(N, N);
+  for (size_t i = 0; i < S.size(); ++i) S.data()[i] = double(i);
+  tensor <double, 2> S0 = S;
+  S = S.permute<1, 0>();
+  ASSERT_TRUE(S.matrix() == S0.matrix().transpose());
+}
+
+TEST(TensorTest, StridedViewSlice) {
+  size_t N = 4;
+  tensor <double, 3> X(N, N + 1, N + 2);
+  for (size_t i = 0; i < X.size(); ++i) X.data()[i] = double(i);
+  // fix the last index
+  strided_view<double, 2> v = X.strided().slice<2>(3);
+  EXPECT_FALSE(v.is_contiguous());
+  tensor <double, 2> Y = v;
+  for (size_t i = 0; i < N; ++i)
+    for (size_t j = 0; j < N + 1; ++j)
+      ASSERT_EQ(X(i, j, 3), Y(i, j));
+  // write through the view
+  Y *= 2.0;
+  v.copy_from(Y.data());
+  for (size_t i = 0; i < N; ++i)
+    for (size_t j = 0; j < N + 1; ++j)
+      ASSERT_EQ(2.0 * double(X.index(i, j, 3)), X(i, j, 3));
+  const tensor <double, 3> &C = X;
+  strided_view<const double, 1> c = C.strided().slice<0>(1).slice<0>(2);
+  EXPECT_TRUE(c.is_contiguous());
+  ASSERT_EQ(C(1, 2, 5), c(5));
+}
+
+TEST(TensorTest, EinsumMatrixProduct) {
+  size_t N = 3, M = 4, K = 5;
+  tensor <double, 2> A(N, K), B(K, M);
+  for (size_t i = 0; i < A.size(); ++i) A.data()[i] = std::sin(double(i));
+  for (size_t i = 0; i < B.size(); ++i) B.data()[i] = std::cos(double(i));
+  tensor <double, 2> C = einsum<2>("ik,kj->ij", A, B);
+  ASSERT_EQ(N, C.shape()[0]);
+  ASSERT_EQ(M, C.shape()[1]);
+  ASSERT_TRUE(C.matrix().isApprox(A.matrix() * B.matrix()));
+  // transposed result
+  tensor <double, 2> Ct = einsum<2>("ik, kj -> ji", A, B);
+  ASSERT_TRUE(Ct.matrix().isApprox((A.matrix() * B.matrix()).transpose()));
+  // diagonal of the product
+  tensor <double, 1> d(N);
+  tensor <double, 2> Bn(K, N);
+  for (size_t i = 0; i < Bn.size(); ++i) Bn.data()[i] = double(i);
+  einsum("ik,ki->i", d, A, Bn);
+  for (size_t i = 0; i < N; ++i) ASSERT_NEAR((A.matrix() * Bn.matrix())(i, i), d(i), 1e-12);
+}
+
+TEST(TensorTest, EinsumBatched) {
+  size_t W = 4, N = 3;
+  tensor <std::complex<double>, 3> G(W, N, N), S;
+  tensor <double, 2> V(N, N);
+  for (size_t i = 0; i < G.size(); ++i) G.data()[i] = std::complex<double>(std::sin(double(i)), std::cos(double(3 * i)));
+  for (size_t i = 0; i < V.size(); ++i) V.data()[i] = double(i) - 2.0;
+  // S(w,a,b) = \sum_{cd} G(w,a,c) V(c,d) G(w,d,b)
+  einsum("wac,cd,wdb->wab", S, G, V, G);
+  ASSERT_EQ(W, S.shape()[0]);
+  for (size_t w = 0; w < W; ++w) {
+    for (size_t a = 0; a < N; ++a) {
+      for (size_t b = 0; b < N; ++b) {
+        std::complex<double> s = 0.0;
+        for (size_t c = 0; c < N; ++c)
+          for (size_t d = 0; d < N; ++d) s += G(w, a, c) * V(c, d) * G(w, d, b);
+        ASSERT_NEAR(0.0, std::abs(s - S(w, a, b)), 1e-12);
+      }
+    }
+  }
+  // labels of a single tensor missing from the result are summed over
+  tensor <std::complex<double>, 1> n(W);
+  einsum("wab->w", n, G);
+  for (size_t w = 0; w < W; ++w) {
+    std::complex<double> s = 0.0;
+    for (size_t a = 0; a < N; ++a)
+      for (size_t b = 0; b < N; ++b) s += G(w, a, b);
+    ASSERT_NEAR(0.0, std::abs(s - n(w)), 1e-12);
+  }
+  // errors
+  EXPECT_THROW(einsum("wac,cd->wad", S, G, V, G), std::invalid_argument);
+  EXPECT_THROW(einsum("wac,cd,wdb", S, G, V, G), std::invalid_argument);
+  EXPECT_THROW(einsum("waa,ad,wdb->wab", S, G, V, G), std::invalid_argument);
+  EXPECT_THROW(einsum("wac,cd,wdb->wax", S, G, V, G), std::invalid_argument);
+  tensor <double, 2> V2(N + 1, N);
+  EXPECT_THROW(einsum("wac,cd,wdb->wab", S, G, V2, G), std::invalid_argument);
+}
+
+TEST(TensorTest, EinsumPlanCacheIsBounded) {
+  alps::numerics::detail::einsum_plan_cache cache(4);
+  alps::numerics::detail::einsum_spec spec = alps::numerics::detail::parse_einsum("ik,kj,jl->il");
+  std::vector<std::vector<size_t> > shapes(3, std::vector<size_t>(2, 2));
+  for (size_t n = 1; n < 10; ++n) {
+    shapes[1][1] = shapes[2][0] = n;
+    alps::numerics::detail::einsum_plan plan = cache.get(spec, shapes);
+    ASSERT_EQ(2u, plan.size());
+    ASSERT_EQ(plan, cache.get(spec, shapes));
+  }
+  EXPECT_EQ(4u, cache.size());
+}
+
+TEST(TensorTest, AlignedStorage) {
+  for (size_t n = 1; n < 100; n += 7) {
+    tensor <std::complex<double>, 2> X(n, n + 1);
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(X.data()) % 64);
+  }
+  // large blocks backed by huge pages
+  size_t threshold = huge_page_threshold();
+  set_huge_page_threshold(1 << 16);
+  {
+    tensor <double, 2> X(300, 300), Y(300, 300);
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(X.data()) % 64);
+    for (size_t i = 0; i < X.size(); ++i) X.data()[i] = double(i);
+    Y = X;
+    Y *= 2.0;
+    ASSERT_EQ(2.0 * (X.size() - 1), Y.data()[X.size() - 1]);
+  }
+  set_huge_page_threshold(threshold);
+  // plain aligned vectors are zero-initialized, also in recycled blocks
+  memory_arena arena;
+  {
+    aligned_vector<double> dirty(64, 1.0);
+  }
+  aligned_vector<double> v(64);
+  aligned_vector<std::complex<double> > c(32);
+  for (size_t i = 0; i < v.size(); ++i) ASSERT_EQ(0.0, v[i]);
+  for (size_t i = 0; i < c.size(); ++i) ASSERT_EQ(0.0, std::abs(c[i]));
+}
+
+TEST(TensorTest, MemoryArena) {
+  size_t N = 20;
+  tensor <double, 2> A(N, N);
+  for (size_t i = 0; i < A.size(); ++i) A.data()[i] = double(i);
+  std::unique_ptr<tensor <double, 2> > survivor;
+  {
+    memory_arena arena;
+    size_t cached = 0;
+    for (int iteration = 0; iteration < 3; ++iteration) {
+      tensor <double, 2> T = A * 2.0;
+      T += A;
+      ASSERT_EQ(3.0 * (A.size() - 1), T.data()[A.size() - 1]);
+      // temporaries of the later iterations reuse the blocks of the first one
+      if (iteration > 0) ASSERT_EQ(cached, arena.cached_bytes());
+      else cached = arena.cached_bytes();
+    }
+    ASSERT_EQ(cached + N * N * sizeof(double), arena.cached_bytes());
+    survivor.reset(new tensor <double, 2>(A));
+    {
+      memory_arena inner;
+      ASSERT_EQ(&inner, memory_arena::current());
+    }
+    ASSERT_EQ(&arena, memory_arena::current());
+  }
+  ASSERT_EQ(nullptr, memory_arena::current());
+  // blocks outliving the arena stay valid
+  ASSERT_TRUE(*survivor == A);
+}
+
+TEST(TensorTest, StaticTensor) {
+  static_tensor <double, 2, 3, 4> X;
+  static_assert(sizeof(X) == 24 * sizeof(double), "static tensor should store the elements inline");
+  ASSERT_EQ(24u, X.size());
+  for (size_t i = 0; i < X.size(); ++i) X.data()[i] = double(i);
+  // same layout as tensor
+  tensor <double, 3> Y(2, 3, 4);
+  for (size_t i = 0; i < Y.size(); ++i) Y.data()[i] = double(i);
+  for (size_t i = 0; i < 2; ++i)
+    for (size_t j = 0; j < 3; ++j)
+      for (size_t k = 0; k < 4; ++k)
+        ASSERT_EQ(Y(i, j, k), X(i, j, k));
+  ASSERT_TRUE(X.view() == Y);
+  ASSERT_TRUE((static_tensor <double, 2, 3, 4>(Y) == X));
+  ASSERT_THROW((static_tensor <double, 2, 4, 3>(Y)), std::invalid_argument);
+  // arithmetic
+  static_tensor <double, 2, 3, 4> Z = X * 3.0 - X / 2.0 + (-X);
+  for (size_t i = 0; i < Z.size(); ++i) ASSERT_DOUBLE_EQ(1.5 * X.data()[i], Z.data()[i]);
+  Z -= X;
+  Z += X;
+  Z *= 2.0;
+  Z /= 3.0;
+  ASSERT_DOUBLE_EQ(X.data()[5], Z.data()[5]);
+  Z.set_zero();
+  ASSERT_TRUE((Z == static_tensor <double, 2, 3, 4>()));
+}
+
+TEST(TensorTest, StaticTensorMatrix) {
+  static_tensor <std::complex<double>, 4, 4> A;
+  static_tensor <std::complex<double>, 4, 2> B;
+  for (size_t i = 0; i < 4; ++i) {
+    for (size_t j = 0; j < 4; ++j) A(i, j) = std::complex<double>(i == j ? 4.0 : 0.0, 1.0 / (1.0 + i + 2 * j));
+    for (size_t j = 0; j < 2; ++j) B(i, j) = std::complex<double>(i + j, i - j);
+  }
+  static_tensor <std::complex<double>, 4, 2> C = A.dot(B);
+  ASSERT_TRUE(C.matrix().isApprox(A.matrix() * B.matrix()));
+  tensor <std::complex<double>, 2> At(4, 4);
+  std::copy(A.data(), A.data() + A.size(), At.data());
+  ASSERT_TRUE(A.inverse().matrix().isApprox(At.inverse().matrix()));
+  ASSERT_TRUE((A.dot(A.inverse()).matrix().isApprox(Eigen::Matrix<std::complex<double>, 4, 4>::Identity())));
+  // column vector
+  static_tensor <double, 3, 1> v;
+  v(1, 0) = 2.0;
+  ASSERT_EQ(2.0, v.matrix()(1, 0));
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 1998-2018 ALPS Collaboration. See COPYRIGHT.TXT
+ * All rights reserved. Use is subject to license terms. See LICENSE.TXT
+ * For use in publications, see ACKNOWLEDGE.TXT
+ */
+
+#include <stdexcept>
+#include <vector>
+
+#include "alps/utilities/thread_pool.hpp"
+
+#include "gtest/gtest.h"
+
+TEST(ThreadPool, CoversRange) {
+    alps::thread_pool pool(4);
+    for (size_t n = 0; n < 20; ++n) {
+        std::vector<int> count(n, 0);
+        pool.parallel_for(n, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) ++count[i];
+        });
+        for (size_t i = 0; i < n; ++i) EXPECT_EQ(1, count[i]) << "n=" << n << " i=" << i;
+    }
+}
+
+TEST(ThreadPool, Nested) {
+    alps::thread_pool pool(3);
+    std::vector<int> count(12, 0);
+    pool.parallel_for(3, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            pool.parallel_for(4, [&](size_t b, size_t e) {
+                for (size_t j = b; j < e; ++j) ++count[4*i + j];
+            });
+        }
+    });
+    for (size_t i = 0; i < count.size(); ++i) EXPECT_EQ(1, count[i]);
+}
+
+TEST(ThreadPool, RethrowsException) {
+    alps::thread_pool pool(2);
+    EXPECT_THROW(pool.parallel_for(10, [](size_t /*begin*/, size_t end) {
+        if (end == 10) throw std::runtime_error("last range");
+    }), std::runtime_error);
+    // the pool is still usable
+    int sum = 0;
+    pool.parallel_for(1, [&](size_t begin, size_t end) { sum += int(end - begin); });
+    EXPECT_EQ(1, sum);
+}